@@ -0,0 +1,258 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * Benchmark of the formatters and parsers of the protocols.
+ *
+ * Every pair of formatter and parser (see epcases.h) runs across sizes found in
+ * real deployments, and is reported as a tab-separated line on the standard
+ * output:
+ *
+ *   case  param  n  op  bytes  iters  ns_msg  bytes_s  instr_msg  cycles_msg
+ *
+ * where 'op' is 'fmt' or 'prs', and 'bytes' the size of the message. The
+ * instructions and cycles per message are counted in user space through
+ * perf_event_open, and are 'nan' where the counters are not available.
+ */
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "epcases.h"
+
+/* Default time spent on each measure, in ms */
+#define EPB_TIME_DEFAULT	100
+
+static const char * usage =
+	"Usage: epbench [options]\n"
+	"\n"
+	"Options:\n"
+	"    -t <ms>      Time spent on each measure (%d)\n"
+	"    -c <name>    Run only the cases whose name contains this string\n"
+	"    -l           List the cases and exit\n";
+
+/******************************************************************************
+ * Measures                                                                   *
+ ******************************************************************************/
+
+/* Keeps the compiler from dropping the work */
+static volatile uint64_t epb_sink;
+
+/* Group of hardware counters; -1 if not available */
+static int epb_perf = -1;
+
+static int epb_perf_open(uint64_t config, int group)
+{
+	struct perf_event_attr a;
+
+	memset(&a, 0, sizeof(a));
+
+	a.size           = sizeof(a);
+	a.type           = PERF_TYPE_HARDWARE;
+	a.config         = config;
+	a.disabled       = group < 0;
+	a.exclude_kernel = 1;
+	a.exclude_hv     = 1;
+	a.read_format    = PERF_FORMAT_GROUP;
+
+	return syscall(__NR_perf_event_open, &a, 0, -1, group, 0);
+}
+
+static void epb_perf_init(void)
+{
+	epb_perf = epb_perf_open(PERF_COUNT_HW_INSTRUCTIONS, -1);
+
+	if(epb_perf < 0) {
+		return;
+	}
+
+	if(epb_perf_open(PERF_COUNT_HW_CPU_CYCLES, epb_perf) < 0) {
+		close(epb_perf);
+		epb_perf = -1;
+	}
+}
+
+static double epb_ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+
+	return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/* Run an operation 'iters' times on the message in 'buf'.
+ * Returns the time taken, in ns.
+ */
+static double epb_loop(
+	epb_op       op,
+	char *       buf,
+	unsigned int size,
+	uint32_t     n,
+	uint64_t     iters)
+{
+	double   t = epb_ns();
+	uint64_t i;
+	uint64_t s = 0;
+
+	for(i = 0; i < iters; i++) {
+		s += op(buf, size, n);
+	}
+
+	epb_sink += s;
+
+	return epb_ns() - t;
+}
+
+/* Measure an operation on the message in 'buf', and report it */
+static int epb_measure(
+	epb_case *   c,
+	const char * what,
+	epb_op       op,
+	char *       buf,
+	unsigned int size,
+	unsigned int len,
+	uint32_t     n,
+	double       ms)
+{
+	struct {
+		uint64_t nr;
+		uint64_t val[2];
+	} cnt;
+
+	uint64_t iters = 1;
+	double   t;
+	double   ins = NAN;
+	double   cyc = NAN;
+
+	/* Grow the iterations until they take a tenth of the time */
+	while((t = epb_loop(op, buf, size, n, iters)) < ms * 1e5) {
+		iters *= 2;
+	}
+
+	iters = (uint64_t)(iters * ms * 1e6 / t) + 1;
+
+	if(epb_perf >= 0) {
+		ioctl(epb_perf, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(epb_perf, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	t = epb_loop(op, buf, size, n, iters);
+
+	if(epb_perf >= 0) {
+		ioctl(epb_perf, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+		if(read(epb_perf, &cnt, sizeof(cnt)) == sizeof(cnt)) {
+			ins = (double)cnt.val[0] / iters;
+			cyc = (double)cnt.val[1] / iters;
+		}
+	}
+
+	printf("%s\t%s\t%u\t%s\t%u\t%llu\t%.1f\t%.0f\t%.1f\t%.1f\n",
+		c->name, c->param, n, what, len, (unsigned long long)iters,
+		t / iters, len * iters * 1e9 / t, ins, cyc);
+
+	return 0;
+}
+
+static int epb_run(epb_case * c, double ms)
+{
+	static char msg[EPB_BUF_SIZE];
+
+	uint32_t i;
+	int      len;
+
+	for(i = 0; i < c->nof; i++) {
+		/* Message the parser works on */
+		len = c->fmt(msg, sizeof(msg), c->n[i]);
+
+		if(len < 0 || c->prs(msg, len, c->n[i]) < 0) {
+			fprintf(stderr, "Case %s with %u %s failed!\n",
+				c->name, c->n[i], c->param);
+			return -1;
+		}
+
+		epb_measure(
+			c, "fmt", c->fmt, epb_buf, sizeof(epb_buf), len, c->n[i], ms);
+		epb_measure(c, "prs", c->prs, msg, len, len, c->n[i], ms);
+
+		fflush(stdout);
+	}
+
+	return 0;
+}
+
+int main(int argc, char ** argv)
+{
+	const char * only = 0;
+	double       ms   = EPB_TIME_DEFAULT;
+	uint32_t     i;
+	int          o;
+	int          ret  = 0;
+
+	while((o = getopt(argc, argv, "t:c:l")) != -1) {
+		switch(o) {
+		case 't':
+			ms = atof(optarg);
+			break;
+		case 'c':
+			only = optarg;
+			break;
+		case 'l':
+			for(i = 0; i < epb_nof_cases; i++) {
+				printf("%s\n", epb_cases[i].name);
+			}
+			return 0;
+		default:
+			fprintf(stderr, usage, EPB_TIME_DEFAULT);
+			return 1;
+		}
+	}
+
+	if(ms <= 0) {
+		fprintf(stderr, usage, EPB_TIME_DEFAULT);
+		return 1;
+	}
+
+	epb_setup();
+	epb_perf_init();
+
+	if(epb_perf < 0) {
+		fprintf(stderr, "Hardware counters not available\n");
+	}
+
+	printf("case\tparam\tn\top\tbytes\titers\tns_msg\tbytes_s\t"
+		"instr_msg\tcycles_msg\n");
+
+	for(i = 0; i < epb_nof_cases; i++) {
+		if(only && !strstr(epb_cases[i].name, only)) {
+			continue;
+		}
+
+		if(epb_run(epb_cases + i, ms)) {
+			ret = 1;
+		}
+	}
+
+	return ret;
+}
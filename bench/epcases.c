@@ -0,0 +1,806 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Formatters and parsers of the protocols, each with the sizes of the
+ * messages to run it with; see epcases.h.
+ */
+
+#include <string.h>
+
+#include "epcases.h"
+
+/* Largest number of UEs, measurements or handovers in a message */
+#define EPB_UES_MAX		3000
+
+/* Slices in a bulk request */
+#define EPB_SLICES		8
+
+#define EPB_ENB			0x0123456789ULL
+#define EPB_CELL		1
+#define EPB_MOD			0x55
+
+/******************************************************************************
+ * Data of the messages                                                       *
+ ******************************************************************************/
+
+static ep_ue_details     epb_ues[EPB_UES_MAX];
+static ep_ue_measure     epb_meas[EPB_UES_MAX];
+static ep_ho_det         epb_hos[EPB_UES_MAX];
+static ep_ho_out         epb_outs[EPB_UES_MAX];
+static ep_cell_det       epb_cells[EP_ECAP_CELL_MAX];
+static rnti_id_t         epb_users[EP_RAN_USERS_MAX];
+static ep_ran_sblk_det   epb_ops[EPB_SLICES];
+static ep_ran_sblk_out   epb_souts[EPB_SLICES];
+static ep_macrep_det     epb_mac;
+static ep_ran_det        epb_ran;
+
+/* Where parsers store what they find */
+static ep_ue_details     epb_pues[EPB_UES_MAX];
+static ep_ue_measure     epb_pmeas[EPB_UES_MAX];
+static ep_ho_det         epb_phos[EPB_UES_MAX];
+static ep_ho_out         epb_pouts[EPB_UES_MAX];
+static ep_ran_sblk_view  epb_pops[EPB_SLICES];
+static ep_ran_sblk_out   epb_psouts[EPB_SLICES];
+
+static ep_arena          epb_arena;
+static ep_macrep_sup     epb_sup;
+
+char                     epb_buf[EPB_BUF_SIZE];
+
+void epb_setup(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < EPB_UES_MAX; i++) {
+		epb_ues[i].pci  = i % 504;
+		epb_ues[i].plmn = 0x222f93;
+		epb_ues[i].rnti = 0x3d + i;
+		epb_ues[i].imsi = 222930000000001ULL + i;
+
+		epb_meas[i].meas_id = i % 32;
+		epb_meas[i].pci     = i % 504;
+		epb_meas[i].rsrp    = (uint16_t)(-80 - (int)(i % 40));
+		epb_meas[i].rsrq    = (uint16_t)(-10 - (int)(i % 10));
+
+		epb_hos[i].rnti       = 0x3d + i;
+		epb_hos[i].target_eNB = EPB_ENB + 1 + i % 16;
+		epb_hos[i].target_pci = i % 504;
+		epb_hos[i].cause      = 1;
+
+		epb_outs[i].rnti        = 0x3d + i;
+		epb_outs[i].target_rnti = 0x1000 + i;
+		epb_outs[i].result      = EP_OPERATION_SUCCESS;
+	}
+
+	for(i = 0; i < EP_ECAP_CELL_MAX; i++) {
+		epb_cells[i].pci       = i;
+		epb_cells[i].cap       = 0x1;
+		epb_cells[i].DL_earfcn = 3400 + i;
+		epb_cells[i].UL_earfcn = 21400 + i;
+		epb_cells[i].DL_prbs   = 100;
+		epb_cells[i].UL_prbs   = 100;
+	}
+
+	for(i = 0; i < EP_RAN_USERS_MAX; i++) {
+		epb_users[i] = 0x3d + i;
+	}
+
+	for(i = 0; i < EPB_SLICES; i++) {
+		epb_ops[i].id              = 0x0100000000000000ULL + i;
+		epb_ops[i].op              = EP_OPERATION_ADD;
+		epb_ops[i].det.users       = epb_users;
+		epb_ops[i].det.l2.usched   = 1;
+		epb_ops[i].det.l2.rbgs     = 2;
+
+		epb_souts[i].id     = epb_ops[i].id;
+		epb_souts[i].result = EP_OPERATION_SUCCESS;
+	}
+
+	epb_mac.DL_prbs_total = 100;
+	epb_mac.DL_prbs_used  = 4200;
+	epb_mac.UL_prbs_total = 100;
+	epb_mac.UL_prbs_used  = 1300;
+
+	epb_ran.l1_mask = 0;
+	epb_ran.l2_mask = 1;
+	epb_ran.l3_mask = 0;
+	epb_ran.l2.mac.slice_sched = 0x80000001;
+
+	ep_arena_init(&epb_arena, 0, 64 * 1024);
+	ep_macrep_sup_init(&epb_sup, EP_MACREP_SUP_MARKER, 0);
+
+	/* The first report is sent in full; all the next ones are unchanged */
+	epf_trigger_macrep_rep_sup(
+		epb_buf, sizeof(epb_buf), EPB_ENB, EPB_CELL, EPB_MOD, 1,
+		&epb_sup, &epb_mac);
+}
+
+/******************************************************************************
+ * Cases                                                                      *
+ ******************************************************************************/
+
+/* Hello */
+
+static int epb_f_hello_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_hello_req(buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 7);
+}
+
+static int epb_p_hello_req(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t id;
+
+	return epp_single_hello_req(buf, size, &id);
+}
+
+static int epb_f_hello_rep(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_hello_rep(buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 7);
+}
+
+static int epb_p_hello_rep(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t id;
+
+	return epp_single_hello_rep(buf, size, &id);
+}
+
+static int epb_f_hello_req_fp(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_hello_req_fp(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 7, 0xfeedULL);
+}
+
+static int epb_p_hello_req_fp(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t id;
+	uint64_t hash;
+
+	return epp_single_hello_req_fp(buf, size, &id, &hash);
+}
+
+static int epb_f_shello_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_sched_hello_req(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1000, 7);
+}
+
+static int epb_p_shello_req(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t id;
+
+	return epp_sched_hello_req(buf, size, &id);
+}
+
+static int epb_f_shello_rep(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_sched_hello_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1000, 7);
+}
+
+static int epb_p_shello_rep(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t id;
+
+	return epp_sched_hello_rep(buf, size, &id);
+}
+
+static int epb_f_shello_req_fp(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_sched_hello_req_fp(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1000, 7, 0xfeedULL);
+}
+
+static int epb_p_shello_req_fp(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t id;
+	uint64_t hash;
+
+	return epp_sched_hello_req_fp(buf, size, &id, &hash);
+}
+
+/* Capabilities */
+
+static int epb_f_ecap_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ecap_req(buf, size, EPB_ENB, EPB_CELL, EPB_MOD);
+}
+
+static int epb_p_ecap_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epp_single_ecap_req(buf, size);
+}
+
+static int epb_f_ecap_rep(char * buf, unsigned int size, uint32_t n)
+{
+	ep_enb_det det;
+
+	det.capmask   = EP_ECAP_UE_REPORT | EP_ECAP_UE_MEASURE;
+	det.nof_cells = n;
+	memcpy(det.cells, epb_cells, sizeof(ep_cell_det) * n);
+
+	return epf_single_ecap_rep(buf, size, EPB_ENB, EPB_CELL, EPB_MOD, &det);
+}
+
+static int epb_p_ecap_rep(char * buf, unsigned int size, uint32_t n)
+{
+	ep_enb_det det;
+
+	return epp_single_ecap_rep(buf, size, &det);
+}
+
+static int epb_f_ecap_rep_l(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ecap_rep_l(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD,
+		EP_ECAP_UE_REPORT | EP_ECAP_UE_MEASURE, n, epb_cells);
+}
+
+static int epb_p_ecap_rep_a(char * buf, unsigned int size, uint32_t n)
+{
+	ep_enb_ldet det;
+
+	ep_arena_reset(&epb_arena);
+
+	return epp_single_ecap_rep_a(buf, size, &epb_arena, &det);
+}
+
+static int epb_f_ccap_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ccap_req(buf, size, EPB_ENB, EPB_CELL, EPB_MOD);
+}
+
+static int epb_p_ccap_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epp_single_ccap_req(buf, size);
+}
+
+static int epb_f_ccap_rep(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ccap_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, epb_cells);
+}
+
+static int epb_p_ccap_rep(char * buf, unsigned int size, uint32_t n)
+{
+	ep_cell_det cell;
+
+	return epp_single_ccap_rep(buf, size, &cell);
+}
+
+/* Handover */
+
+static int epb_f_ho_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ho_req(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 0x3d, EPB_ENB + 1, 2, 1);
+}
+
+static int epb_p_ho_req(char * buf, unsigned int size, uint32_t n)
+{
+	uint16_t rnti;
+	enb_id_t enb;
+	uint16_t pci;
+	uint8_t  cause;
+
+	return epp_single_ho_req(buf, size, &rnti, &enb, &pci, &cause);
+}
+
+static int epb_f_ho_rep(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ho_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, EPB_ENB + 1, 2, 0x3d, 0x4d);
+}
+
+static int epb_p_ho_rep(char * buf, unsigned int size, uint32_t n)
+{
+	enb_id_t enb;
+	uint16_t pci;
+	uint16_t rnti;
+	uint16_t trnti;
+
+	return epp_single_ho_rep(buf, size, &enb, &pci, &rnti, &trnti);
+}
+
+static int epb_f_hob_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ho_batch_req(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, n, epb_hos);
+}
+
+static int epb_p_hob_req(char * buf, unsigned int size, uint32_t n)
+{
+	uint16_t nof;
+
+	return epp_single_ho_batch_req(
+		buf, size, &nof, EPB_UES_MAX, epb_phos);
+}
+
+static int epb_f_hob_rep(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ho_batch_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, EPB_ENB + 1, 2, n,
+		epb_outs);
+}
+
+static int epb_p_hob_rep(char * buf, unsigned int size, uint32_t n)
+{
+	enb_id_t enb;
+	uint16_t pci;
+	uint16_t nof;
+
+	return epp_single_ho_batch_rep(
+		buf, size, &enb, &pci, &nof, EPB_UES_MAX, epb_pouts);
+}
+
+/* MAC report */
+
+static int epb_f_macrep_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_trigger_macrep_req(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1000);
+}
+
+static int epb_p_macrep_req(char * buf, unsigned int size, uint32_t n)
+{
+	uint16_t interval;
+
+	return epp_trigger_macrep_req(buf, size, &interval);
+}
+
+static int epb_f_macrep_rep(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_trigger_macrep_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, &epb_mac);
+}
+
+static int epb_p_macrep_rep(char * buf, unsigned int size, uint32_t n)
+{
+	ep_macrep_det det;
+
+	return epp_trigger_macrep_rep(buf, size, &det);
+}
+
+/* Same report every time, so only 'unchanged' markers are sent */
+static int epb_f_macrep_unch(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_trigger_macrep_rep_sup(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1, &epb_sup, &epb_mac);
+}
+
+static int epb_p_macrep_unch(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t seq;
+
+	return epp_trigger_macrep_unch(buf, size, &seq);
+}
+
+/* UE report and measurements */
+
+static int epb_f_uerep_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_trigger_uerep_req(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, EP_OPERATION_ADD);
+}
+
+static int epb_p_uerep_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epp_trigger_uerep_req(buf, size);
+}
+
+static int epb_f_uerep_rep(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_trigger_uerep_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, n, n, epb_ues);
+}
+
+static int epb_p_uerep_rep(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t nof;
+
+	return epp_trigger_uerep_rep(buf, size, &nof, EPB_UES_MAX, epb_pues);
+}
+
+/* More UEs than the sender can list; only the listed ones must come back */
+static int epb_f_uerep_rep_max(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_trigger_uerep_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, n * 2 + 1, n, epb_ues);
+}
+
+static int epb_p_uerep_rep_max(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t nof;
+
+	if(epp_trigger_uerep_rep(buf, size, &nof, EPB_UES_MAX, epb_pues)) {
+		return EP_ERROR;
+	}
+
+	return nof == n ? EP_SUCCESS : EP_ERROR;
+}
+
+static int epb_p_uerep_rep_a(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ue_details * ues;
+	uint32_t        nof;
+
+	ep_arena_reset(&epb_arena);
+
+	return epp_trigger_uerep_rep_a(buf, size, &epb_arena, &nof, &ues);
+}
+
+/* Validation and lazy access to all the UEs, see epview.h */
+static int epb_p_uerep_view(char * buf, unsigned int size, uint32_t n)
+{
+	ep_msg_view v;
+	uint32_t    i;
+	uint32_t    s = 0;
+
+	if(ep_msg_validate(buf, size, &v)) {
+		return EP_ERROR;
+	}
+
+	for(i = 0; i < ep_uerep_view_nof(&v); i++) {
+		s += ep_uerep_det_rnti(ep_uerep_view_at(&v, i));
+	}
+
+	return s;
+}
+
+static int epb_f_uemeas_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_trigger_uemeas_req(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, EP_OPERATION_ADD,
+		1, 0x3d, 3400, 1000, -1, -1);
+}
+
+static int epb_p_uemeas_req(char * buf, unsigned int size, uint32_t n)
+{
+	uint8_t  id;
+	uint16_t rnti;
+	uint16_t earfcn;
+	uint16_t interval;
+	int16_t  cells;
+	int16_t  meas;
+
+	return epp_trigger_uemeas_req(
+		buf, size, &id, &rnti, &earfcn, &interval, &cells, &meas);
+}
+
+static int epb_f_uemeas_rep(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_trigger_uemeas_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, n, n, epb_meas);
+}
+
+static int epb_p_uemeas_rep(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t nof;
+
+	return epp_trigger_uemeas_rep(
+		buf, size, &nof, EPB_UES_MAX, epb_pmeas);
+}
+
+/* More measurements than the sender can list */
+static int epb_f_uemeas_rep_max(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_trigger_uemeas_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, n * 2 + 1, n, epb_meas);
+}
+
+static int epb_p_uemeas_rep_max(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t nof;
+
+	if(epp_trigger_uemeas_rep(buf, size, &nof, EPB_UES_MAX, epb_pmeas)) {
+		return EP_ERROR;
+	}
+
+	return nof == n ? EP_SUCCESS : EP_ERROR;
+}
+
+/* RAN */
+
+static int epb_f_ran_setup_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ran_setup_req(buf, size, EPB_ENB, EPB_CELL, EPB_MOD);
+}
+
+static int epb_p_ran_setup_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epp_single_ran_setup_req(buf, size);
+}
+
+static int epb_f_ran_setup_rep(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ran_setup_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, &epb_ran);
+}
+
+static int epb_p_ran_setup_rep(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_det ran;
+
+	return epp_single_ran_setup_rep(buf, size, &ran);
+}
+
+static int epb_f_slice_req(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ran_slice_req(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 0x0100000000000000ULL);
+}
+
+static int epb_p_slice_req(char * buf, unsigned int size, uint32_t n)
+{
+	slice_id_t id;
+
+	return epp_single_ran_slice_req(buf, size, &id);
+}
+
+static int epb_f_slice_rem(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ran_slice_rem(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 0x0100000000000000ULL);
+}
+
+static int epb_p_slice_rem(char * buf, unsigned int size, uint32_t n)
+{
+	slice_id_t id;
+
+	return epp_single_ran_slice_rem(buf, size, &id);
+}
+
+/* Details of a slice with 'n' users, in both the forms */
+static void epb_slice_det(ep_ran_slice_det * det, uint32_t n)
+{
+	det->nof_users = n;
+	memcpy(det->users, epb_users, sizeof(rnti_id_t) * n);
+	det->l2.usched = 1;
+	det->l2.rbgs   = 2;
+}
+
+static void epb_slice_ldet(ep_ran_slice_ldet * det, uint32_t n)
+{
+	det->nof_users = n;
+	det->users     = epb_users;
+	det->l2.usched = 1;
+	det->l2.rbgs   = 2;
+}
+
+static int epb_f_slice_rep(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_det det;
+
+	epb_slice_det(&det, n);
+
+	return epf_single_ran_slice_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1, &det);
+}
+
+static int epb_p_slice_rep(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_det det;
+	slice_id_t       id;
+
+	return epp_single_ran_slice_rep(buf, size, &id, &det);
+}
+
+static int epb_f_slice_add(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_det det;
+
+	epb_slice_det(&det, n);
+
+	return epf_single_ran_slice_add(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1, &det);
+}
+
+static int epb_p_slice_add(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_det det;
+	slice_id_t       id;
+
+	return epp_single_ran_slice_add(buf, size, &id, &det);
+}
+
+static int epb_f_slice_set(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_det det;
+
+	epb_slice_det(&det, n);
+
+	return epf_single_ran_slice_set(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1, &det);
+}
+
+static int epb_p_slice_set(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_det det;
+	slice_id_t       id;
+
+	return epp_single_ran_slice_set(buf, size, &id, &det);
+}
+
+static int epb_f_slice_rep_l(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_ldet det;
+
+	epb_slice_ldet(&det, n);
+
+	return epf_single_ran_slice_rep_l(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1, &det);
+}
+
+static int epb_p_slice_rep_view(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_view view;
+	slice_id_t        id;
+
+	return epp_single_ran_slice_rep_view(buf, size, &id, &view);
+}
+
+static int epb_p_slice_rep_a(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_ldet det;
+	slice_id_t        id;
+
+	ep_arena_reset(&epb_arena);
+
+	return epp_single_ran_slice_rep_a(buf, size, &epb_arena, &id, &det);
+}
+
+static int epb_f_slice_add_l(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_ldet det;
+
+	epb_slice_ldet(&det, n);
+
+	return epf_single_ran_slice_add_l(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1, &det);
+}
+
+static int epb_p_slice_add_view(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_view view;
+	slice_id_t        id;
+
+	return epp_single_ran_slice_add_view(buf, size, &id, &view);
+}
+
+static int epb_p_slice_add_a(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_ldet det;
+	slice_id_t        id;
+
+	ep_arena_reset(&epb_arena);
+
+	return epp_single_ran_slice_add_a(buf, size, &epb_arena, &id, &det);
+}
+
+static int epb_f_slice_set_l(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_ldet det;
+
+	epb_slice_ldet(&det, n);
+
+	return epf_single_ran_slice_set_l(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, 1, &det);
+}
+
+static int epb_p_slice_set_view(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_view view;
+	slice_id_t        id;
+
+	return epp_single_ran_slice_set_view(buf, size, &id, &view);
+}
+
+static int epb_p_slice_set_a(char * buf, unsigned int size, uint32_t n)
+{
+	ep_ran_slice_ldet det;
+	slice_id_t        id;
+
+	ep_arena_reset(&epb_arena);
+
+	return epp_single_ran_slice_set_a(buf, size, &epb_arena, &id, &det);
+}
+
+/* Bulk of EPB_SLICES slices, each with 'n' users */
+static int epb_f_bulk_req(char * buf, unsigned int size, uint32_t n)
+{
+	uint32_t i;
+
+	for(i = 0; i < EPB_SLICES; i++) {
+		epb_ops[i].det.nof_users = n;
+	}
+
+	return epf_single_ran_slice_bulk_req(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, EPB_SLICES, epb_ops);
+}
+
+static int epb_p_bulk_req(char * buf, unsigned int size, uint32_t n)
+{
+	uint16_t nof;
+
+	return epp_single_ran_slice_bulk_req(
+		buf, size, &nof, EPB_SLICES, epb_pops);
+}
+
+static int epb_f_bulk_rep(char * buf, unsigned int size, uint32_t n)
+{
+	return epf_single_ran_slice_bulk_rep(
+		buf, size, EPB_ENB, EPB_CELL, EPB_MOD, EPB_SLICES, epb_souts);
+}
+
+static int epb_p_bulk_rep(char * buf, unsigned int size, uint32_t n)
+{
+	uint16_t nof;
+
+	return epp_single_ran_slice_bulk_rep(
+		buf, size, &nof, EPB_SLICES, epb_psouts);
+}
+
+#define EPB_ONE			1, {0}
+#define EPB_UES			4, {0, 100, 1000, 3000}
+#define EPB_CELLS		4, {1, 2, 4, 8}
+#define EPB_USERS		4, {0, 1, 8, 32}
+
+epb_case epb_cases[] = {
+	{"hello_req",      "-",     EPB_ONE,   epb_f_hello_req,    epb_p_hello_req},
+	{"hello_rep",      "-",     EPB_ONE,   epb_f_hello_rep,    epb_p_hello_rep},
+	{"hello_req_fp",   "-",     EPB_ONE,   epb_f_hello_req_fp, epb_p_hello_req_fp},
+	{"shello_req",     "-",     EPB_ONE,   epb_f_shello_req,   epb_p_shello_req},
+	{"shello_rep",     "-",     EPB_ONE,   epb_f_shello_rep,   epb_p_shello_rep},
+	{"shello_req_fp",  "-",     EPB_ONE,   epb_f_shello_req_fp, epb_p_shello_req_fp},
+	{"ecap_req",       "-",     EPB_ONE,   epb_f_ecap_req,     epb_p_ecap_req},
+	{"ecap_rep",       "cells", EPB_CELLS, epb_f_ecap_rep,     epb_p_ecap_rep},
+	{"ecap_rep_a",     "cells", EPB_CELLS, epb_f_ecap_rep_l,   epb_p_ecap_rep_a},
+	{"ccap_req",       "-",     EPB_ONE,   epb_f_ccap_req,     epb_p_ccap_req},
+	{"ccap_rep",       "-",     EPB_ONE,   epb_f_ccap_rep,     epb_p_ccap_rep},
+	{"ho_req",         "-",     EPB_ONE,   epb_f_ho_req,       epb_p_ho_req},
+	{"ho_rep",         "-",     EPB_ONE,   epb_f_ho_rep,       epb_p_ho_rep},
+	{"ho_batch_req",   "ues",   EPB_UES,   epb_f_hob_req,      epb_p_hob_req},
+	{"ho_batch_rep",   "ues",   EPB_UES,   epb_f_hob_rep,      epb_p_hob_rep},
+	{"macrep_req",     "-",     EPB_ONE,   epb_f_macrep_req,   epb_p_macrep_req},
+	{"macrep_rep",     "-",     EPB_ONE,   epb_f_macrep_rep,   epb_p_macrep_rep},
+	{"macrep_unch",    "-",     EPB_ONE,   epb_f_macrep_unch,  epb_p_macrep_unch},
+	{"uerep_req",      "-",     EPB_ONE,   epb_f_uerep_req,    epb_p_uerep_req},
+	{"uerep_rep",      "ues",   EPB_UES,   epb_f_uerep_rep,    epb_p_uerep_rep},
+	{"uerep_rep_max",  "ues",   EPB_UES,   epb_f_uerep_rep_max, epb_p_uerep_rep_max},
+	{"uerep_rep_a",    "ues",   EPB_UES,   epb_f_uerep_rep,    epb_p_uerep_rep_a},
+	{"uerep_rep_view", "ues",   EPB_UES,   epb_f_uerep_rep,    epb_p_uerep_view},
+	{"uemeas_req",     "-",     EPB_ONE,   epb_f_uemeas_req,   epb_p_uemeas_req},
+	{"uemeas_rep",     "meas",  EPB_UES,   epb_f_uemeas_rep,   epb_p_uemeas_rep},
+	{"uemeas_rep_max", "meas",  EPB_UES,   epb_f_uemeas_rep_max, epb_p_uemeas_rep_max},
+	{"ran_setup_req",  "-",     EPB_ONE,   epb_f_ran_setup_req, epb_p_ran_setup_req},
+	{"ran_setup_rep",  "-",     EPB_ONE,   epb_f_ran_setup_rep, epb_p_ran_setup_rep},
+	{"slice_req",      "-",     EPB_ONE,   epb_f_slice_req,    epb_p_slice_req},
+	{"slice_rem",      "-",     EPB_ONE,   epb_f_slice_rem,    epb_p_slice_rem},
+	{"slice_rep",      "users", EPB_USERS, epb_f_slice_rep,    epb_p_slice_rep},
+	{"slice_add",      "users", EPB_USERS, epb_f_slice_add,    epb_p_slice_add},
+	{"slice_set",      "users", EPB_USERS, epb_f_slice_set,    epb_p_slice_set},
+	{"slice_rep_view", "users", EPB_USERS, epb_f_slice_rep_l,  epb_p_slice_rep_view},
+	{"slice_rep_a",    "users", EPB_USERS, epb_f_slice_rep_l,  epb_p_slice_rep_a},
+	{"slice_add_view", "users", EPB_USERS, epb_f_slice_add_l,  epb_p_slice_add_view},
+	{"slice_add_a",    "users", EPB_USERS, epb_f_slice_add_l,  epb_p_slice_add_a},
+	{"slice_set_view", "users", EPB_USERS, epb_f_slice_set_l,  epb_p_slice_set_view},
+	{"slice_set_a",    "users", EPB_USERS, epb_f_slice_set_l,  epb_p_slice_set_a},
+	{"slice_bulk_req", "users", EPB_USERS, epb_f_bulk_req,     epb_p_bulk_req},
+	{"slice_bulk_rep", "-",     EPB_ONE,   epb_f_bulk_rep,     epb_p_bulk_rep},
+};
+
+unsigned int epb_nof_cases = sizeof(epb_cases) / sizeof(epb_case);
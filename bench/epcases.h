@@ -0,0 +1,54 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Cases run by the benchmark and by the tests: every pair of formatter and
+ * parser of the protocols, with the sizes of the messages found in real
+ * deployments (0 to 3000 UEs, 1 to 8 cells, 0 to 32 slice users).
+ */
+
+#ifndef __EMAGE_PROTOCOLS_BENCH_CASES_H
+#define __EMAGE_PROTOCOLS_BENCH_CASES_H
+
+#include <stdint.h>
+
+#include <emproto.h>
+
+/* Size of the buffer messages are formatted into */
+#define EPB_BUF_SIZE		(64 * 1024)
+
+/* A formatter or a parser, with the size of the message as argument */
+typedef int (* epb_op)(char * buf, unsigned int size, uint32_t n);
+
+typedef struct __ep_bench_case {
+	const char * name;  /* Name of the case */
+	const char * param; /* What 'n' means */
+	uint32_t     nof;   /* Number of sizes */
+	uint32_t     n[4];  /* Sizes to run */
+	epb_op       fmt;   /* Formats the message */
+	epb_op       prs;   /* Parses the message */
+} epb_case;
+
+/* Buffer the formatters of the cases write into */
+extern char         epb_buf[EPB_BUF_SIZE];
+
+extern epb_case     epb_cases[];
+extern unsigned int epb_nof_cases;
+
+/* Prepare the data of the messages; call once before running any case */
+void epb_setup(void);
+
+#endif /* __EMAGE_PROTOCOLS_BENCH_CASES_H */
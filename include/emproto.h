@@ -32,6 +32,11 @@ extern "C"
 #endif /* __cplusplus */
 
 #include "emproto/epdbg.h"
+#include "emproto/epbuf.h"
+#include "emproto/eparena.h"
+#include "emproto/epwriter.h"
+#include "emproto/ephash.h"
+#include "emproto/eptimer.h"
 #include "emproto/v1/epdefs.h"
 
 #ifdef __cplusplus
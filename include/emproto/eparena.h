@@ -0,0 +1,80 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ *    EMPOWER AGENT PROTOCOLS ARENA
+ *
+ * Bump allocator for the outputs of the parsers. The '_a' variants of the
+ * parsers allocate exactly the memory the message needs from an arena, which
+ * is given back at once by resetting the arena after the message is handled.
+ *
+ * Memory is organized in chunks which are kept across resets, so once the
+ * arena has grown to the size of the usual messages, parsing allocates nothing
+ * from the system. The first chunk can be provided by the caller, e.g. on the
+ * stack.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_ARENA_H
+#define __EMAGE_PROTOCOLS_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* Default size of the chunks of an arena */
+#define EP_ARENA_CHUNK		4096
+
+typedef struct __ep_arena_chunk {
+	struct __ep_arena_chunk * next; /* Next chunk to use */
+	size_t                    size; /* Usable size of the chunk */
+	int                       ext;  /* Provided by the caller */
+	char                      data[] __attribute__((aligned(8)));
+} ep_arena_chunk;
+
+typedef struct __ep_arena {
+	char *           cur;    /* Next free byte */
+	char *           end;    /* End of the current chunk */
+	ep_arena_chunk * first;  /* Chunks, in order of use */
+	ep_arena_chunk * chunk;  /* Chunk in use */
+	size_t           csize;  /* Size of the new chunks */
+} ep_arena;
+
+/* Initialize an arena, using the given memory as first chunk if not NULL. New
+ * chunks have the same size of the first one, or EP_ARENA_CHUNK if 0.
+ * Returns 0 on success, or -1 on error.
+ */
+int    ep_arena_init(ep_arena * a, void * mem, size_t size);
+
+/* Release all the memory of an arena */
+void   ep_arena_release(ep_arena * a);
+
+/* Allocate memory from the arena, aligned to 8 bytes.
+ * Returns the memory, or NULL if there's not enough of it.
+ */
+void * ep_arena_alloc(ep_arena * a, size_t size);
+
+/* Free everything allocated from the arena, keeping its chunks */
+void   ep_arena_reset(ep_arena * a);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_ARENA_H */
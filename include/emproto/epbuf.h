@@ -0,0 +1,92 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ *    EMPOWER AGENT PROTOCOLS MESSAGE BUFFERS
+ *
+ * Pool of reference counted buffers where to format messages. A message
+ * formatted once can be queued to any number of consumers (socket, capture,
+ * logs...) by taking a reference for each of them, without copying it; the
+ * buffer returns to the pool when the last consumer releases it.
+ *
+ * Buffers come in a few size classes matching the usual messages. Every
+ * thread keeps a cache of free buffers for each class, so allocating and
+ * releasing a buffer takes no lock and calls no malloc; caches exchange
+ * buffers in batches with a global depot only when they run empty or grow
+ * too much. Buffers are never given back to the system.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_BUFFERS_H
+#define __EMAGE_PROTOCOLS_BUFFERS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* Size classes of the buffers */
+#define EP_MBUF_HDR		64	/* Header-only messages, short replies */
+#define EP_MBUF_SMALL		256	/* MAC reports, single UE operations */
+#define EP_MBUF_MEDIUM		1024	/* Capabilities, UE lists */
+#define EP_MBUF_LARGE		4096	/* Long UE lists, slices */
+#define EP_MBUF_MAX		65536	/* Any message */
+
+#define EP_MBUF_CLASSES		5
+
+typedef struct __ep_message_buffer {
+	int                          refs;  /* References to the buffer */
+	uint32_t                     cls;   /* Size class */
+	uint32_t                     size;  /* Capacity of 'data' */
+	uint32_t                     len;   /* Length of the message */
+	struct __ep_message_buffer * next;  /* Next free buffer */
+	char                         data[] __attribute__((aligned(8)));
+} ep_mbuf;
+
+typedef struct __ep_message_buffer_stats {
+	uint64_t allocated;  /* Buffers obtained from the system */
+	uint64_t depot;      /* Buffers in the global depot */
+} ep_mbuf_stats;
+
+/* Get a buffer of at least 'size' bytes, with a single reference and an empty
+ * message.
+ * Returns the buffer, or NULL if 'size' is over EP_MBUF_MAX or there's not
+ * enough memory.
+ */
+ep_mbuf * ep_mbuf_alloc(unsigned int size);
+
+/* Take another reference to a buffer.
+ * Returns the buffer itself.
+ */
+ep_mbuf * ep_mbuf_get(ep_mbuf * m);
+
+/* Release a reference to a buffer; the last one returns it to the pool */
+void      ep_mbuf_put(ep_mbuf * m);
+
+/* Give the free buffers cached by the calling thread back to the depot */
+void      ep_mbuf_trim();
+
+/* Get the statistics of a size class.
+ * Returns 0 on success, or -1 if the class is not valid.
+ */
+int       ep_mbuf_stat(unsigned int cls, ep_mbuf_stats * stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_BUFFERS_H */
@@ -26,24 +26,103 @@ extern "C"
 {
 #endif /* __cplusplus */
 
-/* Utilities included only in the case the software has been built with 
- * Debugging profile ON.
+#include <stdint.h>
+
+/* Tracing is selected at runtime by category, verbosity level and eNB, and
+ * costs a single predictable branch for each trace point while disabled.
+ * The initial setup is read from the EMPROTO_TRACE environment variable, as a
+ * comma separated list of category names plus the optional 'level=<n>' and
+ * 'enb=<id>' filters, e.g.:
+ *
+ *     EMPROTO_TRACE=ho,hdr,level=2,enb=12
+ *
+ * Libraries built with the Debugging profile ON trace everything by default.
+ * Define EP_NO_TRACE to compile the trace points out completely.
+ *
+ * Logs are queued in per-thread lock-free rings and written to the log file
+ * by a background thread, so logging does not slow down the caller.
+ */
+
+/* Trace categories; every action type has its own one */
+#define EP_TRC_ACT(a)		(1ULL << (a))
+#define EP_TRC_HDR		(1ULL << 48)	/* Message headers */
+#define EP_TRC_TLV		(1ULL << 49)	/* Generic TLV tokens */
+#define EP_TRC_CORE		(1ULL << 50)	/* Utilities */
+#define EP_TRC_ALL		(~0ULL)
+
+/* Trace levels; messages are leveled by their nesting (see EP_DBG_n) */
+#define EP_TRC_OFF		0
+#define EP_TRC_ERR		1	/* Top-level messages, mostly errors */
+#define EP_TRC_INFO		2	/* Plus first level of nesting */
+#define EP_TRC_DETAIL		3	/* Plus all the nesting levels */
+#define EP_TRC_DUMP		4	/* Plus hex dumps of the messages */
+
+/* Trace the messages of any eNB */
+#define EP_TRC_ENB_ANY		(~0ULL)
+
+/* Category of the trace points of a module; define it before including the
+ * protocols headers.
  */
-#ifdef EBUG
+#ifndef EP_TRC_CAT
+#define EP_TRC_CAT		EP_TRC_ALL
+#endif
+
 extern volatile int ep_dbg_ready;
 
+/* Categories currently traced */
+extern uint64_t ep_trc_mask;
+
+/* eNB whose messages are being handled by the thread */
+extern __thread uint64_t ep_trc_cur;
+
 /* Initialize the debugging subsystem */
 void ep_dbg_init();
 /* Debug a message into the logging file */
 void ep_dbg(char * prologue, char * buf, int size);
-/* Log something into the debugging subsystem */
-void ep_dbg_log(char * msg, ...);
+/* Write out all the pending logs, without waiting for the drain thread */
+void ep_dbg_flush();
+
+/* Select the traced categories and the verbosity level */
+void ep_trc_set(uint64_t mask, int level);
+/* Trace only the messages of the given eNB, or EP_TRC_ENB_ANY */
+void ep_trc_enb(uint64_t enb_id);
+/* Apply a setup in the EMPROTO_TRACE format.
+ * Returns 0 on success, or -1 if the setup is invalid.
+ */
+int  ep_trc_parse(const char * spec);
+
+/* Slow paths of the trace points */
+void ep_trc_log(uint64_t cat, char * msg, ...)
+	__attribute__((format(printf, 2, 3)));
+void ep_trc_dump(uint64_t cat, char * prologue, char * buf, int size);
+
+#ifndef EP_NO_TRACE
+#define ep_trc_on(c)		\
+	__builtin_expect((ep_trc_mask & (c)) != 0, 0)
+
+#define ep_dbg_log(...)						\
+	do {							\
+		if(ep_trc_on(EP_TRC_CAT))			\
+			ep_trc_log(EP_TRC_CAT, __VA_ARGS__);	\
+	} while(0)
+
+#define ep_dbg_dump(p, m, s)					\
+	do {							\
+		if(ep_trc_on(EP_TRC_CAT))			\
+			ep_trc_dump(EP_TRC_CAT, p, m, s);	\
+	} while(0)
 
-#define ep_dbg_dump(p, m, s)	ep_dbg(p, m, s)
+/* Account the eNB of the message being handled, for the eNB filter */
+#define ep_trc_enb_cur(e)					\
+	do {							\
+		if(ep_trc_on(EP_TRC_ALL))			\
+			ep_trc_cur = (e);			\
+	} while(0)
 #else
-//#define ep_dbg_prologue()	/* ... into nothing */
-#define ep_dbg_log(m, ...)      /* ... into nothing */
-#define ep_dbg_dump(p, m, s)    /* ... into nothing */
+#define ep_trc_on(c)		0
+#define ep_dbg_log(...)		/* ... into nothing */
+#define ep_dbg_dump(p, m, s)	/* ... into nothing */
+#define ep_trc_enb_cur(e)	/* ... into nothing */
 #endif
 
 /* Formatting spacing for nested message categories */
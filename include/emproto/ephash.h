@@ -0,0 +1,76 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ *    EMPOWER AGENT PROTOCOLS HASH MAP
+ *
+ * Fixed capacity, open addressing hash map which associates a key, made of a
+ * 64-bits identifier (like an eNB id) and a 32-bits sub-identifier (like a
+ * sequence number), to a non-zero 32-bits value, usually an index in an array
+ * of elements owned by the caller.
+ *
+ * Memory is allocated only during initialization.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_HASH_H
+#define __EMAGE_PROTOCOLS_HASH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+typedef struct __ep_hash_slot {
+	uint64_t key;
+	uint32_t sub;
+	uint32_t val;   /* 0 marks an empty slot */
+} ep_hslot;
+
+typedef struct __ep_hash_map {
+	ep_hslot * slots;
+	uint32_t   mask;  /* Number of slots - 1 */
+	uint32_t   max;   /* Maximum number of elements */
+	uint32_t   nof;   /* Number of elements */
+} ep_hmap;
+
+/* Initialize a map able to contain up to 'max' elements.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int      ep_hmap_init(ep_hmap * m, uint32_t max);
+
+/* Release the resources of the map */
+void     ep_hmap_release(ep_hmap * m);
+
+/* Returns the value associated to the key, or 0 if not present */
+uint32_t ep_hmap_get(ep_hmap * m, uint64_t key, uint32_t sub);
+
+/* Associate a non-zero value to a key, replacing any previous one.
+ * Returns EP_SUCCESS, or a negative error code if the map is full.
+ */
+int      ep_hmap_put(ep_hmap * m, uint64_t key, uint32_t sub, uint32_t val);
+
+/* Remove a key from the map.
+ * Returns the value which was associated to the key, or 0 if not present.
+ */
+uint32_t ep_hmap_del(ep_hmap * m, uint64_t key, uint32_t sub);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_HASH_H */
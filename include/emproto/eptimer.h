@@ -0,0 +1,134 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ *    EMPOWER AGENT PROTOCOLS TIMER WHEEL
+ *
+ * Hierarchical timer wheel with a resolution of 1 millisecond, used to drive
+ * scheduled actions (see EP_TYPE_SCHEDULE_MSG) from a single thread.
+ *
+ * Timers are intrusive: the caller embeds an 'ep_tw_timer' in its own
+ * structures, so inserting and cancelling a timer is O(1) and nothing is
+ * allocated while the wheel runs. Periodic timers are aligned on a multiple of
+ * their interval, so all the actions sharing the same period expire during the
+ * same tick and can be flushed as one batch of messages.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_TIMER_H
+#define __EMAGE_PROTOCOLS_TIMER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* Bits of a single wheel level */
+#define EP_TW_BITS		6
+/* Slots in a single wheel level */
+#define EP_TW_SLOTS		(1 << EP_TW_BITS)
+/* Number of levels of the wheel */
+#define EP_TW_LEVELS		5
+/* Maximum delay, in ms, which can be placed in the wheel without cascading
+ * again through its top level (~12 days).
+ */
+#define EP_TW_MAX_DELAY		((1ULL << (EP_TW_BITS * EP_TW_LEVELS)) - 1)
+
+struct __ep_timer;
+struct __ep_timer_wheel;
+
+/* Callback invoked when a timer expires */
+typedef void (* ep_tw_cb)(struct __ep_timer * t, void * arg);
+
+/* Callback invoked once per tick, after all the timers of that tick fired */
+typedef void (* ep_tw_flush)(struct __ep_timer_wheel * w, void * arg);
+
+/* Element of the timers lists */
+typedef struct __ep_timer_node {
+	struct __ep_timer_node * next;
+	struct __ep_timer_node * prev;
+} ep_tw_node;
+
+typedef struct __ep_timer {
+	ep_tw_node node;     /* Must be the first element */
+	uint64_t   expires;  /* Absolute expiration time, in ms */
+	uint32_t   interval; /* Period in ms; 0 for one-shot timers */
+	ep_tw_cb   cb;       /* Action to perform */
+	void *     arg;      /* Argument of the action */
+} ep_tw_timer;
+
+typedef struct __ep_timer_wheel {
+	uint64_t      now;        /* Time reached by the wheel, in ms */
+	uint32_t      nof_timers; /* Number of pending timers */
+	ep_tw_timer * running;    /* Timer whose callback is running */
+	ep_tw_flush   flush;      /* Per-tick batch flush */
+	void *        flush_arg;  /* Argument of the flush callback */
+
+	ep_tw_node    slots[EP_TW_LEVELS][EP_TW_SLOTS];
+} ep_tw;
+
+/* Returns the current monotonic time, in ms */
+uint64_t ep_tw_now(void);
+
+/* Initialize a wheel starting at the given time, in ms */
+void ep_tw_init(ep_tw * w, uint64_t now);
+
+/* Set the callback invoked once per tick when one or more timers fired */
+void ep_tw_set_flush(ep_tw * w, ep_tw_flush flush, void * arg);
+
+/* Initialize a timer with its action */
+void ep_tw_timer_init(ep_tw_timer * t, ep_tw_cb cb, void * arg);
+
+/* Is the timer waiting for its expiration? */
+int  ep_tw_pending(ep_tw_timer * t);
+
+/* Arm a one-shot timer which expires after 'delay' ms.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_tw_add(ep_tw * w, ep_tw_timer * t, uint32_t delay);
+
+/* Arm a periodic timer which expires every 'interval' ms. The first expiration
+ * is aligned on a multiple of the interval, so timers with the same period
+ * fire in the same tick.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_tw_sched(ep_tw * w, ep_tw_timer * t, uint32_t interval);
+
+/* Arm a periodic timer using the interval carried by a schedule-event message.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_tw_sched_msg(
+	ep_tw *       w,
+	ep_tw_timer * t,
+	char *        buf,
+	unsigned int  size);
+
+/* Disarm a timer. It is safe to cancel a timer from within any callback.
+ * Returns EP_SUCCESS, or a negative error code if the timer was not armed.
+ */
+int  ep_tw_cancel(ep_tw * w, ep_tw_timer * t);
+
+/* Moves the wheel forward up to the given time, in ms, firing the expired
+ * timers. Returns the number of timers fired.
+ */
+int  ep_tw_advance(ep_tw * w, uint64_t now);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_TIMER_H */
@@ -0,0 +1,109 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ *    EMPOWER AGENT PROTOCOLS WRITER
+ *
+ * Cursor over the buffer a message is formatted into. A formatter which knows
+ * in advance the size of its message (see the epf_*_size() queries) checks the
+ * capacity once with ep_w_need(), and then writes every part of the message
+ * with ep_w_put(), which does no check at all. Parts whose size is not known in
+ * advance are written with ep_w_get(), which checks the capacity each time.
+ *
+ * Errors are sticky: once the capacity is exceeded, or a part of the message
+ * is invalid, the writer stays in error and nothing else is checked out of it.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_WRITER_H
+#define __EMAGE_PROTOCOLS_WRITER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+typedef struct __ep_writer {
+	char *       buf;   /* Buffer the message is formatted into */
+	unsigned int pos;   /* Bytes written so far */
+	unsigned int size;  /* Capacity of the buffer */
+	int          err;   /* Set once something went wrong */
+} ep_writer;
+
+/* Start formatting a message in the given buffer */
+static inline void ep_w_init(ep_writer * w, char * buf, unsigned int size)
+{
+	w->buf  = buf;
+	w->pos  = 0;
+	w->size = buf ? size : 0;
+	w->err  = buf ? 0 : 1;
+}
+
+/* Check that there is room for 'n' more bytes; if not, the writer is put in
+ * error.
+ * Returns 0 if there is room, or -1 otherwise.
+ */
+static inline int ep_w_need(ep_writer * w, unsigned int n)
+{
+	if(w->err || n > w->size - w->pos) {
+		w->err = 1;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Check out the next 'n' bytes without any check; room must have been checked
+ * before with ep_w_need().
+ * Returns where to write the bytes.
+ */
+static inline char * ep_w_put(ep_writer * w, unsigned int n)
+{
+	char * c = w->buf + w->pos;
+
+	w->pos += n;
+
+	return c;
+}
+
+/* Check out the next 'n' bytes, checking the capacity first.
+ * Returns where to write the bytes, or NULL if there is no room.
+ */
+static inline char * ep_w_get(ep_writer * w, unsigned int n)
+{
+	if(ep_w_need(w, n)) {
+		return 0;
+	}
+
+	return ep_w_put(w, n);
+}
+
+/* Put the writer in error, e.g. because a part of the message is invalid */
+static inline void ep_w_fail(ep_writer * w)
+{
+	w->err = 1;
+}
+
+/* Returns the bytes written so far, or -1 if the writer is in error */
+static inline int ep_w_len(ep_writer * w)
+{
+	return w->err ? -1 : (int)w->pos;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_WRITER_H */
@@ -27,6 +27,8 @@
 #include <stdint.h>
 
 #include "eppri.h"
+#include "epop.h"
+#include "../eparena.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -110,6 +112,37 @@ typedef struct __ep_ran_slice_inf {
 	slice_id_t  id;	         /* ID of the Slice */
 }__attribute__((packed)) ep_ran_sinf;
 
+ /*****************************************************************************
+  *                                                                           *
+  * RAN Slice bulk                                                            *
+  *                                                                           *
+  *****************************************************************************/
+
+/* Structure of ep_ran_sblk:
+ *      A bulk request lists 'nof_slices' groups, each made of an operation
+ *      header followed by the TLVs of that slice:
+ *
+ *      || nof_slices | OP0 | TLVs0 | OP1 | TLVs1 | ..... ||
+ *
+ *      A bulk reply lists instead 'nof_slices' ep_ran_sblk_res elements.
+ */
+typedef struct __ep_ran_slice_bulk {
+	uint16_t    nof_slices;  /* Number of slice groups listed */
+}__attribute__((packed)) ep_ran_sblk;
+
+/* Operation on a single slice of a bulk request */
+typedef struct __ep_ran_slice_bulk_op {
+	slice_id_t  id;          /* ID of the Slice */
+	uint8_t     op;          /* Add, set or remove, see epop.h */
+	uint16_t    length;      /* Length of the TLVs which follow */
+}__attribute__((packed)) ep_ran_sblk_op;
+
+/* Result of the operation on a single slice of a bulk request */
+typedef struct __ep_ran_slice_bulk_res {
+	slice_id_t  id;          /* ID of the Slice */
+	uint8_t     result;      /* Result of the operation, see epop.h */
+}__attribute__((packed)) ep_ran_sblk_res;
+
  /*****************************************************************************
   *                                                                           *
   * Opaque structures                                                         *
@@ -130,6 +163,51 @@ typedef struct __ep_ran_slice_details {
 	ep_ran_slice_l2d l2;     /* ID of the active User scheduler */
 } ep_ran_slice_det;
 
+/* Details of a slice with any number of users. Used to format messages, where
+ * the users array is owned by the caller, and by the arena parsers, where it
+ * lives in the arena.
+ */
+typedef struct __ep_ran_slice_list_details {
+	uint32_t         nof_users;
+	rnti_id_t *      users;  /* Users of this slice, in host order */
+	ep_ran_slice_l2d l2;
+} ep_ran_slice_ldet;
+
+/* Details of a slice as found in a message; users are not copied, and the
+ * view is valid as long as the message buffer is. Use ep_ran_slice_user() to
+ * access them.
+ */
+typedef struct __ep_ran_slice_view {
+	uint32_t         nof_users;
+	char *           users;  /* Users of this slice, in network order */
+	ep_ran_slice_l2d l2;
+} ep_ran_slice_view;
+
+/* Returns the i-th user of a slice view */
+#define ep_ran_slice_user(v, i)					\
+	((rnti_id_t)(((uint8_t *)(v)->users)[(i) * 2] << 8 |		\
+	((uint8_t *)(v)->users)[(i) * 2 + 1]))
+
+/* Operation on a slice to format in a bulk request */
+typedef struct __ep_ran_slice_bulk_details {
+	slice_id_t        id;    /* ID of the Slice */
+	ep_op_type        op;    /* Add, set or remove */
+	ep_ran_slice_ldet det;   /* Details of the slice; unused on remove */
+} ep_ran_sblk_det;
+
+/* Operation on a slice as found in a bulk request */
+typedef struct __ep_ran_slice_bulk_view {
+	slice_id_t        id;    /* ID of the Slice */
+	ep_op_type        op;    /* Add, set or remove */
+	ep_ran_slice_view det;   /* Details of the slice */
+} ep_ran_sblk_view;
+
+/* Outcome of the operation on a slice of a bulk request */
+typedef struct __ep_ran_slice_bulk_outcome {
+	slice_id_t        id;     /* ID of the Slice */
+	ep_op_type        result; /* Success, failure, or unchanged */
+} ep_ran_sblk_out;
+
 /* Invalid id for a scheduler */
 #define EP_RAN_SCHED_INVALID	0
 
@@ -177,6 +255,9 @@ int epf_single_ran_rep_success(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id);
 
+/* Returns the size of the message formatted by epf_single_ran_rep_success() */
+unsigned int epf_single_ran_rep_success_size(void);
+
 /* Format a RAN setup operation failed message.
  * Returns the message size or -1 on error.
  */
@@ -201,6 +282,9 @@ int epf_single_ran_rep_fail(
 	mod_id_t     mod_id,
 	slice_id_t   slice_id);
 
+/* Returns the size of the message formatted by epf_single_ran_rep_fail() */
+unsigned int epf_single_ran_rep_fail_size(void);
+
 /* Format a RAN setup operation failed message.
  * Returns the message size or -1 on error.
  */
@@ -225,6 +309,9 @@ int epf_single_ran_rep_ns(
 	mod_id_t     mod_id,
 	slice_id_t   slice_id);
 
+/* Returns the size of the message formatted by epf_single_ran_rep_ns() */
+unsigned int epf_single_ran_rep_ns_size(void);
+
 /******************************************************************************/
 
 /* Formats a RAN setup request message.
@@ -237,6 +324,9 @@ int epf_single_ran_setup_req(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id);
 
+/* Returns the size of the message formatted by epf_single_ran_setup_req() */
+unsigned int epf_single_ran_setup_req_size(void);
+
 /* Parses a RAN setup request message.
  * Returns EP_SUCCESS on success, otherwise a negative error code.
  */
@@ -255,6 +345,12 @@ int epf_single_ran_setup_rep(
 	mod_id_t     mod_id,
 	ep_ran_det * ran);
 
+/* Returns the size of the message formatted by epf_single_ran_setup_rep() with
+ * the given details; the MAC scheduler TLV is there only if a slice scheduler
+ * is set.
+ */
+unsigned int epf_single_ran_setup_rep_size(ep_ran_det * ran);
+
 /* Parses a RAN setup reply message.
  * Returns EP_SUCCESS on success, otherwise a negative error code.
  */
@@ -276,6 +372,9 @@ int epf_single_ran_slice_req(
 	mod_id_t           mod_id,
 	slice_id_t         slice_id);
 
+/* Returns the size of the message formatted by epf_single_ran_slice_req() */
+unsigned int epf_single_ran_slice_req_size(void);
+
 /* Parses a RAN Slice request message.
  * Returns EP_SUCCESS on success, otherwise a negative error code.
  */
@@ -296,6 +395,11 @@ int epf_single_ran_slice_rep(
 	slice_id_t         slice_id,
 	ep_ran_slice_det * det);
 
+/* Returns the size of the message formatted by epf_single_ran_slice_rep() with
+ * the given details; at most EP_RAN_USERS_MAX users are accounted.
+ */
+unsigned int epf_single_ran_slice_rep_size(ep_ran_slice_det * det);
+
 /* Parses a RAN Slice reply message.
  * Returns EP_SUCCESS on success, otherwise a negative error code.
  */
@@ -317,6 +421,11 @@ int epf_single_ran_slice_add(
 	slice_id_t         slice_id,
 	ep_ran_slice_det * det);
 
+/* Returns the size of the message formatted by epf_single_ran_slice_add() with
+ * the given details, as for epf_single_ran_slice_rep_size().
+ */
+unsigned int epf_single_ran_slice_add_size(ep_ran_slice_det * det);
+
 /* Parses a RAN Slice add message.
  * Returns EP_SUCCESS on success, otherwise a negative error code.
  */
@@ -337,6 +446,9 @@ int epf_single_ran_slice_rem(
 	mod_id_t           mod_id,
 	slice_id_t         slice_id);
 
+/* Returns the size of the message formatted by epf_single_ran_slice_rem() */
+unsigned int epf_single_ran_slice_rem_size(void);
+
 /* Parses a RAN Slice remove message.
  * Returns EP_SUCCESS on success, otherwise a negative error code.
  */
@@ -357,6 +469,11 @@ int epf_single_ran_slice_set(
 	slice_id_t         slice_id,
 	ep_ran_slice_det * det);
 
+/* Returns the size of the message formatted by epf_single_ran_slice_set() with
+ * the given details, as for epf_single_ran_slice_rep_size().
+ */
+unsigned int epf_single_ran_slice_set_size(ep_ran_slice_det * det);
+
 /* Parses a RAN Slice set message.
  * Returns EP_SUCCESS on success, otherwise a negative error code.
  */
@@ -366,6 +483,193 @@ int epp_single_ran_slice_set(
 	slice_id_t *       slice_id,
 	ep_ran_slice_det * det);
 
+/******************************************************************************/
+
+/* Formats a RAN Slice reply message with any number of users.
+ * Returns the message size or -1 on error.
+ */
+int epf_single_ran_slice_rep_l(
+	char *              buf,
+	unsigned int        size,
+	enb_id_t            enb_id,
+	cell_id_t           cell_id,
+	mod_id_t            mod_id,
+	slice_id_t          slice_id,
+	ep_ran_slice_ldet * det);
+
+/* Returns the size of the message formatted by epf_single_ran_slice_rep_l()
+ * with the given details and all their users.
+ */
+unsigned int epf_single_ran_slice_rep_l_size(ep_ran_slice_ldet * det);
+
+/* Parses a RAN Slice reply message into a view, without copying the users.
+ * Returns EP_SUCCESS on success, otherwise a negative error code.
+ */
+int epp_single_ran_slice_rep_view(
+	char *              buf,
+	unsigned int        size,
+	slice_id_t *        slice_id,
+	ep_ran_slice_view * view);
+
+/* Parses a RAN Slice reply message, with its users allocated from the arena.
+ * Returns EP_SUCCESS on success, otherwise a negative error code.
+ */
+int epp_single_ran_slice_rep_a(
+	char *              buf,
+	unsigned int        size,
+	ep_arena *          arena,
+	slice_id_t *        slice_id,
+	ep_ran_slice_ldet * det);
+
+/* Formats a RAN Slice add message with any number of users.
+ * Returns the message size or -1 on error.
+ */
+int epf_single_ran_slice_add_l(
+	char *              buf,
+	unsigned int        size,
+	enb_id_t            enb_id,
+	cell_id_t           cell_id,
+	mod_id_t            mod_id,
+	slice_id_t          slice_id,
+	ep_ran_slice_ldet * det);
+
+/* Returns the size of the message formatted by epf_single_ran_slice_add_l()
+ * with the given details and all their users.
+ */
+unsigned int epf_single_ran_slice_add_l_size(ep_ran_slice_ldet * det);
+
+/* Parses a RAN Slice add message into a view, without copying the users.
+ * Returns EP_SUCCESS on success, otherwise a negative error code.
+ */
+int epp_single_ran_slice_add_view(
+	char *              buf,
+	unsigned int        size,
+	slice_id_t *        slice_id,
+	ep_ran_slice_view * view);
+
+/* Parses a RAN Slice add message, with its users allocated from the arena.
+ * Returns EP_SUCCESS on success, otherwise a negative error code.
+ */
+int epp_single_ran_slice_add_a(
+	char *              buf,
+	unsigned int        size,
+	ep_arena *          arena,
+	slice_id_t *        slice_id,
+	ep_ran_slice_ldet * det);
+
+/* Formats a RAN Slice set message with any number of users.
+ * Returns the message size or -1 on error.
+ */
+int epf_single_ran_slice_set_l(
+	char *              buf,
+	unsigned int        size,
+	enb_id_t            enb_id,
+	cell_id_t           cell_id,
+	mod_id_t            mod_id,
+	slice_id_t          slice_id,
+	ep_ran_slice_ldet * det);
+
+/* Returns the size of the message formatted by epf_single_ran_slice_set_l()
+ * with the given details and all their users.
+ */
+unsigned int epf_single_ran_slice_set_l_size(ep_ran_slice_ldet * det);
+
+/* Parses a RAN Slice set message into a view, without copying the users.
+ * Returns EP_SUCCESS on success, otherwise a negative error code.
+ */
+int epp_single_ran_slice_set_view(
+	char *              buf,
+	unsigned int        size,
+	slice_id_t *        slice_id,
+	ep_ran_slice_view * view);
+
+/* Parses a RAN Slice set message, with its users allocated from the arena.
+ * Returns EP_SUCCESS on success, otherwise a negative error code.
+ */
+int epp_single_ran_slice_set_a(
+	char *              buf,
+	unsigned int        size,
+	ep_arena *          arena,
+	slice_id_t *        slice_id,
+	ep_ran_slice_ldet * det);
+
+/******************************************************************************/
+
+/* Formats a RAN Slice bulk request, with operations on 'nof' slices.
+ * Returns the message size or -1 on error.
+ */
+int epf_single_ran_slice_bulk_req(
+	char *            buf,
+	unsigned int      size,
+	enb_id_t          enb_id,
+	cell_id_t         cell_id,
+	mod_id_t          mod_id,
+	uint16_t          nof,
+	ep_ran_sblk_det * ops);
+
+/* Returns the size of the message formatted by epf_single_ran_slice_bulk_req()
+ * with the given operations; removals carry no details.
+ */
+unsigned int epf_single_ran_slice_bulk_req_size(
+	uint16_t nof,
+	ep_ran_sblk_det * ops);
+
+/* Parses a RAN Slice bulk request. 'nof' is set to the number of operations
+ * listed in the message, while only up to 'max' of them are stored in 'ops'.
+ * Users are not copied, and 'ops' is valid as long as the message buffer is.
+ * Returns EP_SUCCESS on success, otherwise a negative error code.
+ */
+int epp_single_ran_slice_bulk_req(
+	char *             buf,
+	unsigned int       size,
+	uint16_t *         nof,
+	uint16_t           max,
+	ep_ran_sblk_view * ops);
+
+/* Formats a RAN Slice bulk reply with the outcome of every operation. The
+ * operation of the message is Success only if all the slices succeeded.
+ * Returns the message size or -1 on error.
+ */
+int epf_single_ran_slice_bulk_rep(
+	char *            buf,
+	unsigned int      size,
+	enb_id_t          enb_id,
+	cell_id_t         cell_id,
+	mod_id_t          mod_id,
+	uint16_t          nof,
+	ep_ran_sblk_out * outs);
+
+/* Returns the size of the message formatted by epf_single_ran_slice_bulk_rep()
+ * with the given number of outcomes.
+ */
+unsigned int epf_single_ran_slice_bulk_rep_size(uint16_t nof);
+
+/* Formats a RAN Slice bulk not supported reply.
+ * Returns the message size or -1 on error.
+ */
+int epf_single_ran_slice_bulk_rep_ns(
+	char *            buf,
+	unsigned int      size,
+	enb_id_t          enb_id,
+	cell_id_t         cell_id,
+	mod_id_t          mod_id);
+
+/* Returns the size of the message formatted by
+ * epf_single_ran_slice_bulk_rep_ns()
+ */
+unsigned int epf_single_ran_slice_bulk_rep_ns_size(void);
+
+/* Parses a RAN Slice bulk reply. 'nof' is set to the number of outcomes
+ * listed in the message, while only up to 'max' of them are stored in 'outs'.
+ * Returns EP_SUCCESS on success, otherwise a negative error code.
+ */
+int epp_single_ran_slice_bulk_rep(
+	char *            buf,
+	unsigned int      size,
+	uint16_t *        nof,
+	uint16_t          max,
+	ep_ran_sblk_out * outs);
+
 /******************************************************************************
  * Operation on schedule-event messages                                       *
  ******************************************************************************/
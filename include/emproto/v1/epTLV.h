@@ -24,6 +24,7 @@
 #include <stdint.h>
 
 #include "eppri.h"
+#include "../epwriter.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -49,6 +50,9 @@ enum ep_TLV_type {
 	 * Type 2 reserved to eNB
 	 */
 
+	/* Token contains a fingerprint of the eNB capabilities */
+	EP_TLV_ENB_CAP_HASH        = 0x0200,
+
 	/*
 	 * Type 3 reserved to Handover
 	 */
@@ -95,16 +99,27 @@ typedef struct __ep_hdr_TLV {
 /* Format a generic RNTI report TLV token (just a bunch of RNTIs).
  * Returns the message size or -1 on error.
  */
-int epf_TLV_rnti_report(
+EP_INL int epf_TLV_rnti_report(
 	char *       buf, 
 	unsigned int size, 
 	rnti_id_t *  rntis,
 	uint32_t     nof_rntis);
 
+/* Size of a generic RNTI report TLV token with the given number of RNTIs */
+EP_INL unsigned int epf_TLV_rnti_report_size(uint32_t nof_rntis);
+
+/* Write a generic RNTI report TLV token through the given writer, which must
+ * have room for epf_TLV_rnti_report_size() bytes.
+ */
+EP_INL void epf_TLV_rnti_report_w(
+	ep_writer *  w,
+	rnti_id_t *  rntis,
+	uint32_t     nof_rntis);
+
 /* Parses a generic RNTI report TLV token.
  * Returns EP_SUCCESS on success, otherwise a negative error code.
  */
-int epp_TLV_rnti_report(
+EP_INL int epp_TLV_rnti_report(
 	char *       buf,
 	rnti_id_t *  rntis,
 	uint32_t  *  nof_rntis);
@@ -0,0 +1,128 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Definitions of the generic TLV tokens accessors. They are built into the
+ * library and, if EP_INLINE is defined before including the protocols headers,
+ * also inlined in the module including them; see eppri.h.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_TLV_INL_H
+#define __EMAGE_PROTOCOLS_TLV_INL_H
+
+#include <endian.h>
+#include <arpa/inet.h>
+
+/* Trace points of the module, whatever module includes them */
+#pragma push_macro("EP_TRC_CAT")
+#undef  EP_TRC_CAT
+#define EP_TRC_CAT		EP_TRC_TLV
+
+/*
+ * 
+ * Generic TLV: RNTI container
+ * 
+ */
+
+EP_INL unsigned int epf_TLV_rnti_report_size(uint32_t nof_rntis)
+{
+	return sizeof(ep_TLV) + nof_rntis * sizeof(rnti_id_t);
+}
+
+EP_INL int epf_TLV_rnti_report(
+	char *       buf, 
+	unsigned int size, 
+	rnti_id_t *  rntis,
+	uint32_t     nof_rntis)
+{
+	ep_writer w;
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_TLV_rnti_report_size(nof_rntis))) {
+		ep_dbg_log(EP_DBG_3"F - RNTIREP TLV: Not enough space!\n");
+		return -1;
+	}
+
+	epf_TLV_rnti_report_w(&w, rntis, nof_rntis);
+
+	return ep_w_len(&w);
+}
+
+EP_INL void epf_TLV_rnti_report_w(
+	ep_writer *  w,
+	rnti_id_t *  rntis,
+	uint32_t     nof_rntis)
+{
+	uint32_t    i;
+	ep_TLV *    tlv;
+	rnti_id_t * cur;
+
+	tlv = (ep_TLV *)ep_w_put(w, sizeof(ep_TLV));
+	cur = (rnti_id_t *)ep_w_put(w, nof_rntis * sizeof(rnti_id_t));
+
+	tlv->type   = htons(EP_TLV_RNTI_REPORT);
+
+	/* Scan the array while incrementing the RNTIs pointer */
+	for(i = 0; i < nof_rntis; i++, cur++) {
+		*cur = htons(rntis[i]);
+	}
+
+	tlv->length = htons((char *)cur - ((char *)tlv + sizeof(ep_TLV)));
+
+	ep_dbg_dump(EP_DBG_3"F - RNTIREP TLV: ", 
+		(char *)tlv, (char *)cur - (char *)tlv);
+}
+
+EP_INL int epp_TLV_rnti_report(
+	char *       buf, 
+	rnti_id_t *  rntis,
+	uint32_t  *  nof_rntis)
+{
+	int         i = 0;/* Index */
+	uint32_t    c = 0;/* Count */
+	int         s;    /* Size */
+	
+	ep_TLV *    tlv = (ep_TLV *)buf;
+	rnti_id_t * cur = (rnti_id_t *)(buf + sizeof(ep_TLV));
+
+	s = ntohs(tlv->length);
+	c = s / sizeof(rnti_id_t);
+
+	if(c > *nof_rntis) {
+		c = *nof_rntis;
+	}
+
+	*nof_rntis = c;
+
+	/* Continue until you reach the end of the given TLV */
+	//while((char *)cur <= buf + sizeof(ep_TLV) + s) {
+	while(c > 0) {
+		rntis[i] = ntohs(*cur);
+
+		cur++;/* Go to the next rnti; pointer aritmetics */
+		c--;  /* Decrement the number of rnti to scan */
+		i++;  /* Increment the index*/
+	}
+
+	ep_dbg_dump(EP_DBG_3"P - RNTIREP TLV: ", buf, (char *)cur - buf);
+
+	return EP_SUCCESS;
+}
+
+#pragma pop_macro("EP_TRC_CAT")
+
+#endif /* __EMAGE_PROTOCOLS_TLV_INL_H */
@@ -0,0 +1,137 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*    CAPABILITIES CACHE
+ *
+ * Controller-side cache of the eNB capabilities, keyed by eNB id and by the
+ * capabilities fingerprint the agent carries in its Hello request.
+ *
+ * An agent which reconnects with the same fingerprint did not change its
+ * capabilities, and the controller can skip the eNB/cell capabilities requests
+ * of the connection life-cycle.
+ *
+ * Capabilities are stored as immutable, reference counted, records holding
+ * any number of cells. Readers share the same record by reference instead of
+ * copying it, and a record is replaced only when a new eNB capabilities reply
+ * actually differs from it; readers holding a reference to the old record
+ * keep using it until they release it.
+ *
+ * The cache itself is not thread-safe, but records can be retained and
+ * released from any thread.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_CAPABILITIES_CACHE_H
+#define __EMAGE_PROTOCOLS_CAPABILITIES_CACHE_H
+
+#include <stdint.h>
+
+#include "eppri.h"
+#include "epenbcap.h"
+#include "../ephash.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+typedef struct __ep_capabilities {
+	int         refs;      /* References to the record */
+	enb_id_t    enb_id;    /* eNB owning the capabilities */
+	uint64_t    hash;      /* Fingerprint of the capabilities */
+	uint32_t    capmask;   /* eNB capabilities; see 'ep_ecap_type' */
+	uint32_t    nof_cells; /* Number of cells */
+	ep_cell_det cells[];   /* Capabilities of the cells */
+} ep_caps;
+
+typedef struct __ep_capabilities_cache_entry {
+	enb_id_t    enb_id;    /* eNB owning the capabilities */
+	ep_caps *   caps;      /* Current capabilities of the eNB */
+	uint32_t    next;      /* Next free entry, if not in use */
+} ep_capc_ent;
+
+typedef struct __ep_capabilities_cache {
+	ep_hmap       map;     /* eNB id --> index of the entry + 1 */
+	ep_capc_ent * ents;    /* Entries storage */
+	uint32_t      max;     /* Maximum number of entries */
+	uint32_t      free;    /* First free entry + 1 */
+} ep_capc;
+
+/* Take a reference to a capabilities record.
+ * Returns the record itself.
+ */
+ep_caps * ep_caps_get(ep_caps * caps);
+
+/* Release a reference to a capabilities record */
+void ep_caps_put(ep_caps * caps);
+
+/* Initialize a cache for up to 'max' eNBs.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_capc_init(ep_capc * c, uint32_t max);
+
+/* Release the resources of the cache */
+void ep_capc_release(ep_capc * c);
+
+/* Store the capabilities of an eNB, as obtained after an Hello request with
+ * the given fingerprint. Replaces any previous capabilities of the eNB.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_capc_store(
+	ep_capc *    c,
+	enb_id_t     enb_id,
+	uint64_t     hash,
+	ep_enb_det * det);
+
+/* Store the capabilities carried by an eNB capabilities reply, with all its
+ * cells. The record of the eNB is replaced only if the reply differs from it.
+ * Returns 1 if the capabilities changed, 0 if not, or a negative error code.
+ */
+int  ep_capc_ecap(ep_capc * c, char * buf, unsigned int size);
+
+/* Look for the current capabilities of an eNB, whatever their fingerprint.
+ * The record is valid until the capabilities of the eNB change; use
+ * ep_caps_get() to keep it longer.
+ * Returns the capabilities, or NULL if unknown.
+ */
+ep_caps * ep_capc_get(ep_capc * c, enb_id_t enb_id);
+
+/* Look for the capabilities of an eNB with the given fingerprint. The record
+ * is valid as for ep_capc_get().
+ * Returns the capabilities, or NULL if they are unknown or changed.
+ */
+ep_caps * ep_capc_lookup(ep_capc * c, enb_id_t enb_id, uint64_t hash);
+
+/* Look for the capabilities of the eNB which sent the given Hello request,
+ * either single-event or schedule-event one. The fingerprint found in the
+ * message is returned in 'hash', if given.
+ * Returns the capabilities, or NULL if the capabilities have to be requested.
+ */
+ep_caps * ep_capc_hello(
+	ep_capc *    c,
+	char *       buf,
+	unsigned int size,
+	uint64_t *   hash);
+
+/* Forget the capabilities of an eNB.
+ * Returns EP_SUCCESS, or a negative error code if the eNB is not known.
+ */
+int  ep_capc_remove(ep_capc * c, enb_id_t enb_id);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_CAPABILITIES_CACHE_H */
@@ -0,0 +1,177 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*    MESSAGES CAPTURE
+ *
+ * Binary capture of the messages formatted and parsed by the library, and an
+ * indexed reader of such captures. Formatted messages are captured by
+ * epf_msg_length(). Received messages are captured once for every call to
+ * epp_head() or ep_msg_validate(), where they enter the library; the library
+ * itself reads them again through epp_head_peek(), which does not capture.
+ *
+ * A capture is a sequence of segments named '<prefix>.<n>.epcap', each one
+ * starting with an 'ep_cap_shdr' and followed by records. Every record is an
+ * 'ep_cap_rec' followed by the raw message, padded to 8 bytes. Capture
+ * headers are in host byte order, while messages are kept as they are on the
+ * wire.
+ *
+ * Sequence numbers injected with epf_seq() after formatting are reported in
+ * the captured message too.
+ *
+ * The reader maps the segments in memory and keeps an index of the messages
+ * sorted by eNB, type, action and sequence number in '<prefix>.epidx', which
+ * is built once and reused as long as the capture does not change.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_CAPTURE_H
+#define __EMAGE_PROTOCOLS_CAPTURE_H
+
+#include <stdint.h>
+
+#include "eppri.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* Direction of the captured messages */
+#define EP_CAP_OUT		0	/* Formatted by the library */
+#define EP_CAP_IN		1	/* Parsed by the library */
+
+/* Default size of a capture segment, in bytes */
+#define EP_CAP_SEG_DEFAULT	(64 * 1024 * 1024)
+
+/* Magic of the capture segments and of their index */
+#define EP_CAP_MAGIC		"EPCAP\0\0\1"
+#define EP_CAP_IDX_MAGIC	"EPCAPIX\1"
+
+typedef struct __ep_capture_segment_header {
+	char     magic[8];  /* EP_CAP_MAGIC */
+	uint32_t seg;       /* Number of the segment */
+	uint32_t dummy;
+	uint64_t start;     /* Time of creation, in ns since Epoch */
+} __attribute__((packed)) ep_cap_shdr;
+
+typedef struct __ep_capture_record {
+	uint32_t len;       /* Length of the message */
+	uint8_t  dir;       /* Direction; see EP_CAP_OUT/EP_CAP_IN */
+	uint8_t  dummy[3];
+	uint64_t ts;        /* Time of capture, in ns since Epoch */
+} __attribute__((packed)) ep_cap_rec;
+
+/* Capture is active */
+extern int ep_cap_on;
+
+/* Start capturing messages in segments of at most 'seg_size' bytes; a size of
+ * 0 selects EP_CAP_SEG_DEFAULT. Capture can also be started by setting the
+ * EMPROTO_CAPTURE environment variable to the prefix of the segments.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_cap_open(const char * prefix, uint64_t seg_size);
+
+/* Stop capturing and write out the pending records */
+void ep_cap_close();
+
+/* Write out the pending records */
+void ep_cap_flush();
+
+/* Capture a message, whose length is taken from its header */
+void ep_cap_msg(char * buf, unsigned int size, int dir);
+
+/* Report the sequence number of the last message captured by the thread */
+void ep_cap_seq(char * buf, uint32_t seq);
+
+/* Hooks of the formatters and parsers */
+#define ep_cap_hook(b, s, d)					\
+	do {							\
+		if(__builtin_expect(ep_cap_on, 0))		\
+			ep_cap_msg(b, s, d);			\
+	} while(0)
+
+#define ep_cap_hook_seq(b, s)					\
+	do {							\
+		if(__builtin_expect(ep_cap_on, 0))		\
+			ep_cap_seq(b, s);			\
+	} while(0)
+
+/******************************************************************************
+ * Reader                                                                     *
+ ******************************************************************************/
+
+typedef struct __ep_capture_index_entry {
+	enb_id_t enb_id;    /* eNB of the message */
+	uint32_t seq;       /* Sequence number of the message */
+	uint16_t action;    /* Action type, or EP_ACT_INVALID */
+	uint8_t  type;      /* Message type */
+	uint8_t  dir;       /* Direction of the capture */
+	uint64_t ts;        /* Time of capture, in ns since Epoch */
+	uint32_t seg;       /* Segment of the record */
+	uint32_t dummy;
+	uint64_t off;       /* Offset of the record in the segment */
+} ep_cap_ent;
+
+typedef struct __ep_capture_reader {
+	uint32_t     nof_segs;  /* Number of segments */
+	char **      segs;      /* Mapped segments */
+	uint64_t *   sizes;     /* Size of the segments */
+	ep_cap_ent * ents;      /* Index, sorted by eNB/type/action/seq */
+	uint64_t     nof_ents;  /* Number of messages */
+	char *       imap;      /* Mapped index file, if any */
+	uint64_t     isize;     /* Size of the mapped index file */
+} ep_capr;
+
+/* Position in a capture, when iterating in capture order */
+typedef struct __ep_capture_position {
+	uint32_t seg;
+	uint64_t off;
+} ep_capr_pos;
+
+/* Open the capture with the given prefix, using or building its index.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_capr_open(ep_capr * r, const char * prefix);
+
+/* Release the resources of the reader */
+void ep_capr_close(ep_capr * r);
+
+/* Find the messages of an eNB, optionally of a type (or -1) and an action (or
+ * -1); the action is considered only if the type is given. Such messages are
+ * contiguous in the index, ordered by sequence number.
+ * Returns the first entry, or NULL if there are none.
+ */
+ep_cap_ent * ep_capr_find(
+	ep_capr *    r,
+	enb_id_t     enb_id,
+	int          type,
+	int          action,
+	uint64_t *   nof);
+
+/* Get the message of an index entry.
+ * Returns the message, or NULL on error.
+ */
+char * ep_capr_msg(ep_capr * r, ep_cap_ent * e, ep_cap_rec ** rec);
+
+/* Iterate the messages in capture order, starting from a zeroed position.
+ * Returns the next message, or NULL at the end of the capture.
+ */
+char * ep_capr_next(ep_capr * r, ep_capr_pos * pos, ep_cap_rec ** rec);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_CAPTURE_H */
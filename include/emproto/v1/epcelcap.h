@@ -90,6 +90,9 @@ int epf_single_ccap_rep_fail(
 	cell_id_t     cell_id,
 	mod_id_t      mod_id);
 
+/* Size of the message formatted by epf_single_ccap_rep_fail() */
+unsigned int epf_single_ccap_rep_fail_size(void);
+
 /* Format a cell capabilities reply.
  * Returns the size of the message, or a negative error number.
  */
@@ -101,6 +104,9 @@ int epf_single_ccap_rep(
 	mod_id_t      mod_id,
 	ep_cell_det * cell);
 
+/* Size of the message formatted by epf_single_ccap_rep() */
+unsigned int epf_single_ccap_rep_size(void);
+
 /* Parse a cell capabilities reply looking for the desired fields */
 int epp_single_ccap_rep(
 	char *        buf,
@@ -117,6 +123,9 @@ int epf_single_ccap_req(
 	cell_id_t     cell_id,
 	mod_id_t      mod_id);
 
+/* Size of the message formatted by epf_single_ccap_req() */
+unsigned int epf_single_ccap_req_size(void);
+
 /* Parse a cell capabilities request for the desired fields */
 int epp_single_ccap_req(char * buf, unsigned int size);
 
@@ -0,0 +1,153 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*    REQUEST/REPLY CORRELATOR
+ *
+ * Controller-side table of the requests waiting for a reply, keyed by the eNB
+ * the request is sent to and by the sequence number of the message. Replies
+ * are matched in constant time, while the requests which are not answered in
+ * time are expired through a timer wheel.
+ *
+ * The round trip time of every matched request is accounted in a latency
+ * histogram of its action, with buckets which are powers of 2 microseconds.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_CORRELATOR_H
+#define __EMAGE_PROTOCOLS_CORRELATOR_H
+
+#include <stdint.h>
+
+#include "eppri.h"
+#include "eptype.h"
+#include "../ephash.h"
+#include "../eptimer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* Default time a request waits for its reply, in ms */
+#define EP_CORR_TIMEOUT_DEFAULT	5000
+
+/* Number of actions with a dedicated histogram; others use EP_ACT_INVALID */
+#define EP_CORR_ACT_MAX		16
+
+/* Number of buckets of the histograms. Bucket 0 holds latencies under 1 us,
+ * bucket 'i' latencies in [2^(i-1), 2^i) us, and the last one everything above
+ * (~4 seconds).
+ */
+#define EP_CORR_BUCKETS		24
+
+/* Callback invoked when a request did not receive its reply in time */
+typedef void (* ep_corr_cb)(
+	enb_id_t    enb_id,
+	uint32_t    seq,
+	ep_act_type act,
+	void *      arg);
+
+typedef struct __ep_correlator_histogram {
+	uint64_t count;       /* Number of replies matched */
+	uint64_t sum;         /* Sum of the latencies, in us */
+	uint64_t min;         /* Minimum latency, in us */
+	uint64_t max;         /* Maximum latency, in us */
+	uint64_t nof_timeout; /* Number of requests expired */
+	uint64_t buckets[EP_CORR_BUCKETS];
+} ep_corr_hist;
+
+typedef struct __ep_correlator_entry {
+	ep_tw_timer timer;    /* Must be the first element */
+	enb_id_t    enb_id;   /* eNB the request was sent to */
+	uint32_t    seq;      /* Sequence number of the request */
+	uint8_t     act;      /* Action of the request */
+	uint64_t    start;    /* Time the request was formatted, in us */
+	uint32_t    next;     /* Next free entry, if not in use */
+} ep_corr_ent;
+
+typedef struct __ep_correlator {
+	ep_tw         wheel;   /* Deadlines of the requests */
+	ep_hmap       map;     /* (eNB id, seq) --> index of the entry + 1 */
+	ep_corr_ent * ents;    /* Entries storage */
+	uint32_t      max;     /* Maximum number of pending requests */
+	uint32_t      free;    /* First free entry + 1 */
+	uint32_t      nof_pending;
+	uint32_t      nof_expired;
+	uint32_t      timeout; /* Time to wait for a reply, in ms */
+	ep_corr_cb    cb;      /* Invoked when a request expires */
+	void *        arg;     /* Argument of the callback */
+
+	ep_corr_hist  hist[EP_CORR_ACT_MAX];
+} ep_corr;
+
+/* Returns the current monotonic time, in us */
+uint64_t ep_corr_now(void);
+
+/* Initialize a correlator for up to 'max' pending requests. A timeout of 0
+ * selects the default one. Time is given in us, see ep_corr_now().
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_corr_init(
+	ep_corr *    c,
+	uint32_t     max,
+	uint32_t     timeout,
+	uint64_t     now,
+	ep_corr_cb   cb,
+	void *       arg);
+
+/* Release the resources of the correlator */
+void ep_corr_release(ep_corr * c);
+
+/* Account a request which has just been formatted in the given buffer. The
+ * eNB, the sequence number and the action are taken from the message itself.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_corr_request(ep_corr * c, char * buf, unsigned int size, uint64_t now);
+
+/* Match a reply received from an agent with its pending request, and account
+ * its latency. The latency, in us, is returned in 'lat', if given.
+ * Returns EP_SUCCESS, or a negative error code if no request is pending.
+ */
+int  ep_corr_reply(
+	ep_corr *    c,
+	char *       buf,
+	unsigned int size,
+	uint64_t     now,
+	uint64_t *   lat);
+
+/* Stop waiting for the reply of a request, without accounting it.
+ * Returns EP_SUCCESS, or a negative error code if no request is pending.
+ */
+int  ep_corr_cancel(ep_corr * c, enb_id_t enb_id, uint32_t seq);
+
+/* Report, through the callback, all the requests whose timeout expired up to
+ * the given time, in us. Such requests are no more pending.
+ * Returns the number of expired requests.
+ */
+int  ep_corr_expire(ep_corr * c, uint64_t now);
+
+/* Returns the latency histogram of an action */
+ep_corr_hist * ep_corr_stats(ep_corr * c, ep_act_type act);
+
+/* Returns the latency, in us, under which falls the given percentage (0-100)
+ * of the replies of an histogram, with the precision of its buckets.
+ */
+uint64_t ep_corr_percentile(ep_corr_hist * h, unsigned int perc);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_CORRELATOR_H */
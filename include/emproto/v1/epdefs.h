@@ -55,6 +55,22 @@ extern "C"
 #include "epmacrep.h"
 #include "epho.h"
 #include "epRAN.h"
+#include "epview.h"
+
+#include "epka.h"
+#include "epcache.h"
+#include "epcorr.h"
+#include "epslice.h"
+#include "epcap.h"
+
+/* Header and TLV accessors, inlined in the module; see eppri.h */
+#ifdef EP_INLINE
+#include "ephdr_inl.h"
+#include "epTLV_inl.h"
+#include "epsingle_inl.h"
+#include "epsched_inl.h"
+#include "eptrig_inl.h"
+#endif /* EP_INLINE */
 
 #ifdef __cplusplus
 }
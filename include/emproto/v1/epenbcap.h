@@ -27,6 +27,7 @@
 
 #include "eppri.h"
 #include "epcelcap.h"
+#include "../eparena.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -74,6 +75,26 @@ typedef struct __ep_enb_details {
 	uint32_t    nof_cells;
 } ep_enb_det;
 
+/* Details of an eNB with any number of cells, as parsed in an arena */
+typedef struct __ep_enb_list_details {
+	uint32_t      capmask;   /* See 'ep_ecap_type' */
+	uint32_t      nof_cells; /* Number of cells */
+	ep_cell_det * cells;     /* Cells, allocated in the arena */
+} ep_enb_ldet;
+
+/* Computes the fingerprint of the eNB capabilities, to be carried in the Hello
+ * request of the agent. The fingerprint is never EP_HELLO_NO_HASH.
+ */
+uint64_t ep_ecap_fingerprint(ep_enb_det * det);
+
+/* Computes the fingerprint of the eNB capabilities, given as an array of cells
+ * of any length. Same as ep_ecap_fingerprint() for up to EP_ECAP_CELL_MAX cells.
+ */
+uint64_t ep_ecap_fingerprint_l(
+	uint32_t      capmask,
+	uint32_t      nof_cells,
+	ep_cell_det * cells);
+
 /* Format an eNB capabilities negative reply.
  * Returns the size of the message, or a negative error number.
  */
@@ -84,6 +105,9 @@ int epf_single_ecap_rep_fail(
 	cell_id_t     cell_id,
 	mod_id_t      mod_id);
 
+/* Size of the message formatted by epf_single_ecap_rep_fail() */
+unsigned int epf_single_ecap_rep_fail_size(void);
+
 /* Format an eNB capabilities reply.
  * Returns the size of the message, or a negative error number.
  */
@@ -95,12 +119,48 @@ int epf_single_ecap_rep(
 	mod_id_t      mod_id,
 	ep_enb_det *  det);
 
-/* Parse an eNB capabilities reply looking for the desired fields */
+/* Size of the message formatted by epf_single_ecap_rep() with the given
+ * details; at most EP_ECAP_CELL_MAX cells are accounted.
+ */
+unsigned int epf_single_ecap_rep_size(ep_enb_det * det);
+
+/* Format an eNB capabilities reply, with an array of cells of any length.
+ * Returns the size of the message, or a negative error number.
+ */
+int epf_single_ecap_rep_l(
+	char *        buf,
+	unsigned int  size,
+	enb_id_t      enb_id,
+	cell_id_t     cell_id,
+	mod_id_t      mod_id,
+	uint32_t      capmask,
+	uint32_t      nof_cells,
+	ep_cell_det * cells);
+
+/* Size of the message formatted by epf_single_ecap_rep_l() with the given
+ * number of cells.
+ */
+unsigned int epf_single_ecap_rep_l_size(uint32_t nof_cells);
+
+/* Parse an eNB capabilities reply looking for the desired fields. Only the
+ * first EP_ECAP_CELL_MAX cells are reported; see ep_capc_ecap() to keep all of
+ * them.
+ */
 int epp_single_ecap_rep(
 	char *        buf,
 	unsigned int  size,
 	ep_enb_det *  det);
 
+/* Parse an eNB capabilities reply with all its cells, allocated from the given
+ * arena.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int epp_single_ecap_rep_a(
+	char *        buf,
+	unsigned int  size,
+	ep_arena *    arena,
+	ep_enb_ldet * det);
+
 /* Format an eNB capabilities request.
  * Returns the size of the message, or a negative error number.
  */
@@ -111,6 +171,9 @@ int epf_single_ecap_req(
 	cell_id_t     cell_id,
 	mod_id_t      mod_id);
 
+/* Size of the message formatted by epf_single_ecap_req() */
+unsigned int epf_single_ecap_req_size(void);
+
 /* Parse an eNB capabilities request for the desired fields */
 int epp_single_ecap_req(char * buf, unsigned int size);
 
@@ -29,6 +29,7 @@
 
 #include "eppri.h"
 #include "eptype.h"
+#include "../epwriter.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -65,7 +66,7 @@ typedef struct __ep_header {
 /* Format a master header with the desired fields.
  * Returns the size of the message, or a negative error number.
  */
-int epf_head(
+EP_INL int epf_head(
 	char *       buf, 
 	unsigned int size,
 	ep_msg_type  type,
@@ -74,10 +75,35 @@ int epf_head(
 	mod_id_t     mod_id,
 	uint16_t     flags);
 
-/* Parse a master header extracting the valuable fields.
+/* Format a master header at the position of the writer; its capacity must
+ * have been checked already.
+ */
+EP_INL void epf_head_w(
+	ep_writer *  w,
+	ep_msg_type  type,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	uint16_t     flags);
+
+/* Parse a master header extracting the valuable fields. This is where a
+ * received message enters the library, and where it is captured (see epcap.h).
+ * Returns EP_SUCCESS, or an error code on failure.
+ */
+EP_INL int epp_head(
+	char *        buf, 
+	unsigned int  size,
+	ep_msg_type * type,
+	enb_id_t *    enb_id,
+	cell_id_t *   cell_id,
+	mod_id_t *    mod_id,
+	uint16_t *    flags);
+
+/* Parse a master header as epp_head() does, without capturing the message;
+ * for messages which already entered the library.
  * Returns EP_SUCCESS, or an error code on failure.
  */
-int epp_head(
+EP_INL int epp_head_peek(
 	char *        buf, 
 	unsigned int  size,
 	ep_msg_type * type,
@@ -87,22 +113,28 @@ int epp_head(
 	uint16_t *    flags);
 
 /* Extracts the type from an Empower message */
-ep_msg_type epp_msg_type(char * buf, unsigned int size);
+EP_INL ep_msg_type epp_msg_type(char * buf, unsigned int size);
 
 /* Parses the direction of this header, either request or reply */
-int         epp_dir(char * buf, unsigned int size);
+EP_INL int         epp_dir(char * buf, unsigned int size);
 
 /* Extracts the sequence number from the message */
-uint32_t    epp_seq(char * buf, unsigned int size);
+EP_INL uint32_t    epp_seq(char * buf, unsigned int size);
 
 /* Extracts the message length in the header. */
-uint16_t    epp_msg_length(char * buf, unsigned int size);
+EP_INL uint16_t    epp_msg_length(char * buf, unsigned int size);
 
 /* Inject a sequence number in the header. */
-int         epf_seq(char * buf, unsigned int size, uint32_t seq);
+EP_INL int         epf_seq(char * buf, unsigned int size, uint32_t seq);
 
 /* Inject the message length in the header. */
-int         epf_msg_length(char * buf, unsigned int size, uint16_t len);
+EP_INL int         epf_msg_length(char * buf, unsigned int size, uint16_t len);
+
+/* Complete the message formatted in the writer, injecting its length in the
+ * header.
+ * Returns the size of the message, or a negative error number.
+ */
+EP_INL int         epf_msg_end_w(ep_writer * w);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,285 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Definitions of the master header accessors. They are built into the library
+ * and, if EP_INLINE is defined before including the protocols headers, also
+ * inlined in the module including them; see eppri.h.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_HDR_INL_H
+#define __EMAGE_PROTOCOLS_HDR_INL_H
+
+#include <endian.h>
+#include <arpa/inet.h>
+
+/* Trace points of the module, whatever module includes them */
+#pragma push_macro("EP_TRC_CAT")
+#undef  EP_TRC_CAT
+#define EP_TRC_CAT		EP_TRC_HDR
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+EP_INL int epf_head(
+	char *       buf,
+	unsigned int size,
+	ep_msg_type  type,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	uint16_t     flags)
+{
+	ep_writer w;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - HDR: Invalid buffer!\n");
+		return -1;
+	}
+
+	if(size < sizeof(ep_hdr)) {
+		ep_dbg_log(EP_DBG_0"F - HDR: Not enough space!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+	epf_head_w(&w, type, enb_id, cell_id, mod_id, flags);
+
+	return sizeof(ep_hdr);
+}
+
+EP_INL void epf_head_w(
+	ep_writer *  w,
+	ep_msg_type  type,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	uint16_t     flags)
+{
+	ep_hdr * h = (ep_hdr *)ep_w_put(w, sizeof(ep_hdr));
+
+	h->type       = (uint8_t)type;
+	h->vers       = (uint8_t)EMPOWER_PROTOCOL_VERS;
+	h->id.enb_id  = htobe64(enb_id);
+	h->id.cell_id = htons(cell_id);
+	h->id.mod_id  = htonl(mod_id);
+	h->flags      = flags;
+
+	ep_trc_enb_cur(enb_id);
+	ep_dbg_dump(EP_DBG_0"F - HDR:  ", (char *)h, sizeof(ep_hdr));
+}
+
+EP_INL int epp_head_peek(
+	char *        buf, 
+	unsigned int  size,
+	ep_msg_type * type,
+	enb_id_t *    enb_id,
+	cell_id_t *   cell_id,
+	mod_id_t *    mod_id,
+	uint16_t *    flags)
+{
+	ep_hdr * h = (ep_hdr *)buf;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"P - HDR: Invalid buffer!\n");
+		return -1;
+	}
+
+	if(size < sizeof(ep_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - HDR: Not enough space!\n");
+		return -1;
+	}
+
+	if(h->vers != EMPOWER_PROTOCOL_VERS) {
+		ep_dbg_log(EP_DBG_0"P - HDR: Different protocol version!\n");
+		return EP_WRONG_VERSION;
+	}
+
+	ep_trc_enb_cur(be64toh(h->id.enb_id));
+
+	if(type) {
+		*type    = h->type;
+	}
+
+	if(enb_id) {
+		*enb_id  = be64toh(h->id.enb_id);
+	}
+
+	if(cell_id) {
+		*cell_id = ntohs(h->id.cell_id);
+	}
+
+	if(mod_id) {
+		*mod_id  = ntohl(h->id.mod_id);
+	}
+
+	if(flags) {
+		*flags   = h->flags;
+	}
+
+	ep_dbg_dump("P - HDR:  ", buf, sizeof(ep_hdr));
+
+	return EP_SUCCESS;
+}
+
+EP_INL int epp_head(
+	char *        buf, 
+	unsigned int  size,
+	ep_msg_type * type,
+	enb_id_t *    enb_id,
+	cell_id_t *   cell_id,
+	mod_id_t *    mod_id,
+	uint16_t *    flags)
+{
+	int r = epp_head_peek(buf, size, type, enb_id, cell_id, mod_id, flags);
+
+	if(r == EP_SUCCESS) {
+		ep_cap_hook(buf, size, EP_CAP_IN);
+	}
+
+	return r;
+}
+
+EP_INL ep_msg_type epp_msg_type(char * buf, unsigned int size)
+{
+	ep_hdr * h = (ep_hdr *)buf;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - HDR: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(size < sizeof(ep_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - HDR type: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	return (ep_msg_type)h->type;
+}
+
+EP_INL int epp_dir(char * buf, unsigned int size)
+{
+	ep_hdr * h = (ep_hdr *)buf;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - HDR: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(size < sizeof(ep_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - HDR type: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	/* Return straigth the direction from the right flag position */
+	return (h->flags & EP_HDR_FLAG_DIR);
+}
+
+EP_INL uint32_t epp_seq(char * buf, unsigned int size)
+{
+	ep_hdr * h = (ep_hdr *)buf;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - HDR: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(size < sizeof(ep_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - HDR seq: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	return ntohl(h->seq);
+}
+
+EP_INL uint16_t epp_msg_length(char * buf, unsigned int size)
+{
+	ep_hdr * h = (ep_hdr *)buf;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - HDR: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(size < sizeof(ep_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - HDR len: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	return ntohs(h->length);
+}
+
+EP_INL int epf_seq(char * buf, unsigned int size, uint32_t seq)
+{
+	ep_hdr * h = (ep_hdr *)buf;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - HDR: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(size < sizeof(ep_hdr)) {
+		ep_dbg_log(EP_DBG_0"F - HDR seq: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	h->seq = htonl(seq);
+
+	ep_cap_hook_seq(buf, seq);
+
+	return EP_SUCCESS;
+}
+
+EP_INL int epf_msg_length(char * buf, unsigned int size, uint16_t len)
+{
+	ep_hdr * h = (ep_hdr *)buf;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - HDR: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(size < sizeof(ep_hdr)) {
+		ep_dbg_log(EP_DBG_0"F - HDR len: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	h->length = htons(len);
+
+	ep_cap_hook(buf, size, EP_CAP_OUT);
+
+	return EP_SUCCESS;
+}
+
+EP_INL int epf_msg_end_w(ep_writer * w)
+{
+	ep_hdr * h = (ep_hdr *)w->buf;
+
+	if(w->err) {
+		return -1;
+	}
+
+	h->length = htons(w->pos);
+
+	ep_cap_hook(w->buf, w->size, EP_CAP_OUT);
+
+	return w->pos;
+}
+
+#pragma pop_macro("EP_TRC_CAT")
+
+#endif /* __EMAGE_PROTOCOLS_HDR_INL_H */
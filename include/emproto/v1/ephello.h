@@ -26,6 +26,7 @@
 #include <stdint.h>
 
 #include "eppri.h"
+#include "epTLV.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -42,8 +43,23 @@ typedef struct __ep_hello_reply {
 
 typedef struct __ep_hello_request {
 	uint32_t id;
+	/* Optional TLV tokens are appended here */
 }__attribute__((packed)) ep_hello_req;
 
+/* Fingerprint of the agent capabilities, see ep_ecap_fingerprint() */
+typedef struct __ep_hello_capabilities_hash {
+	uint64_t hash;
+}__attribute__((packed)) ep_hello_chash;
+
+/* Fingerprint of the agent capabilities in TLV style */
+typedef struct __ep_hello_capabilities_hash_TLV {
+	ep_TLV         header;
+	ep_hello_chash body;
+}__attribute__((packed)) ep_hello_chash_TLV;
+
+/* Value of a missing capabilities fingerprint */
+#define EP_HELLO_NO_HASH	0
+
 /******************************************************************************
  * Operation on single-event messages                                         *
  ******************************************************************************/
@@ -59,11 +75,40 @@ int epf_single_hello_req(
 	mod_id_t      mod_id,
 	uint32_t      id);
 
+/* Size of the message formatted by epf_single_hello_req() */
+unsigned int epf_single_hello_req_size(void);
+
 /* Parse an Hello request message */
 int epp_single_hello_req(
 	char *     buf, unsigned int size,
 	uint32_t * id);
 
+/* Format an Hello request message carrying the fingerprint of the agent
+ * capabilities; EP_HELLO_NO_HASH omits it.
+ * Returns the size of the message, or a negative error number.
+ */
+int epf_single_hello_req_fp(
+	char *        buf,
+	unsigned int  size,
+	enb_id_t      enb_id,
+	cell_id_t     cell_id,
+	mod_id_t      mod_id,
+	uint32_t      id,
+	uint64_t      hash);
+
+/* Size of the message formatted by epf_single_hello_req_fp() with the given
+ * fingerprint; the fingerprint TLV is there only if it is not EP_HELLO_NO_HASH.
+ */
+unsigned int epf_single_hello_req_fp_size(uint64_t hash);
+
+/* Parse an Hello request message, with its optional capabilities fingerprint.
+ * If not present, the fingerprint is set to EP_HELLO_NO_HASH.
+ */
+int epp_single_hello_req_fp(
+	char *     buf, unsigned int size,
+	uint32_t * id,
+	uint64_t * hash);
+
 /* Format an Hello reply message with the desired fields.
  * Returns the size of the message, or a negative error number.
  */
@@ -75,6 +120,9 @@ int epf_single_hello_rep(
 	mod_id_t     mod_id,
 	uint32_t    id);
 
+/* Size of the message formatted by epf_single_hello_rep() */
+unsigned int epf_single_hello_rep_size(void);
+
 /* Parse an Hello reply message */
 int epp_single_hello_rep(
 	char *     buf, unsigned int size,
@@ -96,11 +144,41 @@ int epf_sched_hello_req(
 	uint32_t     interval,
 	uint32_t     id);
 
+/* Size of the message formatted by epf_sched_hello_req() */
+unsigned int epf_sched_hello_req_size(void);
+
 /* Parse an Hello request message */
 int epp_sched_hello_req(
 	char * buf, unsigned int size,
 	uint32_t * id);
 
+/* Format an Hello request message carrying the fingerprint of the agent
+ * capabilities; EP_HELLO_NO_HASH omits it.
+ * Returns the size of the message, or a negative error number.
+ */
+int epf_sched_hello_req_fp(
+	char *       buf,
+	unsigned int size,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	uint32_t     interval,
+	uint32_t     id,
+	uint64_t     hash);
+
+/* Size of the message formatted by epf_sched_hello_req_fp(), as for
+ * epf_single_hello_req_fp_size().
+ */
+unsigned int epf_sched_hello_req_fp_size(uint64_t hash);
+
+/* Parse an Hello request message, with its optional capabilities fingerprint.
+ * If not present, the fingerprint is set to EP_HELLO_NO_HASH.
+ */
+int epp_sched_hello_req_fp(
+	char *     buf, unsigned int size,
+	uint32_t * id,
+	uint64_t * hash);
+
 /* Format an Hello reply message with the desired fields.
  * Returns the size of the message, or a negative error number.
  */
@@ -113,6 +191,9 @@ int epf_sched_hello_rep(
 	uint32_t     interval,
 	uint32_t     id);
 
+/* Size of the message formatted by epf_sched_hello_rep() */
+unsigned int epf_sched_hello_rep_size(void);
+
 /* Parse an Hello reply message */
 int epp_sched_hello_rep(
 	char *       buf, 
@@ -26,6 +26,7 @@
 #include <stdint.h>
 
 #include "eppri.h"
+#include "epop.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -51,6 +52,54 @@ typedef struct __ep_handover_reply {
 	uint16_t target_rnti; /* Target RNTI   */
 }__attribute__((packed)) ep_ho_rep;
 
+/* Structure of ep_hob_req:
+ *      At the end of the batch handover request there will be listed the
+ *      single handovers to perform, in the same format of ep_ho_req.
+ *
+ *      || nof_ho | HO0 | HO1 | ..... | HO[nof_ho - 1] ||
+ */
+typedef struct __ep_handover_batch_request {
+	uint16_t nof_ho;     /* Number of handovers listed */
+	/* Multiple ep_ho_req listed here at the end */
+}__attribute__((packed)) ep_hob_req;
+
+/* Outcome of a single handover of a batch */
+typedef struct __ep_handover_batch_result {
+	uint16_t rnti;        /* Original RNTI */
+	uint16_t target_rnti; /* Target RNTI   */
+	uint8_t  result;      /* Result of the operation, see epop.h */
+}__attribute__((packed)) ep_hob_res;
+
+/* Structure of ep_hob_rep:
+ *      At the end of the batch handover reply there will be listed the
+ *      outcome of each handover requested.
+ *
+ *      || origin | nof_ho | RES0 | RES1 | ..... | RES[nof_ho - 1] ||
+ */
+typedef struct __ep_handover_batch_reply {
+	enb_id_t origin_eNB;  /* Original eNB */
+	uint16_t origin_pci;  /* Original PCI */
+	uint16_t nof_ho;      /* Number of outcomes listed */
+	/* Multiple ep_hob_res listed here at the end */
+}__attribute__((packed)) ep_hob_rep;
+
+/******************************************************************************
+ * Opaque structures                                                          *
+ ******************************************************************************/
+
+typedef struct __ep_handover_details {
+	uint16_t   rnti;       /* RNTI of the UE in the source cell */
+	enb_id_t   target_eNB; /* Target eNB id */
+	uint16_t   target_pci; /* Target physical cell id */
+	uint8_t    cause;      /* Cause of the hand-over */
+} ep_ho_det;
+
+typedef struct __ep_handover_outcome {
+	uint16_t   rnti;        /* Original RNTI */
+	uint16_t   target_rnti; /* Target RNTI */
+	ep_op_type result;      /* Success, failure or not supported */
+} ep_ho_out;
+
 /******************************************************************************
  * Operation on single-event messages                                         *
  ******************************************************************************/
@@ -69,6 +118,9 @@ int epf_single_ho_rep_fail(
 	uint16_t     origin_rnti,
 	uint16_t     target_rnti);
 
+/* Size of the message formatted by epf_single_ho_rep_fail() */
+unsigned int epf_single_ho_rep_fail_size(void);
+
 /* Format an handover "not-supported" reply.
  * Returns the size of the message, or a negative error number.
  */
@@ -83,6 +135,9 @@ int epf_single_ho_rep_ns(
 	uint16_t     origin_rnti,
 	uint16_t     target_rnti);
 
+/* Size of the message formatted by epf_single_ho_rep_ns() */
+unsigned int epf_single_ho_rep_ns_size(void);
+
 /* Format an handover positive reply.
  * Returns the size of the message, or a negative error number.
  */
@@ -97,6 +152,9 @@ int epf_single_ho_rep(
 	uint16_t     origin_rnti,
 	uint16_t     target_rnti);
 
+/* Size of the message formatted by epf_single_ho_rep() */
+unsigned int epf_single_ho_rep_size(void);
+
 /* Parse an handover reply looking for the desired fields */
 int epp_single_ho_rep(
 	char *       buf,
@@ -120,6 +178,9 @@ int epf_single_ho_req(
 	uint16_t     pci,
 	uint8_t      cause);
 
+/* Size of the message formatted by epf_single_ho_req() */
+unsigned int epf_single_ho_req_size(void);
+
 /* Parse an handover request looking for the desired fields */
 int epp_single_ho_req(
 	char *       buf,
@@ -129,6 +190,78 @@ int epp_single_ho_req(
 	uint16_t *   pci,
 	uint8_t *    cause);
 
+/* Format a batch handover request, moving 'nof_ho' UEs at once.
+ * Returns the size of the message, or a negative error number.
+ */
+int epf_single_ho_batch_req(
+	char *       buf,
+	unsigned int size,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	uint16_t     nof_ho,
+	ep_ho_det *  hos);
+
+/* Size of the message formatted by epf_single_ho_batch_req() with the given
+ * number of handovers.
+ */
+unsigned int epf_single_ho_batch_req_size(uint16_t nof_ho);
+
+/* Parse a batch handover request. 'nof_ho' is set to the number of handovers
+ * listed in the message, while only up to 'max' of them are stored in 'hos'.
+ */
+int epp_single_ho_batch_req(
+	char *       buf,
+	unsigned int size,
+	uint16_t *   nof_ho,
+	uint16_t     max,
+	ep_ho_det *  hos);
+
+/* Format a batch handover reply, with the outcome of each handover.
+ * Returns the size of the message, or a negative error number.
+ */
+int epf_single_ho_batch_rep(
+	char *       buf,
+	unsigned int size,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	enb_id_t     origin_eNB,
+	uint16_t     origin_pci,
+	uint16_t     nof_ho,
+	ep_ho_out *  outs);
+
+/* Size of the message formatted by epf_single_ho_batch_rep() with the given
+ * number of outcomes.
+ */
+unsigned int epf_single_ho_batch_rep_size(uint16_t nof_ho);
+
+/* Format a batch handover "not-supported" reply; the controller should fall
+ * back to single handover requests.
+ * Returns the size of the message, or a negative error number.
+ */
+int epf_single_ho_batch_rep_ns(
+	char *       buf,
+	unsigned int size,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id);
+
+/* Size of the message formatted by epf_single_ho_batch_rep_ns() */
+unsigned int epf_single_ho_batch_rep_ns_size(void);
+
+/* Parse a batch handover reply. 'nof_ho' is set to the number of outcomes
+ * listed in the message, while only up to 'max' of them are stored in 'outs'.
+ */
+int epp_single_ho_batch_rep(
+	char *       buf,
+	unsigned int size,
+	enb_id_t *   origin_eNB,
+	uint16_t *   origin_pci,
+	uint16_t *   nof_ho,
+	uint16_t     max,
+	ep_ho_out *  outs);
+
 /******************************************************************************
  * Operation on schedule-event messages                                       *
  ******************************************************************************/
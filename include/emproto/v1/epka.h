@@ -0,0 +1,111 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*    KEEP ALIVE TRACKER
+ *
+ * Controller-side tracking of the Hello messages sent by the agents. An agent
+ * is considered down if no Hello is received for the keep alive period (see
+ * lifecycle.txt).
+ *
+ * Every agent owns a timer in a timer wheel which is re-armed at each Hello,
+ * so checking for expired agents costs only the number of agents which
+ * actually expired, and not a scan of all the known ones.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_KEEPALIVE_H
+#define __EMAGE_PROTOCOLS_KEEPALIVE_H
+
+#include <stdint.h>
+
+#include "eppri.h"
+#include "../ephash.h"
+#include "../eptimer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* Default keep alive period, in ms */
+#define EP_KA_PERIOD_DEFAULT	2000
+
+/* Callback invoked when an agent is considered down */
+typedef void (* ep_ka_cb)(enb_id_t enb_id, void * arg);
+
+typedef struct __ep_keepalive_agent {
+	ep_tw_timer timer;    /* Must be the first element */
+	enb_id_t    enb_id;   /* Agent being tracked */
+	uint64_t    last;     /* Time of the last Hello, in ms */
+	uint32_t    next;     /* Next free element, if not in use */
+} ep_ka_agent;
+
+typedef struct __ep_keepalive {
+	ep_tw         wheel;  /* Deadlines of the agents */
+	ep_hmap       map;    /* eNB id --> index of the agent + 1 */
+	ep_ka_agent * agents; /* Agents storage */
+	uint32_t      max;    /* Maximum number of agents */
+	uint32_t      free;   /* First free element + 1 */
+	uint32_t      period; /* Keep alive period, in ms */
+	uint32_t      nof_expired;
+	ep_ka_cb      cb;     /* Invoked when an agent is down */
+	void *        arg;    /* Argument of the callback */
+} ep_ka;
+
+/* Initialize a tracker for up to 'max' agents. A period of 0 selects the
+ * default keep alive period. Time is given in ms, see ep_tw_now().
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_ka_init(
+	ep_ka *      ka,
+	uint32_t     max,
+	uint32_t     period,
+	uint64_t     now,
+	ep_ka_cb     cb,
+	void *       arg);
+
+/* Release the resources of the tracker */
+void ep_ka_release(ep_ka * ka);
+
+/* Account an Hello request received from an agent, either single-event or
+ * schedule-event one, starting to track the agent if not known.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_ka_hello(ep_ka * ka, char * buf, unsigned int size, uint64_t now);
+
+/* Mark an agent as alive at the given time, starting to track it if not known.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_ka_touch(ep_ka * ka, enb_id_t enb_id, uint64_t now);
+
+/* Stop tracking an agent.
+ * Returns EP_SUCCESS, or a negative error code if the agent is not known.
+ */
+int  ep_ka_remove(ep_ka * ka, enb_id_t enb_id);
+
+/* Returns 1 if the agent is tracked and alive, 0 otherwise */
+int  ep_ka_alive(ep_ka * ka, enb_id_t enb_id);
+
+/* Report, through the callback, all the agents whose keep alive period expired
+ * up to the given time. Such agents are no more tracked.
+ * Returns the number of expired agents.
+ */
+int  ep_ka_check(ep_ka * ka, uint64_t now);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_KEEPALIVE_H */
@@ -46,6 +46,13 @@ typedef struct __ep_cell_mac_report_request {
 	uint16_t interval;
 }__attribute__((packed)) ep_macrep_req;
 
+/* Reply sent in place of a full report when nothing changed since the report
+ * sent with the given sequence number.
+ */
+typedef struct __ep_cell_mac_report_unchanged {
+	uint32_t seq;        /* Sequence number of the last full report */
+}__attribute__((packed)) ep_macrep_unch;
+
 /******************************************************************************
  * Opaque structures                                                          *
  ******************************************************************************/
@@ -57,6 +64,30 @@ typedef struct ep_cell_mac_report_details {
 	uint32_t UL_prbs_used;
 } ep_macrep_det;
 
+/* Suppression modes for periodic MAC reports */
+typedef enum __ep_cell_mac_report_suppression_mode {
+	/* Always send the full report */
+	EP_MACREP_SUP_OFF    = 0,
+	/* Do not send anything if the report did not change */
+	EP_MACREP_SUP_SKIP   = 1,
+	/* Send an 'unchanged' marker if the report did not change */
+	EP_MACREP_SUP_MARKER = 2,
+} ep_macrep_sup_mode;
+
+/* Agent-side state of the MAC report suppression.
+ *
+ * A report is considered unchanged if the total PRBs are the same of the last
+ * full report sent, and the used PRBs counters moved less or equal than the
+ * given tolerance.
+ */
+typedef struct __ep_cell_mac_report_suppression {
+	ep_macrep_sup_mode mode;
+	uint32_t           tolerance; /* Tolerance on the PRBs used counters */
+	uint32_t           valid;     /* Is 'last' holding a sent report? */
+	uint32_t           last_seq;  /* Sequence number of 'last' */
+	ep_macrep_det      last;      /* Last full report sent */
+} ep_macrep_sup;
+
 /******************************************************************************
  * Operation on single-event messages                                         *
  ******************************************************************************/
@@ -79,6 +110,9 @@ int epf_trigger_macrep_rep_fail(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id);
 
+/* Size of the message formatted by epf_trigger_macrep_rep_fail() */
+unsigned int epf_trigger_macrep_rep_fail_size(void);
+
 /* Format a MAC report not-supported reply.
  * Returns the size of the message, or a negative error number.
  */
@@ -89,6 +123,9 @@ int epf_trigger_macrep_rep_ns(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id);
 
+/* Size of the message formatted by epf_trigger_macrep_rep_ns() */
+unsigned int epf_trigger_macrep_rep_ns_size(void);
+
 /* Format a MAC report reply.
  * Returns the size of the message, or a negative error number.
  */
@@ -100,12 +137,60 @@ int epf_trigger_macrep_rep(
 	mod_id_t        mod_id,
 	ep_macrep_det * det);
 
+/* Size of the message formatted by epf_trigger_macrep_rep() */
+unsigned int epf_trigger_macrep_rep_size(void);
+
 /* Parse a MAC report reply looking for the desired fields */
 int epp_trigger_macrep_rep(
 	char *          buf,
 	unsigned int    size,
 	ep_macrep_det * det);
 
+/* Initialize, or reset, the MAC report suppression state. The next report
+ * formatted with it will always be a full one.
+ */
+void ep_macrep_sup_init(
+	ep_macrep_sup *    sup,
+	ep_macrep_sup_mode mode,
+	uint32_t           tolerance);
+
+/* Format a MAC report reply, suppressing it if it did not change since the
+ * last full report formatted with the same suppression state.
+ *
+ * The given sequence number is injected in the formatted message. Depending on
+ * the suppression mode, an unchanged report results in no message at all or in
+ * an 'unchanged' marker referring to the sequence number of the last full
+ * report.
+ *
+ * Returns the size of the message, 0 if the message has to be skipped, or a
+ * negative error number.
+ */
+int epf_trigger_macrep_rep_sup(
+	char *          buf,
+	unsigned int    size,
+	enb_id_t        enb_id,
+	cell_id_t       cell_id,
+	mod_id_t        mod_id,
+	uint32_t        seq,
+	ep_macrep_sup * sup,
+	ep_macrep_det * det);
+
+/* Size of the message that epf_trigger_macrep_rep_sup() would format with the
+ * current suppression state, which is left untouched: either a full report, an
+ * 'unchanged' marker, or 0 if the report would be skipped.
+ */
+unsigned int epf_trigger_macrep_rep_sup_size(
+	ep_macrep_sup * sup,
+	ep_macrep_det * det);
+
+/* Parse a MAC report 'unchanged' marker, a reply whose trigger operation is
+ * EP_OPERATION_UNCHANGED, looking for the desired fields.
+ */
+int epp_trigger_macrep_unch(
+	char *          buf,
+	unsigned int    size,
+	uint32_t *      seq);
+
 /* Format a MAC report request.
  * Returns the size of the message, or a negative error number.
  */
@@ -118,6 +203,9 @@ int epf_trigger_macrep_req(
 	/* Interval for statistic measurements, in 'ms' */
 	uint16_t        interval);
 
+/* Size of the message formatted by epf_trigger_macrep_req() */
+unsigned int epf_trigger_macrep_req_size(void);
+
 /* Parse a MAC report request looking for the desired fields */
 int epp_trigger_macrep_req(
 	char *          buf,
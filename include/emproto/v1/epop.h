@@ -33,6 +33,7 @@ typedef enum __ep_operation_type {
 	EP_OPERATION_UNSET         = 7, /* Unset something           */
 	EP_OPERATION_START         = 8, /* Start something           */
 	EP_OPERATION_STOP          = 9, /* Stop something            */
+	EP_OPERATION_UNCHANGED     =10, /* Nothing changed           */
 } ep_op_type;
 
 #ifdef __cplusplus
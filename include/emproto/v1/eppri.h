@@ -48,6 +48,18 @@ typedef uint64_t slice_id_t;    /* Definition of the slice id */
 typedef uint16_t tlv_type_t;    /* Definition of TLV type field */
 typedef uint16_t tlv_length_t;  /* Definition of TLV length field */
 
+/*
+ * Linkage of the header and TLV accessors (see ephdr_inl.h and the others):
+ * define EP_INLINE before including the protocols headers to have them
+ * inlined in the module, instead of called from the library. C only.
+ */
+
+#ifdef EP_INLINE
+#define EP_INL                  static inline
+#else
+#define EP_INL
+#endif /* EP_INLINE */
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
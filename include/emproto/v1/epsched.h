@@ -25,7 +25,9 @@
 
 #include <stdint.h>
 
+#include "eppri.h"
 #include "epop.h"
+#include "../epwriter.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -44,18 +46,30 @@ typedef struct __ep_schedule_header {
 	uint32_t         interval; /* Interval of time in ms */
 }__attribute__((packed)) ep_c_hdr;
 
+/* Size of the headers of a schedule-event message */
+#define EP_SCHED_HDR_SIZE      (EP_HEADER_SIZE + sizeof(ep_c_hdr))
+
 /* Format a schedule-event message */
-int epf_schedule(
+EP_INL int epf_schedule(
 	char * buf, unsigned int size,
 	ep_act_type type,
 	ep_op_type  op,
 	uint32_t    interval);
 
+/* Format a schedule-event header at the position of the writer; its capacity
+ * must have been checked already.
+ */
+EP_INL void epf_schedule_w(
+	ep_writer * w,
+	ep_act_type type,
+	ep_op_type  op,
+	uint32_t    interval);
+
 /* Extracts the interval on an Empower schedule message */
-uint32_t    epp_sched_interval(char * buf, unsigned int size);
+EP_INL uint32_t    epp_sched_interval(char * buf, unsigned int size);
 
 /* Extracts the schedule type from an Empower message */
-ep_act_type epp_schedule_type(char * buf, unsigned int size);
+EP_INL ep_act_type epp_schedule_type(char * buf, unsigned int size);
 
 #ifdef __cplusplus
 }
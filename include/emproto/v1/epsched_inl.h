@@ -0,0 +1,104 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Definitions of the schedule-event header accessors. They are built into the
+ * library and, if EP_INLINE is defined before including the protocols headers,
+ * also inlined in the module including them; see eppri.h.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_SCHED_INL_H
+#define __EMAGE_PROTOCOLS_SCHED_INL_H
+
+#include <endian.h>
+#include <arpa/inet.h>
+
+/* Trace points of the module, whatever module includes them */
+#pragma push_macro("EP_TRC_CAT")
+#undef  EP_TRC_CAT
+#define EP_TRC_CAT		EP_TRC_HDR
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+EP_INL int epf_schedule(
+	char *       buf,
+	unsigned int size,
+	ep_act_type  type,
+	ep_op_type   op,
+	uint32_t     interval)
+{
+	ep_writer w;
+
+	if(size < sizeof(ep_c_hdr)) {
+		ep_dbg_log(EP_DBG_1"F - SCHED: Not enough space!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+	epf_schedule_w(&w, type, op, interval);
+
+	return sizeof(ep_c_hdr);
+}
+
+EP_INL void epf_schedule_w(
+	ep_writer * w,
+	ep_act_type type,
+	ep_op_type  op,
+	uint32_t    interval)
+{
+	ep_c_hdr * h = (ep_c_hdr *)ep_w_put(w, sizeof(ep_c_hdr));
+
+	h->type     = htons(type);
+	h->op       = (uint8_t)op;
+	h->interval = htonl(interval);
+
+	ep_dbg_dump(EP_DBG_1"F - SCHE: ", (char *)h, sizeof(ep_c_hdr));
+}
+
+EP_INL uint32_t epp_sched_interval(char * buf, unsigned int size)
+{
+	ep_c_hdr * h = (ep_c_hdr *)(buf + sizeof(ep_hdr));
+
+	if(size < sizeof(ep_hdr) + sizeof(ep_c_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - SCHED Int: Not enough space!\n");
+		return 0;
+	}
+
+	return ntohl(h->interval);
+}
+
+EP_INL ep_act_type epp_schedule_type(char * buf, unsigned int size)
+{
+	ep_c_hdr * h = (ep_c_hdr *)(buf + sizeof(ep_hdr));
+
+	if(size < sizeof(ep_hdr) + sizeof(ep_c_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - SCHED Type: Not enough space!\n");
+		return EP_ACT_INVALID;
+	}
+
+	ep_dbg_dump(
+		EP_DBG_1"P - SCHE: ", 
+		buf + sizeof(ep_hdr), 
+		sizeof(ep_c_hdr));
+
+	return ntohs(h->type);
+}
+
+#pragma pop_macro("EP_TRC_CAT")
+
+#endif /* __EMAGE_PROTOCOLS_SCHED_INL_H */
@@ -26,7 +26,9 @@
 
 #include <stdint.h>
 
+#include "eppri.h"
 #include "epop.h"
+#include "../epwriter.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -44,18 +46,26 @@ typedef struct __ep_single_header {
 	uint8_t       op;    /* Operation type, see epop.h */
 }__attribute__((packed)) ep_s_hdr;
 
+/* Size of the headers of a single-event message */
+#define EP_SINGLE_HDR_SIZE     (EP_HEADER_SIZE + sizeof(ep_s_hdr))
+
 /* Format a single-event message */
-int epf_single(
+EP_INL int epf_single(
 	char *       buf, 
 	unsigned int size,
 	ep_act_type  type,
 	ep_op_type   op);
 
+/* Format a single-event header at the position of the writer; its capacity
+ * must have been checked already.
+ */
+EP_INL void epf_single_w(ep_writer * w, ep_act_type type, ep_op_type op);
+
 /* Extracts the type from an Empower single message */
-ep_act_type epp_single_type(char * buf, unsigned int size);
+EP_INL ep_act_type epp_single_type(char * buf, unsigned int size);
 
 /* Extracts the operation from an Empower single message */
-ep_op_type epp_single_op(char * buf, unsigned int size);
+EP_INL ep_op_type epp_single_op(char * buf, unsigned int size);
 
 #ifdef __cplusplus
 }
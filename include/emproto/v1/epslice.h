@@ -0,0 +1,175 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*    RAN SLICE TABLE
+ *
+ * Table of the RAN slices of a cell, keyed by slice id, which holds for each
+ * slice its resources, its user scheduler and its users.
+ *
+ * RAN Slice messages (add, set, remove and reply) are applied in place by
+ * walking their TLVs, so only the fields carried by the message are touched,
+ * and the caller is told which ones actually changed. This way a burst of
+ * slice reconfigurations costs only what changed, and not a rebuild of the
+ * whole slice map of the cell.
+ *
+ * Optionally, the table can also map the RBGs of each slice on the RBGs of the
+ * cell, so that every slice owns a bitmap of the RBGs it can schedule in a TTI.
+ * Requests which ask more RBGs than the cell has are then refused before being
+ * applied.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_SLICE_TABLE_H
+#define __EMAGE_PROTOCOLS_SLICE_TABLE_H
+
+#include <stdint.h>
+
+#include "eppri.h"
+#include "epRAN.h"
+#include "../ephash.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* Bitmask of the changes reported when applying a message */
+#define EP_RAN_STAB_ADDED	0x01 /* The slice has been created */
+#define EP_RAN_STAB_REMOVED	0x02 /* The slice has been removed */
+#define EP_RAN_STAB_RBGS	0x04 /* Resources of the slice changed */
+#define EP_RAN_STAB_USCHED	0x08 /* User scheduler of the slice changed */
+#define EP_RAN_STAB_USERS	0x10 /* Users of the slice changed */
+
+/* Maximum number of RBGs of a cell which can be mapped */
+#define EP_RAN_RBG_MAX		128
+/* Number of 64-bits words of an RBG bitmap */
+#define EP_RAN_RBG_WORDS	(EP_RAN_RBG_MAX / 64)
+
+typedef struct __ep_ran_slice_table_entry {
+	slice_id_t  id;        /* ID of the slice */
+	uint8_t     used;      /* Is the entry in use? */
+	sched_id_t  usched;    /* User scheduler ID */
+	uint16_t    rbgs;      /* RBGs assigned to the slice */
+	uint32_t    nof_users; /* Number of users of the slice */
+	uint32_t    max_users; /* Space available in 'users' */
+	rnti_id_t * users;     /* Users of the slice */
+	uint32_t    next;      /* Next free entry, if not in use */
+	/* RBGs of the cell assigned to the slice */
+	uint64_t    rbg[EP_RAN_RBG_WORDS];
+} ep_ran_stab_ent;
+
+typedef struct __ep_ran_slice_table {
+	ep_hmap           map;  /* Slice id --> index of the entry + 1 */
+	ep_ran_stab_ent * ents; /* Entries storage */
+	uint32_t          max;  /* Maximum number of slices */
+	uint32_t          nof;  /* Number of slices in the table */
+	uint32_t          free; /* First free entry + 1 */
+	uint16_t          nof_rbgs; /* RBGs of the cell; 0 if not mapped */
+	uint64_t          rbg_free[EP_RAN_RBG_WORDS];
+} ep_ran_stab;
+
+/* Initialize a table for up to 'max' slices.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_ran_stab_init(ep_ran_stab * t, uint32_t max);
+
+/* Release the resources of the table */
+void ep_ran_stab_release(ep_ran_stab * t);
+
+/* Look for a slice in the table.
+ * Returns the slice, or NULL if not present.
+ */
+ep_ran_stab_ent * ep_ran_stab_find(ep_ran_stab * t, slice_id_t id);
+
+/* Iterate over the slices of the table; start with 'prev' set to NULL.
+ * Returns the next slice, or NULL at the end of the table.
+ */
+ep_ran_stab_ent * ep_ran_stab_next(ep_ran_stab * t, ep_ran_stab_ent * prev);
+
+/* Add a slice with the given details, or set them if the slice exists.
+ * Returns the mask of the changes, or a negative error code.
+ */
+int  ep_ran_stab_set(ep_ran_stab * t, slice_id_t id, ep_ran_slice_det * det);
+
+/* Add a slice with the given details, or set them if the slice exists. The
+ * slice can hold any number of users.
+ * Returns the mask of the changes, or a negative error code.
+ */
+int  ep_ran_stab_set_l(
+	ep_ran_stab *       t,
+	slice_id_t          id,
+	ep_ran_slice_ldet * det);
+
+/* Remove a slice from the table.
+ * Returns EP_SUCCESS, or a negative error code if the slice is not present.
+ */
+int  ep_ran_stab_rem(ep_ran_stab * t, slice_id_t id);
+
+/* Apply a single-event RAN Slice message (add, set, remove request, or reply)
+ * to the table. The id of the slice involved is returned in 'id', if given.
+ * Returns the mask of the changes, or a negative error code.
+ */
+int  ep_ran_stab_apply(
+	ep_ran_stab * t,
+	char *        buf,
+	unsigned int  size,
+	slice_id_t *  id);
+
+/* Apply a RAN Slice bulk request to the table. Operations are applied all or
+ * none: if one of them can't be performed nothing is changed, that operation
+ * is reported as Fail, and all the others as Unchanged. The outcome of the
+ * operations is stored in 'outs', up to 'max' elements, and their number in
+ * 'nof', if given; these can be used to format the bulk reply.
+ * Returns the mask of the changes, or a negative error code.
+ */
+int  ep_ran_stab_apply_bulk(
+	ep_ran_stab *     t,
+	char *            buf,
+	unsigned int      size,
+	uint16_t *        nof,
+	uint16_t          max,
+	ep_ran_sblk_out * outs);
+
+/* Returns the number of RBGs of a cell with the given DL PRBs, following the
+ * RBG size of 3GPP TS 36.213 (type 0 allocation), or 0 if out of range.
+ */
+uint16_t ep_ran_rbg_count(uint16_t prbs);
+
+/* Start mapping the RBGs of the slices on the RBGs of a cell with the given DL
+ * PRBs. From now on the table refuses requests exceeding the cell capacity.
+ * Returns the number of RBGs of the cell, or a negative error code if the
+ * slices already in the table do not fit.
+ */
+int  ep_ran_stab_rbg_init(ep_ran_stab * t, uint16_t prbs);
+
+/* Returns the RBG bitmap of a slice, with EP_RAN_RBG_WORDS words, or NULL if
+ * the slice is not present.
+ */
+uint64_t * ep_ran_stab_rbg_mask(ep_ran_stab * t, slice_id_t id);
+
+/* Returns the number of RBGs of the cell not assigned to any slice */
+int  ep_ran_stab_rbg_free(ep_ran_stab * t);
+
+/* Checks that the RBGs of the slices do not overlap, and that every slice owns
+ * exactly the number of RBGs requested.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int  ep_ran_stab_rbg_check(ep_ran_stab * t);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_SLICE_TABLE_H */
@@ -26,7 +26,9 @@
 
 #include <stdint.h>
 
+#include "eppri.h"
 #include "epop.h"
+#include "../epwriter.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -44,18 +46,26 @@ typedef struct __ep_trigger_header {
 	uint8_t        op;    /* Operation type, see epop.h */
 }__attribute__((packed)) ep_t_hdr;
 
+/* Size of the headers of a trigger-event message */
+#define EP_TRIGGER_HDR_SIZE    (EP_HEADER_SIZE + sizeof(ep_t_hdr))
+
 /* Format a trigger-event message */
-int epf_trigger(
+EP_INL int epf_trigger(
 	char *       buf, 
 	unsigned int size,
 	ep_act_type  type,
 	ep_op_type   op);
 
+/* Format a trigger-event header at the position of the writer; its capacity
+ * must have been checked already.
+ */
+EP_INL void epf_trigger_w(ep_writer * w, ep_act_type type, ep_op_type op);
+
 /* Parse the operation type for a trigger message */
-ep_op_type  epp_trigger_op(char * buf, unsigned int size);
+EP_INL ep_op_type  epp_trigger_op(char * buf, unsigned int size);
 
 /* Extracts the trigger type from an Empower message */
-ep_act_type  epp_trigger_type(char * buf, unsigned int size);
+EP_INL ep_act_type  epp_trigger_type(char * buf, unsigned int size);
 
 #ifdef __cplusplus
 }
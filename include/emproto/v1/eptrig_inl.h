@@ -0,0 +1,97 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Definitions of the trigger-event header accessors. They are built into the
+ * library and, if EP_INLINE is defined before including the protocols headers,
+ * also inlined in the module including them; see eppri.h.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_TRIG_INL_H
+#define __EMAGE_PROTOCOLS_TRIG_INL_H
+
+#include <endian.h>
+#include <arpa/inet.h>
+
+/* Trace points of the module, whatever module includes them */
+#pragma push_macro("EP_TRC_CAT")
+#undef  EP_TRC_CAT
+#define EP_TRC_CAT		EP_TRC_HDR
+
+EP_INL int epf_trigger(
+	char * buf, unsigned int size,
+	ep_act_type type,
+	ep_op_type  op)
+{
+	ep_writer w;
+
+	if(size < sizeof(ep_t_hdr)) {
+		ep_dbg_log(EP_DBG_1"F - TRIG: Not enough space!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+	epf_trigger_w(&w, type, op);
+
+	return sizeof(ep_t_hdr);
+}
+
+EP_INL void epf_trigger_w(ep_writer * w, ep_act_type type, ep_op_type op)
+{
+	ep_t_hdr * h = (ep_t_hdr *)ep_w_put(w, sizeof(ep_t_hdr));
+
+	h->type = htons(type);
+	h->op   = (uint8_t)op;
+
+	ep_dbg_dump(EP_DBG_1"F - TRIG: ", (char *)h, sizeof(ep_t_hdr));
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+EP_INL ep_op_type epp_trigger_op(char * buf, unsigned int size)
+{
+	ep_t_hdr * h = (ep_t_hdr *)(buf + sizeof(ep_hdr));
+
+	if(size < sizeof(ep_hdr) + sizeof(ep_t_hdr)) {
+		ep_dbg_log(EP_DBG_0"F - TRIG Op: Not enough space!\n");
+		return EP_OPERATION_UNSPECIFIED;
+	}
+
+	return (ep_op_type)h->op;
+}
+
+EP_INL ep_act_type epp_trigger_type(char * buf, unsigned int size)
+{
+	ep_t_hdr * h = (ep_t_hdr *)(buf + sizeof(ep_hdr));
+
+	if(size < sizeof(ep_hdr) + sizeof(ep_t_hdr)) {
+		ep_dbg_log(EP_DBG_0"F - TRIG Type: Not enough space!\n");
+		return EP_ACT_INVALID;
+	}
+
+	ep_dbg_dump(
+		EP_DBG_1"P - TRIG: ", 
+		buf + sizeof(ep_hdr), 
+		sizeof(ep_t_hdr));
+
+	return ntohs(h->type);
+}
+
+#pragma pop_macro("EP_TRC_CAT")
+
+#endif /* __EMAGE_PROTOCOLS_TRIG_INL_H */
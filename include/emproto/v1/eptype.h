@@ -55,7 +55,9 @@ typedef enum __ep_action_type {
 	EP_ACT_MAC_REPORT     =  6, /* Report coming from MAC layer */
 	EP_ACT_HANDOVER       =  7, /* Hand an UE over another eNB */
 	EP_ACT_RAN_SETUP      =  9, /* RAN setup operation */
-	EP_ACT_RAN_SLICE      = 10  /* Ran Slice Setup request */
+	EP_ACT_RAN_SLICE      = 10, /* Ran Slice Setup request */
+	EP_ACT_HO_BATCH       = 11, /* Batch of UEs hand overs */
+	EP_ACT_RAN_SLICE_BULK = 12  /* Multiple Ran Slice operations */
 } ep_act_type;
 
 #ifdef __cplusplus
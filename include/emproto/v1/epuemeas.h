@@ -104,6 +104,9 @@ int epf_trigger_uemeas_rep_fail(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id);
 
+/* Size of the message formatted by epf_trigger_uemeas_rep_fail() */
+unsigned int epf_trigger_uemeas_rep_fail_size(void);
+
 /* Format an UE measurement reply.
  * Returns the size of the message, or a negative error number.
  */
@@ -117,6 +120,11 @@ int epf_trigger_uemeas_rep(
 	uint32_t        max,
 	ep_ue_measure * meas);
 
+/* Size of the message formatted by epf_trigger_uemeas_rep() with the given
+ * number of measurements, of which no more than 'max' are listed.
+ */
+unsigned int epf_trigger_uemeas_rep_size(uint32_t nof_meas, uint32_t max);
+
 /* Parse an UE measurement reply looking for the desired fields */
 int epp_trigger_uemeas_rep(
 	char *          buf,
@@ -142,6 +150,9 @@ int epf_trigger_uemeas_req(
 	int16_t      max_cells,
 	int16_t      max_meas);
 
+/* Size of the message formatted by epf_trigger_uemeas_req() */
+unsigned int epf_trigger_uemeas_req_size(void);
+
 /* Parse an UE measurement request for the desired fields */
 int epp_trigger_uemeas_req(
 	char *       buf,
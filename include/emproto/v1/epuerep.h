@@ -26,6 +26,8 @@
 #include <endian.h>
 #include <stdint.h>
 
+#include "../eparena.h"
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -94,6 +96,9 @@ int epf_trigger_uerep_rep_fail(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id);
 
+/* Size of the message formatted by epf_trigger_uerep_rep_fail() */
+unsigned int epf_trigger_uerep_rep_fail_size(void);
+
 /* Format an UE report reply.
  * Returns the size of the message, or a negative error number.
  */
@@ -107,6 +112,11 @@ int epf_trigger_uerep_rep(
 	uint32_t        max_ues,
 	ep_ue_details * ues);
 
+/* Size of the message formatted by epf_trigger_uerep_rep() with the given
+ * number of UEs; no more than 'max_ues' of them are listed.
+ */
+unsigned int epf_trigger_uerep_rep_size(uint32_t nof_ues, uint32_t max_ues);
+
 /* Parse an UE report reply looking for the desired fields */
 int epp_trigger_uerep_rep(
 	char *          buf,
@@ -115,6 +125,16 @@ int epp_trigger_uerep_rep(
 	uint32_t        max_ues,
 	ep_ue_details * ues);
 
+/* Parse an UE report reply with all its UEs, allocated from the given arena.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+int epp_trigger_uerep_rep_a(
+	char *           buf,
+	unsigned int     size,
+	ep_arena *       arena,
+	uint32_t *       nof_ues,
+	ep_ue_details ** ues);
+
 /* Format an UE report request.
  * Returns the size of the message, or a negative error number.
  */
@@ -126,6 +146,9 @@ int epf_trigger_uerep_req(
 	mod_id_t     mod_id,
 	ep_op_type   op);
 
+/* Size of the message formatted by epf_trigger_uerep_req() */
+unsigned int epf_trigger_uerep_req_size(void);
+
 /* Parse an UE report request for the desired fields */
 int epp_trigger_uerep_req(char * buf, unsigned int size);
 
@@ -0,0 +1,355 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*    MESSAGE VIEWS
+ *
+ * A received message is checked as a whole, once, by ep_msg_validate(): the
+ * length in the header against the buffer, the size of the event header and of
+ * the body, the number of entries of the arrays carried and the bounds of the
+ * TLV tokens. The view filled by the validation then allows to read single
+ * fields of the message in place through the accessors below, which swap only
+ * what is read and do no more checks at all.
+ *
+ * Accessors are valid only for the kind of message they belong to, and only
+ * as long as the message buffer is.
+ */
+
+#ifndef __EMAGE_PROTOCOLS_VIEW_H
+#define __EMAGE_PROTOCOLS_VIEW_H
+
+#include <endian.h>
+#include <stdint.h>
+#include <arpa/inet.h>
+
+#include "eppri.h"
+#include "ephdr.h"
+#include "epsched.h"
+#include "epuerep.h"
+#include "epuemeas.h"
+#include "epmacrep.h"
+#include "epho.h"
+#include "epRAN.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* Message checked by ep_msg_validate() */
+typedef struct __ep_message_view {
+	char *       buf;   /* Message, in network order */
+	uint16_t     len;   /* Length of the message, as in its header */
+	uint8_t      type;  /* Type of message, see ep_msg_type */
+	uint16_t     act;   /* Action of the message, see ep_act_type */
+	uint8_t      op;    /* Operation of the message, see ep_op_type */
+	uint8_t      dir;   /* Request or reply, see EP_HDR_FLAG_DIR_* */
+	char *       body;  /* Body of the message, after the event header */
+	uint16_t     blen;  /* Length of the body */
+
+	/* Located by the validation, depending on the action */
+	uint32_t     nof;   /* Entries of the array carried in the body */
+	char *       arr;   /* First entry of the array */
+	char *       res;   /* RAN Slice resources TLV */
+	char *       sch;   /* RAN Slice user scheduler TLV */
+
+	uint8_t      host;  /* Entries decoded in place to host order */
+} ep_msg_view;
+
+/* Check a whole message and fill its view.
+ * Returns EP_SUCCESS, EP_WRONG_VERSION, or EP_ERROR if the message is
+ * malformed.
+ */
+int ep_msg_validate(char * buf, unsigned int size, ep_msg_view * v);
+
+/******************************************************************************
+ * Headers                                                                    *
+ ******************************************************************************/
+
+static inline enb_id_t ep_view_enb_id(ep_msg_view * v)
+{
+	return be64toh(((ep_hdr *)v->buf)->id.enb_id);
+}
+
+static inline cell_id_t ep_view_cell_id(ep_msg_view * v)
+{
+	return ntohs(((ep_hdr *)v->buf)->id.cell_id);
+}
+
+static inline mod_id_t ep_view_mod_id(ep_msg_view * v)
+{
+	return ntohl(((ep_hdr *)v->buf)->id.mod_id);
+}
+
+static inline uint32_t ep_view_seq(ep_msg_view * v)
+{
+	return ntohl(((ep_hdr *)v->buf)->seq);
+}
+
+/* Interval of a schedule-event message */
+static inline uint32_t ep_view_interval(ep_msg_view * v)
+{
+	return ntohl(((ep_c_hdr *)(v->buf + sizeof(ep_hdr)))->interval);
+}
+
+/******************************************************************************
+ * UE report reply                                                            *
+ ******************************************************************************/
+
+/* Number of UEs listed in the message; can be less than ep_uerep_view_total()
+ * only for older senders, which announced more UEs than they listed.
+ */
+static inline uint32_t ep_uerep_view_nof(ep_msg_view * v)
+{
+	return v->nof;
+}
+
+/* Number of UEs announced by the sender */
+static inline uint32_t ep_uerep_view_total(ep_msg_view * v)
+{
+	return ntohl(((ep_uerep_rep *)v->body)->nof_ues);
+}
+
+/* Returns the i-th UE listed, with i < ep_uerep_view_nof() */
+static inline ep_uerep_det * ep_uerep_view_at(ep_msg_view * v, uint32_t i)
+{
+	return (ep_uerep_det *)v->arr + i;
+}
+
+static inline uint16_t ep_uerep_det_pci(ep_uerep_det * d)
+{
+	return ntohs(d->pci);
+}
+
+static inline uint32_t ep_uerep_det_plmn(ep_uerep_det * d)
+{
+	return ntohl(d->plmn);
+}
+
+static inline uint16_t ep_uerep_det_rnti(ep_uerep_det * d)
+{
+	return ntohs(d->rnti);
+}
+
+static inline uint64_t ep_uerep_det_imsi(ep_uerep_det * d)
+{
+	return be64toh(d->imsi);
+}
+
+/******************************************************************************
+ * UE measurement reply                                                       *
+ ******************************************************************************/
+
+/* Number of measurements listed in the message */
+static inline uint32_t ep_uemeas_view_nof(ep_msg_view * v)
+{
+	return v->nof;
+}
+
+/* Returns the i-th measurement listed, with i < ep_uemeas_view_nof() */
+static inline ep_uemeas_det * ep_uemeas_view_at(ep_msg_view * v, uint32_t i)
+{
+	return (ep_uemeas_det *)v->arr + i;
+}
+
+static inline uint8_t ep_uemeas_det_meas_id(ep_uemeas_det * d)
+{
+	return d->meas_id;
+}
+
+static inline int16_t ep_uemeas_det_pci(ep_uemeas_det * d)
+{
+	return (int16_t)ntohs(d->pci);
+}
+
+static inline int16_t ep_uemeas_det_rsrp(ep_uemeas_det * d)
+{
+	return (int16_t)ntohs(d->rsrp);
+}
+
+static inline int16_t ep_uemeas_det_rsrq(ep_uemeas_det * d)
+{
+	return (int16_t)ntohs(d->rsrq);
+}
+
+/******************************************************************************
+ * In-place decode                                                            *
+ ******************************************************************************/
+
+/* Messages consumed as a whole can be decoded in place instead of copied out:
+ * every multi-byte field of the listed entries is converted to host order
+ * inside the message buffer, and the view is marked so that decoding through
+ * it again does nothing. Headers and counts are left untouched, and the view
+ * accessors above keep working on them; the entries instead are no longer in
+ * network order, and must be read directly from the returned array. A message
+ * decoded in place can no longer be validated again, captured or forwarded.
+ */
+
+/* Decode the UEs listed in a validated UE report reply.
+ * Returns the UEs in host order, with 'nof' set to their number, or NULL if
+ * the view is not of a successful UE report reply.
+ */
+ep_uerep_det * ep_uerep_view_decode(ep_msg_view * v, uint32_t * nof);
+
+/* Decode the measurements listed in a validated UE measurement reply.
+ * Returns the measurements in host order, with 'nof' set to their number, or
+ * NULL if the view is not of a successful UE measurement reply.
+ */
+ep_uemeas_det * ep_uemeas_view_decode(ep_msg_view * v, uint32_t * nof);
+
+/******************************************************************************
+ * MAC report reply                                                           *
+ ******************************************************************************/
+
+static inline uint8_t ep_macrep_view_DL_total(ep_msg_view * v)
+{
+	return ((ep_macrep_rep *)v->body)->DL_prbs_total;
+}
+
+static inline uint32_t ep_macrep_view_DL_used(ep_msg_view * v)
+{
+	return ntohl(((ep_macrep_rep *)v->body)->DL_prbs_used);
+}
+
+static inline uint8_t ep_macrep_view_UL_total(ep_msg_view * v)
+{
+	return ((ep_macrep_rep *)v->body)->UL_prbs_total;
+}
+
+static inline uint32_t ep_macrep_view_UL_used(ep_msg_view * v)
+{
+	return ntohl(((ep_macrep_rep *)v->body)->UL_prbs_used);
+}
+
+/* Sequence number of the last full report, in an unchanged reply */
+static inline uint32_t ep_macrep_view_unch_seq(ep_msg_view * v)
+{
+	return ntohl(((ep_macrep_unch *)v->body)->seq);
+}
+
+/******************************************************************************
+ * Handover batch request and reply                                           *
+ ******************************************************************************/
+
+/* Number of handovers, or outcomes, listed in the message */
+static inline uint32_t ep_hob_view_nof(ep_msg_view * v)
+{
+	return v->nof;
+}
+
+/* Returns the i-th handover of a request, with i < ep_hob_view_nof() */
+static inline ep_ho_req * ep_hob_view_req_at(ep_msg_view * v, uint32_t i)
+{
+	return (ep_ho_req *)v->arr + i;
+}
+
+static inline uint16_t ep_ho_req_rnti(ep_ho_req * r)
+{
+	return ntohs(r->rnti);
+}
+
+static inline enb_id_t ep_ho_req_target_eNB(ep_ho_req * r)
+{
+	return be64toh(r->target_eNB);
+}
+
+static inline uint16_t ep_ho_req_target_pci(ep_ho_req * r)
+{
+	return ntohs(r->target_pci);
+}
+
+static inline uint8_t ep_ho_req_cause(ep_ho_req * r)
+{
+	return r->cause;
+}
+
+static inline enb_id_t ep_hob_view_origin_eNB(ep_msg_view * v)
+{
+	return be64toh(((ep_hob_rep *)v->body)->origin_eNB);
+}
+
+static inline uint16_t ep_hob_view_origin_pci(ep_msg_view * v)
+{
+	return ntohs(((ep_hob_rep *)v->body)->origin_pci);
+}
+
+/* Returns the i-th outcome of a reply, with i < ep_hob_view_nof() */
+static inline ep_hob_res * ep_hob_view_res_at(ep_msg_view * v, uint32_t i)
+{
+	return (ep_hob_res *)v->arr + i;
+}
+
+static inline uint16_t ep_hob_res_rnti(ep_hob_res * r)
+{
+	return ntohs(r->rnti);
+}
+
+static inline uint16_t ep_hob_res_target_rnti(ep_hob_res * r)
+{
+	return ntohs(r->target_rnti);
+}
+
+static inline ep_op_type ep_hob_res_result(ep_hob_res * r)
+{
+	return (ep_op_type)r->result;
+}
+
+/******************************************************************************
+ * RAN Slice messages                                                         *
+ ******************************************************************************/
+
+/* Does the message carry a slice? Replies to add, set and remove do not */
+static inline int ep_ran_view_has_slice(ep_msg_view * v)
+{
+	return v->blen >= sizeof(ep_ran_sinf);
+}
+
+/* ID of the slice, if ep_ran_view_has_slice() */
+static inline slice_id_t ep_ran_view_slice_id(ep_msg_view * v)
+{
+	return be64toh(((ep_ran_sinf *)v->body)->id);
+}
+
+/* RBGs of the slice, or 0 if not carried */
+static inline uint16_t ep_ran_view_rbgs(ep_msg_view * v)
+{
+	return v->res ? ntohs(((ep_ran_sres_TLV *)v->res)->body.rbgs) : 0;
+}
+
+/* User scheduler of the slice, or 0 if not carried */
+static inline sched_id_t ep_ran_view_usched(ep_msg_view * v)
+{
+	return v->sch ? ntohl(((ep_ran_ssch_TLV *)v->sch)->body.user_sched) : 0;
+}
+
+/* Number of users of the slice carried in the message */
+static inline uint32_t ep_ran_view_nof_users(ep_msg_view * v)
+{
+	return v->nof;
+}
+
+/* Returns the i-th user of the slice, with i < ep_ran_view_nof_users() */
+static inline rnti_id_t ep_ran_view_user(ep_msg_view * v, uint32_t i)
+{
+	uint8_t * u = (uint8_t *)v->arr + i * sizeof(rnti_id_t);
+
+	return (rnti_id_t)(u[0] << 8 | u[1]);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EMAGE_PROTOCOLS_VIEW_H */
@@ -0,0 +1,454 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Generator of the corpus the profile-guided build is trained on, as
+ * captures (see epcap.h) of three mixes of messages:
+ *
+ *   ue    - dominated by UE reports of up to 200 UEs;
+ *   meas  - dominated by UE measurements and batch handovers;
+ *   slice - dominated by RAN Slice messages with up to 32 users.
+ *
+ * Each mix carries the usual background of hello, capabilities and MAC
+ * reports of a handful of eNBs. The corpus is checked in; the generator
+ * always produces the same messages, only their times of capture change, and
+ * needs to run again only if the mixes do.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <emproto.h>
+
+/* Size of the buffer messages are formatted into */
+#define EPG_BUF_SIZE		(64 * 1024)
+
+/* Messages of each mix */
+#define EPG_MSGS		1000
+
+/* eNBs the messages come from or go to */
+#define EPG_ENBS		8
+
+/* Largest UE report of the corpus */
+#define EPG_UES_MAX		200
+
+/* Largest UE measurement or handover batch of the corpus */
+#define EPG_MEAS_MAX		32
+
+/* Slices in the largest bulk request of the corpus */
+#define EPG_SLICES_MAX		8
+
+static char          epg_buf[EPG_BUF_SIZE];
+static uint32_t      epg_seed;
+static uint32_t      epg_seq;
+
+static ep_ue_details epg_ues[EPG_UES_MAX];
+static ep_ue_measure epg_meas[EPG_MEAS_MAX];
+static ep_ho_det     epg_hos[EPG_MEAS_MAX];
+static ep_ho_out     epg_outs[EPG_MEAS_MAX];
+static rnti_id_t     epg_users[EP_RAN_USERS_MAX];
+static ep_macrep_sup epg_sup[EPG_ENBS];
+
+/* Same sequence on every machine, unlike rand() */
+static uint32_t epg_rand(uint32_t n)
+{
+	epg_seed ^= epg_seed << 13;
+	epg_seed ^= epg_seed >> 17;
+	epg_seed ^= epg_seed << 5;
+
+	return n ? epg_seed % n : 0;
+}
+
+/* Number the message just formatted, which is then captured */
+static void epg_seal(int len)
+{
+	if(len < 0) {
+		fprintf(stderr, "Cannot format a message!\n");
+		exit(1);
+	}
+
+	epf_seq(epg_buf, len, epg_seq++);
+}
+
+static void epg_ues_fill(uint32_t n)
+{
+	uint32_t i;
+
+	for(i = 0; i < n; i++) {
+		epg_ues[i].pci  = epg_rand(504);
+		epg_ues[i].plmn = 0x222f93;
+		epg_ues[i].rnti = 0x3d + epg_rand(0xfff0);
+		epg_ues[i].imsi = 222930000000001ULL + epg_rand(100000);
+	}
+}
+
+/******************************************************************************
+ * Background                                                                 *
+ ******************************************************************************/
+
+static void epg_hello(enb_id_t enb)
+{
+	if(epg_rand(2)) {
+		epg_seal(epf_single_hello_req(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, epg_seq));
+	} else {
+		epg_seal(epf_single_hello_rep(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, epg_seq));
+	}
+}
+
+static void epg_caps(enb_id_t enb)
+{
+	ep_enb_det  det;
+	ep_cell_det cell;
+	uint32_t    i;
+
+	memset(&det, 0, sizeof(det));
+
+	det.capmask   = EP_ECAP_UE_REPORT | EP_ECAP_UE_MEASURE |
+		EP_ECAP_HANDOVER;
+	det.nof_cells = 1 + epg_rand(EP_ECAP_CELL_MAX);
+
+	for(i = 0; i < det.nof_cells; i++) {
+		det.cells[i].pci       = epg_rand(504);
+		det.cells[i].cap       = 1;
+		det.cells[i].DL_earfcn = 3400 + i;
+		det.cells[i].UL_earfcn = 21400 + i;
+		det.cells[i].DL_prbs   = 100;
+		det.cells[i].UL_prbs   = 100;
+	}
+
+	cell = det.cells[0];
+
+	switch(epg_rand(4)) {
+	case 0:
+		epg_seal(epf_single_ecap_req(
+			epg_buf, sizeof(epg_buf), enb, 0, 0));
+		break;
+	case 1:
+		epg_seal(epf_single_ecap_rep(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, &det));
+		break;
+	case 2:
+		epg_seal(epf_single_ccap_req(
+			epg_buf, sizeof(epg_buf), enb, cell.pci, 0));
+		break;
+	default:
+		epg_seal(epf_single_ccap_rep(
+			epg_buf, sizeof(epg_buf), enb, cell.pci, 0, &cell));
+		break;
+	}
+}
+
+static void epg_macrep(enb_id_t enb)
+{
+	ep_macrep_det det;
+
+	/* Cells are idle half of the times, and the report does not change */
+	det.DL_prbs_total = 100;
+	det.DL_prbs_used  = epg_rand(2) ? 0 : epg_rand(100000);
+	det.UL_prbs_total = 100;
+	det.UL_prbs_used  = det.DL_prbs_used ? epg_rand(100000) : 0;
+
+	if(epg_rand(8) == 0) {
+		epg_seal(epf_trigger_macrep_req(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, 1000));
+		return;
+	}
+
+	epg_seal(epf_trigger_macrep_rep_sup(
+		epg_buf, sizeof(epg_buf), enb, 0, 0, epg_seq,
+		epg_sup + enb % EPG_ENBS, &det));
+}
+
+static void epg_ho(enb_id_t enb)
+{
+	if(epg_rand(2)) {
+		epg_seal(epf_single_ho_req(
+			epg_buf, sizeof(epg_buf), enb, 0, 0,
+			0x3d + epg_rand(1000), enb + 1, epg_rand(504), 1));
+	} else {
+		epg_seal(epf_single_ho_rep(
+			epg_buf, sizeof(epg_buf), enb, 0, 0,
+			enb + 1, epg_rand(504), 0x3d + epg_rand(1000),
+			0x3d + epg_rand(1000)));
+	}
+}
+
+/* Any background message */
+static void epg_background(enb_id_t enb)
+{
+	switch(epg_rand(4)) {
+	case 0:
+		epg_hello(enb);
+		break;
+	case 1:
+		epg_caps(enb);
+		break;
+	case 2:
+		epg_macrep(enb);
+		break;
+	default:
+		epg_ho(enb);
+		break;
+	}
+}
+
+/******************************************************************************
+ * Mixes                                                                      *
+ ******************************************************************************/
+
+static void epg_uerep(enb_id_t enb)
+{
+	uint32_t n;
+
+	if(epg_rand(10) == 0) {
+		epg_seal(epf_trigger_uerep_req(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, EP_OPERATION_ADD));
+		return;
+	}
+
+	/* Mostly small cells, some crowded ones */
+	n = epg_rand(4) ? epg_rand(32) : epg_rand(EPG_UES_MAX + 1);
+
+	epg_ues_fill(n);
+
+	epg_seal(epf_trigger_uerep_rep(
+		epg_buf, sizeof(epg_buf), enb, 0, 0, n, n, epg_ues));
+}
+
+static void epg_uemeas(enb_id_t enb)
+{
+	uint32_t i;
+	uint32_t n;
+
+	if(epg_rand(10) == 0) {
+		epg_seal(epf_trigger_uemeas_req(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, EP_OPERATION_ADD,
+			epg_rand(32), 0x3d + epg_rand(1000), 3400, 200, -1, -1));
+		return;
+	}
+
+	n = 1 + epg_rand(EPG_MEAS_MAX);
+
+	for(i = 0; i < n; i++) {
+		epg_meas[i].meas_id = epg_rand(32);
+		epg_meas[i].pci     = epg_rand(504);
+		epg_meas[i].rsrp    = (uint16_t)(-70 - (int)epg_rand(70));
+		epg_meas[i].rsrq    = (uint16_t)(-3 - (int)epg_rand(17));
+	}
+
+	epg_seal(epf_trigger_uemeas_rep(
+		epg_buf, sizeof(epg_buf), enb, 0, 0, n, n, epg_meas));
+}
+
+static void epg_hob(enb_id_t enb)
+{
+	uint32_t i;
+	uint32_t n = 1 + epg_rand(EPG_MEAS_MAX);
+
+	for(i = 0; i < n; i++) {
+		epg_hos[i].rnti       = 0x3d + epg_rand(1000);
+		epg_hos[i].target_eNB = enb + 1 + epg_rand(4);
+		epg_hos[i].target_pci = epg_rand(504);
+		epg_hos[i].cause      = 1;
+
+		epg_outs[i].rnti        = epg_hos[i].rnti;
+		epg_outs[i].target_rnti = 0x3d + epg_rand(1000);
+		epg_outs[i].result      = epg_rand(8) ?
+			EP_OPERATION_SUCCESS : EP_OPERATION_FAIL;
+	}
+
+	if(epg_rand(2)) {
+		epg_seal(epf_single_ho_batch_req(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, n, epg_hos));
+	} else {
+		epg_seal(epf_single_ho_batch_rep(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, enb - 1,
+			epg_rand(504), n, epg_outs));
+	}
+}
+
+static void epg_slice_det(ep_ran_slice_det * det)
+{
+	uint32_t i;
+
+	det->nof_users = epg_rand(EP_RAN_USERS_MAX + 1);
+	det->l2.usched = epg_rand(2);
+	det->l2.rbgs   = 1 + epg_rand(25);
+
+	for(i = 0; i < det->nof_users; i++) {
+		det->users[i] = 0x3d + epg_rand(1000);
+	}
+}
+
+static void epg_slice(enb_id_t enb)
+{
+	ep_ran_slice_det det;
+	ep_ran_det       ran;
+	slice_id_t       id = 0x0100000000000000ULL + epg_rand(8);
+
+	epg_slice_det(&det);
+
+	switch(epg_rand(10)) {
+	case 0:
+	case 1:
+		epg_seal(epf_single_ran_slice_add(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, id, &det));
+		break;
+	case 2:
+	case 3:
+		epg_seal(epf_single_ran_slice_set(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, id, &det));
+		break;
+	case 4:
+	case 5:
+		epg_seal(epf_single_ran_slice_rep(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, id, &det));
+		break;
+	case 6:
+		epg_seal(epf_single_ran_slice_req(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, id));
+		break;
+	case 7:
+		epg_seal(epf_single_ran_slice_rem(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, id));
+		break;
+	case 8:
+		epg_seal(epf_single_ran_rep_success(
+			epg_buf, sizeof(epg_buf), EP_ACT_RAN_SLICE, enb, 0, 0));
+		break;
+	default:
+		ran.l1_mask            = 0;
+		ran.l2_mask            = 1;
+		ran.l3_mask            = 0;
+		ran.l2.mac.slice_sched = 0x80000001;
+
+		if(epg_rand(2)) {
+			epg_seal(epf_single_ran_setup_req(
+				epg_buf, sizeof(epg_buf), enb, 0, 0));
+		} else {
+			epg_seal(epf_single_ran_setup_rep(
+				epg_buf, sizeof(epg_buf), enb, 0, 0, &ran));
+		}
+		break;
+	}
+}
+
+static void epg_bulk(enb_id_t enb)
+{
+	ep_ran_sblk_det ops[EPG_SLICES_MAX];
+	ep_ran_sblk_out outs[EPG_SLICES_MAX];
+	uint32_t        i;
+	uint32_t        n = 1 + epg_rand(EPG_SLICES_MAX);
+
+	for(i = 0; i < n; i++) {
+		ops[i].id            = 0x0100000000000000ULL + i;
+		ops[i].op            = epg_rand(4) ?
+			EP_OPERATION_SET : EP_OPERATION_ADD;
+		ops[i].det.nof_users = epg_rand(EP_RAN_USERS_MAX + 1);
+		ops[i].det.users     = epg_users;
+		ops[i].det.l2.usched = 1;
+		ops[i].det.l2.rbgs   = 1 + epg_rand(25);
+
+		outs[i].id     = ops[i].id;
+		outs[i].result = EP_OPERATION_SUCCESS;
+	}
+
+	if(epg_rand(2)) {
+		epg_seal(epf_single_ran_slice_bulk_req(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, n, ops));
+	} else {
+		epg_seal(epf_single_ran_slice_bulk_rep(
+			epg_buf, sizeof(epg_buf), enb, 0, 0, n, outs));
+	}
+}
+
+/* Capture a mix in which 'main' takes 'share' messages out of 10 */
+static int epg_mix(
+	const char * prefix,
+	void (* main)(enb_id_t),
+	void (* more)(enb_id_t),
+	uint32_t     share)
+{
+	uint32_t i;
+	uint32_t r;
+	enb_id_t enb;
+
+	if(ep_cap_open(prefix, 0)) {
+		fprintf(stderr, "Cannot capture in %s\n", prefix);
+		return -1;
+	}
+
+	for(i = 0; i < EPG_MSGS; i++) {
+		enb = 1 + epg_rand(EPG_ENBS);
+		r   = epg_rand(10);
+
+		if(r < share) {
+			main(enb);
+		} else if(r < share + 1 && more) {
+			more(enb);
+		} else {
+			epg_background(enb);
+		}
+	}
+
+	ep_cap_close();
+
+	return 0;
+}
+
+int main(int argc, char ** argv)
+{
+	char     path[256];
+	uint32_t i;
+
+	if(argc < 2) {
+		fprintf(stderr, "Usage: epcorpus <directory>\n");
+		return 1;
+	}
+
+	epg_seed = 0x2545f491;
+
+	for(i = 0; i < EP_RAN_USERS_MAX; i++) {
+		epg_users[i] = 0x3d + i;
+	}
+
+	for(i = 0; i < EPG_ENBS; i++) {
+		ep_macrep_sup_init(epg_sup + i, EP_MACREP_SUP_MARKER, 0);
+	}
+
+	snprintf(path, sizeof(path), "%s/ue", argv[1]);
+
+	if(epg_mix(path, epg_uerep, epg_uemeas, 6)) {
+		return 1;
+	}
+
+	snprintf(path, sizeof(path), "%s/meas", argv[1]);
+
+	if(epg_mix(path, epg_uemeas, epg_hob, 6)) {
+		return 1;
+	}
+
+	snprintf(path, sizeof(path), "%s/slice", argv[1]);
+
+	if(epg_mix(path, epg_slice, epg_bulk, 6)) {
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,533 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs the messages of captures (see epcap.h) through the library, as the
+ * training of the profile-guided build and as its measure.
+ *
+ * Every message is validated, dispatched on its type, action, operation and
+ * direction as an agent or a controller would, parsed by its epp_* parser and
+ * formatted again from what was parsed. The time taken by the fastest of the
+ * passes over each capture, which is the least disturbed by the rest of the
+ * machine, is reported as a tab-separated line:
+ *
+ *   build  capture  msgs  passes  ns_msg
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <emproto.h>
+
+/* Size of the buffer messages are formatted again into */
+#define EPG_BUF_SIZE		(64 * 1024)
+
+/* Largest array parsed out of a message */
+#define EPG_ARR_MAX		4096
+
+/* Default passes over each capture */
+#define EPG_PASSES_DEFAULT	200
+
+static const char * usage =
+	"Usage: eptrain [options] <prefix> [prefix ...]\n"
+	"\n"
+	"Options:\n"
+	"    -p <passes>  Passes over each capture (%d)\n"
+	"    -b <build>   Name of the build, as reported (-)\n";
+
+static char             epg_out[EPG_BUF_SIZE];
+
+static ep_ue_details    epg_ues[EPG_ARR_MAX];
+static ep_ue_measure    epg_meas[EPG_ARR_MAX];
+static ep_ho_det        epg_hos[EPG_ARR_MAX];
+static ep_ho_out        epg_outs[EPG_ARR_MAX];
+static ep_ran_sblk_view epg_ops[EPG_ARR_MAX];
+static ep_ran_sblk_out  epg_souts[EPG_ARR_MAX];
+
+/* Messages of a capture, collected before the measure */
+typedef struct __ep_train_message {
+	char *       buf;
+	unsigned int len;
+} epg_msg;
+
+/******************************************************************************
+ * Dispatch                                                                   *
+ ******************************************************************************/
+
+static int epg_hello(char * buf, unsigned int len, int rep)
+{
+	uint32_t id;
+
+	if(rep) {
+		if(epp_single_hello_rep(buf, len, &id)) {
+			return -1;
+		}
+
+		return epf_single_hello_rep(
+			epg_out, sizeof(epg_out), 1, 0, 0, id);
+	}
+
+	if(epp_single_hello_req(buf, len, &id)) {
+		return -1;
+	}
+
+	return epf_single_hello_req(epg_out, sizeof(epg_out), 1, 0, 0, id);
+}
+
+static int epg_ecap(char * buf, unsigned int len, int rep)
+{
+	ep_enb_det det;
+
+	if(!rep) {
+		if(epp_single_ecap_req(buf, len)) {
+			return -1;
+		}
+
+		return epf_single_ecap_req(epg_out, sizeof(epg_out), 1, 0, 0);
+	}
+
+	if(epp_single_ecap_rep(buf, len, &det)) {
+		return -1;
+	}
+
+	return epf_single_ecap_rep(epg_out, sizeof(epg_out), 1, 0, 0, &det);
+}
+
+static int epg_ccap(char * buf, unsigned int len, int rep)
+{
+	ep_cell_det cell;
+
+	if(!rep) {
+		if(epp_single_ccap_req(buf, len)) {
+			return -1;
+		}
+
+		return epf_single_ccap_req(epg_out, sizeof(epg_out), 1, 0, 0);
+	}
+
+	if(epp_single_ccap_rep(buf, len, &cell)) {
+		return -1;
+	}
+
+	return epf_single_ccap_rep(epg_out, sizeof(epg_out), 1, 0, 0, &cell);
+}
+
+static int epg_uerep(char * buf, unsigned int len, int rep, ep_op_type op)
+{
+	uint32_t nof;
+
+	if(!rep) {
+		if(epp_trigger_uerep_req(buf, len)) {
+			return -1;
+		}
+
+		return epf_trigger_uerep_req(
+			epg_out, sizeof(epg_out), 1, 0, 0, op);
+	}
+
+	if(epp_trigger_uerep_rep(buf, len, &nof, EPG_ARR_MAX, epg_ues)) {
+		return -1;
+	}
+
+	return epf_trigger_uerep_rep(
+		epg_out, sizeof(epg_out), 1, 0, 0, nof, EPG_ARR_MAX, epg_ues);
+}
+
+static int epg_uemeas(char * buf, unsigned int len, int rep, ep_op_type op)
+{
+	uint8_t  id;
+	uint16_t rnti;
+	uint16_t earfcn;
+	uint16_t interval;
+	int16_t  cells;
+	int16_t  meas;
+	uint32_t nof;
+
+	if(!rep) {
+		if(epp_trigger_uemeas_req(buf, len,
+			&id, &rnti, &earfcn, &interval, &cells, &meas))
+		{
+			return -1;
+		}
+
+		return epf_trigger_uemeas_req(
+			epg_out, sizeof(epg_out), 1, 0, 0, op,
+			id, rnti, earfcn, interval, cells, meas);
+	}
+
+	if(epp_trigger_uemeas_rep(buf, len, &nof, EPG_ARR_MAX, epg_meas)) {
+		return -1;
+	}
+
+	return epf_trigger_uemeas_rep(
+		epg_out, sizeof(epg_out), 1, 0, 0, nof, EPG_ARR_MAX, epg_meas);
+}
+
+static int epg_macrep(char * buf, unsigned int len, int rep, ep_op_type op)
+{
+	ep_macrep_det det;
+	uint16_t      interval;
+	uint32_t      seq;
+
+	if(!rep) {
+		if(epp_trigger_macrep_req(buf, len, &interval)) {
+			return -1;
+		}
+
+		return epf_trigger_macrep_req(
+			epg_out, sizeof(epg_out), 1, 0, 0, interval);
+	}
+
+	/* Nothing to format again out of an unchanged marker */
+	if(op == EP_OPERATION_UNCHANGED) {
+		return epp_trigger_macrep_unch(buf, len, &seq);
+	}
+
+	if(epp_trigger_macrep_rep(buf, len, &det)) {
+		return -1;
+	}
+
+	return epf_trigger_macrep_rep(epg_out, sizeof(epg_out), 1, 0, 0, &det);
+}
+
+static int epg_ho(char * buf, unsigned int len, int rep)
+{
+	enb_id_t enb;
+	uint16_t pci;
+	uint16_t rnti;
+	uint16_t trnti;
+	uint8_t  cause;
+
+	if(!rep) {
+		if(epp_single_ho_req(buf, len, &rnti, &enb, &pci, &cause)) {
+			return -1;
+		}
+
+		return epf_single_ho_req(
+			epg_out, sizeof(epg_out), 1, 0, 0, rnti, enb, pci, cause);
+	}
+
+	if(epp_single_ho_rep(buf, len, &enb, &pci, &rnti, &trnti)) {
+		return -1;
+	}
+
+	return epf_single_ho_rep(
+		epg_out, sizeof(epg_out), 1, 0, 0, enb, pci, rnti, trnti);
+}
+
+static int epg_hob(char * buf, unsigned int len, int rep)
+{
+	enb_id_t enb;
+	uint16_t pci;
+	uint16_t nof;
+
+	if(!rep) {
+		if(epp_single_ho_batch_req(
+			buf, len, &nof, EPG_ARR_MAX, epg_hos))
+		{
+			return -1;
+		}
+
+		return epf_single_ho_batch_req(
+			epg_out, sizeof(epg_out), 1, 0, 0, nof, epg_hos);
+	}
+
+	if(epp_single_ho_batch_rep(
+		buf, len, &enb, &pci, &nof, EPG_ARR_MAX, epg_outs))
+	{
+		return -1;
+	}
+
+	return epf_single_ho_batch_rep(
+		epg_out, sizeof(epg_out), 1, 0, 0, enb, pci, nof, epg_outs);
+}
+
+static int epg_ran_setup(char * buf, unsigned int len, int rep)
+{
+	ep_ran_det ran;
+
+	if(!rep) {
+		if(epp_single_ran_setup_req(buf, len)) {
+			return -1;
+		}
+
+		return epf_single_ran_setup_req(
+			epg_out, sizeof(epg_out), 1, 0, 0);
+	}
+
+	if(epp_single_ran_setup_rep(buf, len, &ran)) {
+		return -1;
+	}
+
+	return epf_single_ran_setup_rep(
+		epg_out, sizeof(epg_out), 1, 0, 0, &ran);
+}
+
+static int epg_slice(char * buf, unsigned int len, int rep, ep_op_type op)
+{
+	ep_ran_slice_det det;
+	slice_id_t       id;
+
+	if(rep) {
+		/* Outcome of an add, set or remove, with no slice */
+		if(op != EP_OPERATION_UNSPECIFIED) {
+			return 0;
+		}
+
+		if(epp_single_ran_slice_rep(buf, len, &id, &det)) {
+			return -1;
+		}
+
+		return epf_single_ran_slice_rep(
+			epg_out, sizeof(epg_out), 1, 0, 0, id, &det);
+	}
+
+	switch(op) {
+	case EP_OPERATION_ADD:
+		if(epp_single_ran_slice_add(buf, len, &id, &det)) {
+			return -1;
+		}
+
+		return epf_single_ran_slice_add(
+			epg_out, sizeof(epg_out), 1, 0, 0, id, &det);
+	case EP_OPERATION_SET:
+		if(epp_single_ran_slice_set(buf, len, &id, &det)) {
+			return -1;
+		}
+
+		return epf_single_ran_slice_set(
+			epg_out, sizeof(epg_out), 1, 0, 0, id, &det);
+	case EP_OPERATION_REM:
+		if(epp_single_ran_slice_rem(buf, len, &id)) {
+			return -1;
+		}
+
+		return epf_single_ran_slice_rem(
+			epg_out, sizeof(epg_out), 1, 0, 0, id);
+	default:
+		if(epp_single_ran_slice_req(buf, len, &id)) {
+			return -1;
+		}
+
+		return epf_single_ran_slice_req(
+			epg_out, sizeof(epg_out), 1, 0, 0, id);
+	}
+}
+
+static int epg_bulk(char * buf, unsigned int len, int rep)
+{
+	uint16_t nof;
+
+	/* Users stay in the message, so the request is not formatted again */
+	if(!rep) {
+		return epp_single_ran_slice_bulk_req(
+			buf, len, &nof, EPG_ARR_MAX, epg_ops);
+	}
+
+	if(epp_single_ran_slice_bulk_rep(
+		buf, len, &nof, EPG_ARR_MAX, epg_souts))
+	{
+		return -1;
+	}
+
+	return epf_single_ran_slice_bulk_rep(
+		epg_out, sizeof(epg_out), 1, 0, 0, nof, epg_souts);
+}
+
+/* Handle a message as received.
+ * Returns a non-negative number, or -1 on error.
+ */
+static int epg_handle(char * buf, unsigned int len)
+{
+	ep_msg_view v;
+	ep_act_type act;
+	ep_op_type  op;
+	int         rep;
+
+	if(ep_msg_validate(buf, len, &v)) {
+		return -1;
+	}
+
+	/* Already captured by the validation, if capture is on */
+	if(epp_head_peek(buf, len, 0, 0, 0, 0, 0)) {
+		return -1;
+	}
+
+	rep = epp_dir(buf, len) == EP_HDR_FLAG_DIR_REP;
+
+	switch(epp_msg_type(buf, len)) {
+	case EP_TYPE_SINGLE_MSG:
+		act = epp_single_type(buf, len);
+		op  = epp_single_op(buf, len);
+		break;
+	case EP_TYPE_SCHEDULE_MSG:
+		act = epp_schedule_type(buf, len);
+		op  = EP_OPERATION_UNSPECIFIED;
+		break;
+	case EP_TYPE_TRIGGER_MSG:
+		act = epp_trigger_type(buf, len);
+		op  = epp_trigger_op(buf, len);
+		break;
+	default:
+		return -1;
+	}
+
+	switch(act) {
+	case EP_ACT_HELLO:
+		return epg_hello(buf, len, rep);
+	case EP_ACT_ECAP:
+		return epg_ecap(buf, len, rep);
+	case EP_ACT_CCAP:
+		return epg_ccap(buf, len, rep);
+	case EP_ACT_UE_REPORT:
+		return epg_uerep(buf, len, rep, op);
+	case EP_ACT_UE_MEASURE:
+		return epg_uemeas(buf, len, rep, op);
+	case EP_ACT_MAC_REPORT:
+		return epg_macrep(buf, len, rep, op);
+	case EP_ACT_HANDOVER:
+		return epg_ho(buf, len, rep);
+	case EP_ACT_HO_BATCH:
+		return epg_hob(buf, len, rep);
+	case EP_ACT_RAN_SETUP:
+		return epg_ran_setup(buf, len, rep);
+	case EP_ACT_RAN_SLICE:
+		return epg_slice(buf, len, rep, op);
+	case EP_ACT_RAN_SLICE_BULK:
+		return epg_bulk(buf, len, rep);
+	default:
+		return -1;
+	}
+}
+
+/******************************************************************************
+ * Runs                                                                       *
+ ******************************************************************************/
+
+static double epg_ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+
+	return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/* Run a capture through the library 'passes' times, and report it */
+static int epg_run(const char * prefix, const char * build, int passes)
+{
+	ep_capr      r;
+	ep_capr_pos  pos;
+	ep_cap_rec * rec;
+	epg_msg *    msgs;
+	char *       m;
+	uint64_t     nof = 0;
+	uint64_t     i;
+	double       t;
+	double       best = 0;
+	int          p;
+	int          ret = 0;
+
+	if(ep_capr_open(&r, prefix)) {
+		fprintf(stderr, "Cannot open the capture %s\n", prefix);
+		return -1;
+	}
+
+	msgs = malloc(sizeof(epg_msg) * r.nof_ents);
+
+	if(!msgs) {
+		ep_capr_close(&r);
+		return -1;
+	}
+
+	memset(&pos, 0, sizeof(pos));
+
+	while((m = ep_capr_next(&r, &pos, &rec)) && nof < r.nof_ents) {
+		msgs[nof].buf = m;
+		msgs[nof].len = rec->len;
+		nof++;
+	}
+
+	/* Every message must go through, or the profile would be partial */
+	for(i = 0; i < nof; i++) {
+		if(epg_handle(msgs[i].buf, msgs[i].len) < 0) {
+			fprintf(stderr, "Message %lu of %s not handled!\n",
+				(unsigned long)i, prefix);
+			ret = -1;
+		}
+	}
+
+	for(p = 0; p < passes; p++) {
+		t = epg_ns();
+
+		for(i = 0; i < nof; i++) {
+			epg_handle(msgs[i].buf, msgs[i].len);
+		}
+
+		t = epg_ns() - t;
+
+		if(p == 0 || t < best) {
+			best = t;
+		}
+	}
+
+	printf("%s\t%s\t%lu\t%d\t%.1f\n", build, prefix, (unsigned long)nof,
+		passes, nof ? best / nof : 0.0);
+
+	free(msgs);
+	ep_capr_close(&r);
+
+	return ret;
+}
+
+int main(int argc, char ** argv)
+{
+	const char * build  = "-";
+	int          passes = EPG_PASSES_DEFAULT;
+	int          ret    = 0;
+	int          o;
+
+	while((o = getopt(argc, argv, "p:b:")) != -1) {
+		switch(o) {
+		case 'p':
+			passes = atoi(optarg);
+			break;
+		case 'b':
+			build = optarg;
+			break;
+		default:
+			fprintf(stderr, usage, EPG_PASSES_DEFAULT);
+			return 1;
+		}
+	}
+
+	if(optind >= argc || passes < 0) {
+		fprintf(stderr, usage, EPG_PASSES_DEFAULT);
+		return 1;
+	}
+
+	for(; optind < argc; optind++) {
+		if(epg_run(argv[optind], build, passes)) {
+			ret = 1;
+		}
+	}
+
+	return ret;
+}
@@ -18,6 +18,11 @@
 #include <string.h>
 #include <netinet/in.h>
 
+/* Trace points of the module */
+#define EP_TRC_CAT		(EP_TRC_ACT(EP_ACT_RAN_SETUP) |	\
+			 EP_TRC_ACT(EP_ACT_RAN_SLICE) |	\
+			 EP_TRC_ACT(EP_ACT_RAN_SLICE_BULK))
+
 #include <emproto.h>
 
 #define min(a,b)	(a < b ? a : b)
@@ -28,18 +33,14 @@
  * 
  */
 
-/* Format EUQ, sEtup Unspecified reQuest. 
- * Returns the size in bytes of the formatted area.
- */
-int epf_ran_euq(char * buf, unsigned int size)
+/* Format EUQ, sEtup Unspecified reQuest */
+void epf_ran_euq_w(ep_writer * w)
 {
 	/*
 	 * Currently the RAN setup request has no body 
 	 */
 
-	ep_dbg_dump(EP_DBG_2"F - RANS Rep: ", buf, 0);
-
-	return 0;
+	ep_dbg_dump(EP_DBG_2"F - RANS Rep: ", w->buf + w->pos, 0);
 }
 
 /*
@@ -48,37 +49,44 @@ int epf_ran_euq(char * buf, unsigned int size)
  * 
  */
 
-/* Format SUP, Slice rePly TLV tokens.
- * Returns the size in bytes of the formatted area.
- */
-int epf_ran_TLV(char * buf, unsigned int size, ep_ran_slice_det * det)
+/* Size of SUP, Slice rePly TLV tokens, as formatted by epf_ran_TLV_l_w() */
+unsigned int epf_ran_TLV_size(ep_ran_slice_ldet * det)
 {
-	int               s = 0;
-	char *            c = buf;
+	return sizeof(ep_ran_sres_TLV) +
+		(det->l2.usched != 0 ? sizeof(ep_ran_ssch_TLV) : 0) +
+		(det->nof_users > 0 ?
+			epf_TLV_rnti_report_size(det->nof_users) : 0);
+}
 
+/* Format SUP, Slice rePly TLV tokens, with users listed in an array of any
+ * length.
+ */
+void epf_ran_TLV_l_w(ep_writer * w, ep_ran_slice_ldet * det)
+{
 	ep_ran_sres_TLV * sres;
 	ep_ran_ssch_TLV * ssch;
 
+	/* TLV length is 16 bits wide */
+	if(det->nof_users > 0 && (
+		det->nof_users * sizeof(rnti_id_t) > 0xffff || !det->users))
+	{
+		ep_dbg_log(EP_DBG_3"F - RANS TLV: Invalid users!\n");
+		ep_w_fail(w);
+		return;
+	}
+
 	/*
 	 * Format the RAN Slice resource token
 	 */
 
-	sres = (ep_ran_sres_TLV *)c;
-
-	if(c + sizeof(ep_ran_sres_TLV) > buf + size) {
-		ep_dbg_log(EP_DBG_3"F - RANS TLV: Not enough space!\n");
-		return -1;
-	}
+	sres = (ep_ran_sres_TLV *)ep_w_put(w, sizeof(ep_ran_sres_TLV));
 
 	sres->header.type   = htons(EP_TLV_RAN_SLICE_MAC_RES);
 	sres->header.length = htons(sizeof(ep_ran_sres));
 	sres->body.rbgs     = htons(det->l2.rbgs);
 
 	ep_dbg_dump(EP_DBG_3
-		"F - RANS Res TLV: ", c, sizeof(ep_ran_sres_TLV));
-
-	s += sizeof(ep_ran_sres_TLV);
-	c += sizeof(ep_ran_sres_TLV);
+		"F - RANS Res TLV: ", (char *)sres, sizeof(ep_ran_sres_TLV));
 
 	/*
 	 * Format the RAN Slice scheduler token
@@ -89,39 +97,35 @@ int epf_ran_TLV(char * buf, unsigned int size, ep_ran_slice_det * det)
 		goto usr;
 	}
 
-	ssch = (ep_ran_ssch_TLV *)c;
-
-	if(c + sizeof(ep_ran_ssch_TLV) > buf + size) {
-		ep_dbg_log(EP_DBG_3"F - RANS TLV: Not enough space!\n");
-		return -1;
-	}
+	ssch = (ep_ran_ssch_TLV *)ep_w_put(w, sizeof(ep_ran_ssch_TLV));
 
 	ssch->header.type    = htons(EP_TLV_RAN_SLICE_MAC_SCHED);
 	ssch->header.length  = htons(sizeof(ep_ran_ssch));
 	ssch->body.user_sched= htonl(det->l2.usched);
 
 	ep_dbg_dump(EP_DBG_3
-		"F - RANS Sched TLV: ", c, sizeof(ep_ran_ssch_TLV));
-
-	s += sizeof(ep_ran_ssch_TLV);
-	c += sizeof(ep_ran_ssch_TLV);
+		"F - RANS Sched TLV: ", (char *)ssch, sizeof(ep_ran_ssch_TLV));
 usr:
 	/*
 	 * Format the RAN Slice users token
 	 */
 
 	if(det->nof_users > 0) {
-		s = epf_TLV_rnti_report(
-			c, size - s, det->users, det->nof_users);
+		epf_TLV_rnti_report_w(w, det->users, det->nof_users);
+	}
+}
 
-		if(s < 0) {
-			return s;
-		}
+/* Format SUP, Slice rePly TLV tokens */
+void epf_ran_TLV_w(ep_writer * w, ep_ran_slice_det * det)
+{
+	ep_ran_slice_ldet l;
 
-		c += s;
-	}
+	l.nof_users = det->nof_users < EP_RAN_USERS_MAX ?
+		det->nof_users : EP_RAN_USERS_MAX;
+	l.users     = det->users;
+	l.l2        = det->l2;
 
-	return c - buf;
+	epf_ran_TLV_l_w(w, &l);
 }
 
 /* Parse a single TLV field for Slice Unspecified Reply.
@@ -145,6 +149,11 @@ int epp_ran_TLV(char * buf, ep_ran_slice_det * det)
 		{
 			return EP_ERROR;
 		}
+
+		if(ntohs(tlv->length) / sizeof(rnti_id_t) > det->nof_users) {
+			ep_dbg_log(EP_DBG_3"P - RANS: Users truncated to %d, "
+				"use a slice view!\n", EP_RAN_USERS_MAX);
+		}
 		break;
 	case EP_TLV_RAN_SLICE_MAC_RES:
 		/* Points to the TLV body */
@@ -179,6 +188,68 @@ int epp_ran_TLV(char * buf, ep_ran_slice_det * det)
 	return EP_SUCCESS;
 }
 
+/* Parse a single TLV field for Slice Unspecified Reply into a view; nothing
+ * is copied, and the users stay in the message buffer.
+ *
+ * It assumes that the checks over the size have already been done by the 
+ * caller, and the area of memory is fine to access.
+ */
+int epp_ran_TLV_view(char * buf, ep_ran_slice_view * view)
+{
+	ep_TLV *          tlv = (ep_TLV *)buf;
+	ep_ran_sres_TLV * sres;
+	ep_ran_ssch_TLV * ssch;
+
+	switch(ntohs(tlv->type)) {
+	case EP_TLV_RNTI_REPORT:
+		view->nof_users = ntohs(tlv->length) / sizeof(rnti_id_t);
+		view->users     = buf + sizeof(ep_TLV);
+
+		ep_dbg_dump(
+			EP_DBG_3"P - RANS Users TLV: ",
+			buf,
+			sizeof(ep_TLV) + ntohs(tlv->length));
+
+		break;
+	case EP_TLV_RAN_SLICE_MAC_RES:
+		if(ntohs(tlv->length) < sizeof(ep_ran_sres)) {
+			return EP_ERROR;
+		}
+
+		sres = (ep_ran_sres_TLV *)(buf);
+
+		view->l2.rbgs   = ntohs(sres->body.rbgs);
+
+		ep_dbg_dump(
+			EP_DBG_3"P - RANS Res TLV: ", 
+			buf, 
+			sizeof(ep_ran_sres_TLV));
+
+		break;
+	case EP_TLV_RAN_SLICE_MAC_SCHED:
+		if(ntohs(tlv->length) < sizeof(ep_ran_ssch)) {
+			return EP_ERROR;
+		}
+
+		ssch = (ep_ran_ssch_TLV *)(buf);
+
+		view->l2.usched = ntohl(ssch->body.user_sched);
+
+		ep_dbg_dump(
+			EP_DBG_3"P - RANS Sched TLV: ", 
+			buf, 
+			sizeof(ep_ran_ssch_TLV));
+
+		break;
+	default:
+		ep_dbg_log(EP_DBG_3"P - RANS: Unexpected TLV %d!\n", 
+			ntohs(tlv->type));
+		break;
+	}
+
+	return EP_SUCCESS;
+}
+
 /*
  * 
  * RAN parsers for messages:
@@ -199,49 +270,38 @@ int epp_ran_euq(char * buf, unsigned int size)
 	return EP_SUCCESS;
 }
 
-/* Format EPQ, sEtup Unspecified rePly.
- * Returns the size in bytes of the formatted area.
- */
-int epf_ran_eup(char * buf, unsigned int size, ep_ran_det * det)
+/* Size of EUP, sEtup Unspecified rePly, as formatted by epf_ran_eup_w() */
+unsigned int epf_ran_eup_size(ep_ran_det * det)
 {
-	ep_ran_setup * s = (ep_ran_setup *)buf;
+	return sizeof(ep_ran_setup) +
+		(det->l2.mac.slice_sched != EP_RAN_SCHED_INVALID ?
+			sizeof(ep_ran_mac_sched_TLV) : 0);
+}
 
-	/* Keeps the most updated current buf position */
-	char *         c = buf;
+/* Format EPQ, sEtup Unspecified rePly */
+void epf_ran_eup_w(ep_writer * w, ep_ran_det * det)
+{
+	ep_ran_setup * s = (ep_ran_setup *)ep_w_put(w, sizeof(ep_ran_setup));
 
 	/* Possible info that can be parsed in TLV style */
 	ep_ran_mac_sched_TLV * macs;
 
-	if(size < sizeof(ep_ran_setup)) {
-		ep_dbg_log(EP_DBG_2"F - RANS Rep: Not enough space!\n");
-		return -1;
-	}
-
 	s->layer1_cap = htonl(det->l1_mask);
 	s->layer2_cap = htonl(det->l2_mask);
 	s->layer3_cap = htonl(det->l3_mask);
 
-	c += sizeof(ep_ran_setup);
-
 	/* TLV for MAC scheduler information */
 	if(det->l2.mac.slice_sched != EP_RAN_SCHED_INVALID) {
-		if(c + sizeof(ep_ran_mac_sched_TLV) > buf + size) {
-			ep_dbg_log(EP_DBG_3"F - RANS Rep: Not enough space!\n");
-			return -1;
-		}
-
-		macs  = (ep_ran_mac_sched_TLV *)c;
+		macs  = (ep_ran_mac_sched_TLV *)ep_w_put(
+			w, sizeof(ep_ran_mac_sched_TLV));
 
 		macs->header.type      = htons(EP_TLV_RAN_MAC_SCHED);
 		macs->header.length    = htons(sizeof(ep_ran_mac_sched));
 		macs->body.slice_sched = htonl(det->l2.mac.slice_sched);
-
-		c += sizeof(ep_ran_mac_sched_TLV);
 	}
 
-	ep_dbg_dump(EP_DBG_2"F - RANS Rep: ", buf, c - buf);
-
-	return c - buf;
+	ep_dbg_dump(EP_DBG_2"F - RANS Rep: ", 
+		(char *)s, (w->buf + w->pos) - (char *)s);
 }
 
 /* Parse EPQ, sEtup Unspecified rePLy, TLV entries. 
@@ -304,8 +364,8 @@ int epp_ran_eup(char * buf, unsigned int size, ep_ran_det * det)
 		/* Reading next TLV token will overflow the buffer? */
 		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
 			ep_dbg_log(EP_DBG_3"P - RANS Rep: TLV %d > %d\n",
-				ntohs(sizeof(ep_TLV)) + ntohs(tlv->length),
-				(buf + size) - c);
+				(int)(sizeof(ep_TLV) + ntohs(tlv->length)),
+				(int)((buf + size) - c));
 			break;
 		}
 
@@ -324,23 +384,15 @@ int epp_ran_eup(char * buf, unsigned int size, ep_ran_det * det)
  * 
  */
 
-/* Format SUQ, Slice Unspecified reQuest 
- * Returns the size in bytes of the formatted area.
- */
-int epf_ran_suq(char * buf, unsigned int size, slice_id_t id)
+/* Format SUQ, Slice Unspecified reQuest */
+void epf_ran_suq_w(ep_writer * w, slice_id_t id)
 {
-	ep_ran_sinf * r = (ep_ran_sinf *)buf;
-
-	if(size < sizeof(ep_ran_sinf)) {
-		ep_dbg_log(EP_DBG_2"F - RANS Unspec Req: Not enough space!\n");
-		return -1;
-	}
+	ep_ran_sinf * r = (ep_ran_sinf *)ep_w_put(w, sizeof(ep_ran_sinf));
 
 	r->id = htobe64(id);
 
-	ep_dbg_dump(EP_DBG_2"F - RANS Unspec Req: ", buf, sizeof(ep_ran_sinf));
-
-	return sizeof(ep_ran_sinf);
+	ep_dbg_dump(EP_DBG_2"F - RANS Unspec Req: ", 
+		(char *)r, sizeof(ep_ran_sinf));
 }
 
 /* Parse SUQ, Slice Unspecified reQuest 
@@ -366,27 +418,20 @@ int epp_ran_suq(char * buf, unsigned int size, slice_id_t * id)
 
 /* Format SUP, Slice Unspecified rePly.
  * This message formats a single slice with its details.
- * Returns the size in bytes of the formatted area.
  */
-int epf_ran_sup(
-	char * buf, unsigned int size, slice_id_t id, ep_ran_slice_det * det) 
+void epf_ran_sup_w(ep_writer * w, slice_id_t id, ep_ran_slice_det * det)
 {
-	int           s = sizeof(slice_id_t);
-	ep_ran_sinf * r = (ep_ran_sinf *) buf;
+	ep_ran_sinf * r = (ep_ran_sinf *)ep_w_put(w, sizeof(ep_ran_sinf));
 
 	r->id = htobe64(id);
-	
-	ep_dbg_dump(EP_DBG_2"F - RANS Unspec Rep: ", buf, sizeof(ep_ran_sinf));
+
+	ep_dbg_dump(EP_DBG_2"F - RANS Unspec Rep: ", 
+		(char *)r, sizeof(ep_ran_sinf));
 
 	/* Time to check if to create TLVs for additional options */
 	if(det) {
-		s += epf_ran_TLV(
-			buf + sizeof(ep_ran_sinf),
-			size - sizeof(ep_ran_sinf),
-			det);
+		epf_ran_TLV_w(w, det);
 	}
-
-	return s;
 }
 
 /* Parses SUP, Slice Unspecified rePly.
@@ -417,8 +462,8 @@ int epp_ran_sup(
 		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
 			ep_dbg_log(
 				EP_DBG_3"P - RANS Rep: TLV size %d > %d\n",
-				ntohs(sizeof(ep_TLV)) + ntohs(tlv->length),
-				(buf + size) - c);
+				(int)(sizeof(ep_TLV) + ntohs(tlv->length)),
+				(int)((buf + size) - c));
 
 			break;
 		}
@@ -433,32 +478,19 @@ int epp_ran_sup(
 	return EP_SUCCESS;
 }
 
-/* Format SAQ, Slice Add reQuest.
- * Returns the size in bytes of the formatted area.
- */
-int epf_ran_saq(
-	char * buf, unsigned int size, slice_id_t id, ep_ran_slice_det * det)
+/* Format SAQ, Slice Add reQuest */
+void epf_ran_saq_w(ep_writer * w, slice_id_t id, ep_ran_slice_det * det)
 {
-	int           s = sizeof(ep_ran_sinf);
-	ep_ran_sinf * r = (ep_ran_sinf *)buf;
-
-	if(size < sizeof(ep_ran_sinf)) {
-		ep_dbg_log(EP_DBG_2"F - RANS Add Req: Not enough space!\n");
-		return -1;
-	}
+	ep_ran_sinf * r = (ep_ran_sinf *)ep_w_put(w, sizeof(ep_ran_sinf));
 
 	r->id = htobe64(id);
 
-	ep_dbg_dump(EP_DBG_2"F - RANS Add Req: ", buf, sizeof(ep_ran_sinf));
+	ep_dbg_dump(EP_DBG_2"F - RANS Add Req: ", 
+		(char *)r, sizeof(ep_ran_sinf));
 
 	if(det) {
-		s += epf_ran_TLV(
-			buf + sizeof(ep_ran_sinf), 
-			size - sizeof(ep_ran_sinf),
-			det);
+		epf_ran_TLV_w(w, det);
 	}
-
-	return s;
 }
 
 /* Parse SAQ, Slice Add reQuest.
@@ -488,8 +520,8 @@ int epp_ran_saq(
 		/* Reading next TLV token will overflow the buffer? */
 		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
 			ep_dbg_log(EP_DBG_3"P - RANS Add Req: TLV %d > %d\n",
-				ntohs(sizeof(ep_TLV)) + ntohs(tlv->length),
-				(buf + size) - c);
+				(int)(sizeof(ep_TLV) + ntohs(tlv->length)),
+				(int)((buf + size) - c));
 			break;
 		}
 
@@ -505,23 +537,15 @@ int epp_ran_saq(
 	return EP_SUCCESS;
 }
 
-/* Format SRQ, Slice Rem reQuest.
- * Returns the size in bytes of the formatted area.
- */
-int epf_ran_srq(char * buf, unsigned int size, slice_id_t id) 
+/* Format SRQ, Slice Rem reQuest */
+void epf_ran_srq_w(ep_writer * w, slice_id_t id)
 {
-	ep_ran_sinf * r = (ep_ran_sinf *)buf;
-
-	if(size < sizeof(ep_ran_sinf)) {
-		ep_dbg_log(EP_DBG_2"F - RANS Rem Req: Not enough space!\n");
-		return -1;
-	}
+	ep_ran_sinf * r = (ep_ran_sinf *)ep_w_put(w, sizeof(ep_ran_sinf));
 
 	r->id = htobe64(id);
 
-	ep_dbg_dump(EP_DBG_2"F - RANS Rem Req: ", buf, sizeof(ep_ran_sinf));
-
-	return sizeof(ep_ran_sinf);
+	ep_dbg_dump(EP_DBG_2"F - RANS Rem Req: ", 
+		(char *)r, sizeof(ep_ran_sinf));
 }
 
 /* Parse SRQ, Slice Rem reQuest.
@@ -545,32 +569,19 @@ int epp_ran_srq(char * buf, unsigned int size, slice_id_t * id)
 	return EP_SUCCESS;
 }
 
-/* Format SSQ, Slice Set reQuest.
- * Returns the size in bytes of the formatted area.
- */
-int epf_ran_ssq(
-	char * buf, unsigned int size, slice_id_t id, ep_ran_slice_det * det) 
+/* Format SSQ, Slice Set reQuest */
+void epf_ran_ssq_w(ep_writer * w, slice_id_t id, ep_ran_slice_det * det)
 {
-	int           s = sizeof(ep_ran_sinf);
-	ep_ran_sinf * r = (ep_ran_sinf *)buf;
-
-	if(size < sizeof(ep_ran_sinf)) {
-		ep_dbg_log(EP_DBG_2"F - RANS Set Req: Not enough space!\n");
-		return -1;
-	}
+	ep_ran_sinf * r = (ep_ran_sinf *)ep_w_put(w, sizeof(ep_ran_sinf));
 
 	r->id = htobe64(id);
 
-	ep_dbg_dump(EP_DBG_2"F - RANS Set Req: ", buf, sizeof(ep_ran_sinf));
+	ep_dbg_dump(EP_DBG_2"F - RANS Set Req: ", 
+		(char *)r, sizeof(ep_ran_sinf));
 
 	if(det) {
-		s+= epf_ran_TLV(
-			buf + sizeof(ep_ran_sinf),
-			size - sizeof(ep_ran_sinf),
-			det);
+		epf_ran_TLV_w(w, det);
 	}
-
-	return s;
 }
 
 /* Parse SRQ, Slice Set reQuest.
@@ -602,8 +613,8 @@ int epp_ran_ssq(
 		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
 			ep_dbg_log(
 				EP_DBG_3"P - RANS Set Size: TLV %d > %d\n",
-				ntohs(sizeof(ep_TLV)) +  ntohs(tlv->length),
-				(buf + size) - c);
+				(int)(sizeof(ep_TLV) + ntohs(tlv->length)),
+				(int)((buf + size) - c));
 			break;
 		}
 
@@ -617,231 +628,583 @@ int epp_ran_ssq(
 	return EP_SUCCESS;
 }
 
-/******************************************************************************
- * Public API                                                                 *
- ******************************************************************************/
+/* Size of a Slice info followed by its details, as formatted by
+ * epf_ran_sinf_l_w().
+ */
+unsigned int epf_ran_sinf_size(ep_ran_slice_ldet * det)
+{
+	return sizeof(ep_ran_sinf) + (det ? epf_ran_TLV_size(det) : 0);
+}
 
-int epf_single_ran_rep_success(
-	char *       buf,
-	unsigned int size,
-	ep_act_type  type,
-	enb_id_t     enb_id,
-	cell_id_t    cell_id,
-	mod_id_t     mod_id)
+/* Size of a Slice info followed by its details, with at most
+ * EP_RAN_USERS_MAX users as for epf_ran_sup_w(), epf_ran_saq_w() and
+ * epf_ran_ssq_w().
+ */
+unsigned int epf_ran_sinf_det_size(ep_ran_slice_det * det)
 {
-	int ms = 0;
-	int ret= 0;
-	/* Check of given buffer size here */
+	ep_ran_slice_ldet l;
 
-	if(!buf) {
-		ep_dbg_log(EP_DBG_2"F - Single RAN Fail: Invalid buffer!\n");
-		return -1;
+	if(!det) {
+		return sizeof(ep_ran_sinf);
 	}
 
-	ms = epf_head(
-		buf, 
-		size, 
-		EP_TYPE_SINGLE_MSG, 
-		enb_id, 
-		cell_id, 
-		mod_id,
-		EP_HDR_FLAG_DIR_REP);
-
-	if(ms < 0) {
-		return ms;
-	}
+	l.nof_users = det->nof_users < EP_RAN_USERS_MAX ?
+		det->nof_users : EP_RAN_USERS_MAX;
+	l.users     = det->users;
+	l.l2        = det->l2;
 
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		type,
-		EP_OPERATION_SUCCESS);
+	return epf_ran_sinf_size(&l);
+}
 
-	if(ms < 0) {
-		return ms;
-	}
+/* Format a Slice info followed by its details, with users listed in an array
+ * of any length. Used by add, set and reply messages.
+ */
+void epf_ran_sinf_l_w(ep_writer * w, slice_id_t id, ep_ran_slice_ldet * det)
+{
+	ep_ran_sinf * r = (ep_ran_sinf *)ep_w_put(w, sizeof(ep_ran_sinf));
 
-	ret += ms;
+	r->id = htobe64(id);
 
-	/* Inject the message size */
-	epf_msg_length(buf, size, ret);
+	ep_dbg_dump(EP_DBG_2"F - RANS Info: ", (char *)r, sizeof(ep_ran_sinf));
 
-	return ret;
+	if(det) {
+		epf_ran_TLV_l_w(w, det);
+	}
 }
 
-int epf_single_ran_rep_fail(
-	char *       buf,
-	unsigned int size,
-	ep_act_type  type,
-	enb_id_t     enb_id,
-	cell_id_t    cell_id,
-	mod_id_t     mod_id,
-	slice_id_t   slice_id)
+/* Parse the TLVs with the details of a slice into a view.
+ * Returns the SUCCESS/FAILED error codes.
+ */
+int epp_ran_sdet_view(char * buf, unsigned int size, ep_ran_slice_view * view)
 {
-	int          ms = 0;
-	int          ret= 0;
+	char *   c = buf;
+	ep_TLV * tlv;
 
-	slice_id_t * s;
-	/* Check of given buffer size here */
-
-	if(!buf) {
-		ep_dbg_log(EP_DBG_2"F - Single RAN Fail: Invalid buffer!\n");
-		return -1;
-	}
+	view->nof_users = 0;
+	view->users     = 0;
+	view->l2.usched = 0;
+	view->l2.rbgs   = 0;
 
-	ms = epf_head(
-		buf, 
-		size, 
-		EP_TYPE_SINGLE_MSG, 
-		enb_id, 
-		cell_id, 
-		mod_id,
-		EP_HDR_FLAG_DIR_REP);
+	while(c + sizeof(ep_TLV) <= buf + size) {
+		tlv = (ep_TLV *)c;
 
-	if(ms < 0) {
-		return ms;
-	}
+		/* Reading next TLV token will overflow the buffer? */
+		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
+			ep_dbg_log(EP_DBG_3"P - RANS Det: TLV %d > %d\n",
+				(int)(sizeof(ep_TLV) + ntohs(tlv->length)),
+				(int)((buf + size) - c));
+			return EP_ERROR;
+		}
 
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		type,
-		EP_OPERATION_FAIL);
+		if(epp_ran_TLV_view(c, view)) {
+			return EP_ERROR;
+		}
 
-	if(ms < 0) {
-		return ms;
+		c += sizeof(ep_TLV) + ntohs(tlv->length);
 	}
 
-	ret += ms;
+	return EP_SUCCESS;
+}
 
-	if(ret + sizeof(uint64_t) > size) {
-		ep_dbg_log(EP_DBG_2"F - Single RAN Fail: No space!\n");
-		return -1;
-	}
+/* Parse a Slice info followed by its details into a view.
+ * Returns the SUCCESS/FAILED error codes.
+ */
+int epp_ran_sinf_view(
+	char * buf, unsigned int size, slice_id_t * id, ep_ran_slice_view * view)
+{
+	ep_ran_sinf * r = (ep_ran_sinf *)buf;
 
-	s = (slice_id_t *)(buf + ret);
-	*s = htobe64(slice_id);
+	if(size < sizeof(ep_ran_sinf)) {
+		ep_dbg_log(EP_DBG_2"P - RANS Info: Not enough space!\n");
+		return EP_ERROR;
+	}
 
-	ret += sizeof(uint64_t);
+	if(id) {
+		*id = be64toh(r->id);
+	}
 
-	ep_dbg_log(EP_DBG_2"F - Single RAN Fail: % " PRIu64 "\n", slice_id);
+	ep_dbg_dump(EP_DBG_2"P - RANS Info: ", buf, sizeof(ep_ran_sinf));
 
-	/* Inject the message size */
-	epf_msg_length(buf, size, ret);
+	if(!view) {
+		return EP_SUCCESS;
+	}
 
-	return ret;
+	return epp_ran_sdet_view(
+		buf + sizeof(ep_ran_sinf), size - sizeof(ep_ran_sinf), view);
 }
 
-int epf_single_ran_rep_ns(
-	char *       buf,
-	unsigned int size,
-	ep_act_type  type,
-	enb_id_t     enb_id,
-	cell_id_t    cell_id,
-	mod_id_t     mod_id,
-	slice_id_t   slice_id)
+/* Format a single-event Slice message with users listed in an array of any
+ * length.
+ * Returns the message size or -1 on error.
+ */
+static int epf_single_ran_slice_l(
+	char *              buf,
+	unsigned int        size,
+	enb_id_t            enb_id,
+	cell_id_t           cell_id,
+	mod_id_t            mod_id,
+	uint16_t            dir,
+	ep_op_type          op,
+	slice_id_t          slice_id,
+	ep_ran_slice_ldet * det)
 {
-	int ms = 0;
-	int ret= 0 ;
-	/* Check of given buffer size here */
+	ep_writer w;
 
-	if(!buf) {
-		ep_dbg_log(EP_DBG_2"F - Single RAN NS: Invalid buffer!\n");
+	if(!buf || !det) {
+		ep_dbg_log(EP_DBG_2"F - Single RANT L: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
-		EP_TYPE_SINGLE_MSG,
-		enb_id,
-		cell_id,
-		mod_id,
-		EP_HDR_FLAG_DIR_REP);
+	ep_w_init(&w, buf, size);
 
-	if(ms < 0) {
-		return ms;
+	if(ep_w_need(&w, EP_SINGLE_HDR_SIZE + epf_ran_sinf_size(det))) {
+		ep_dbg_log(EP_DBG_2"F - Single RANT L: Not enough space!\n");
+		return -1;
 	}
 
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		type,
-		EP_OPERATION_NOT_SUPPORTED);
+	epf_head_w(&w, EP_TYPE_SINGLE_MSG, enb_id, cell_id, mod_id, dir);
+	epf_single_w(&w, EP_ACT_RAN_SLICE, op);
+	epf_ran_sinf_l_w(&w, slice_id, det);
 
-	if(ms < 0) {
-		return ms;
-	}
+	return epf_msg_end_w(&w);
+}
 
-	ret += ms;
+/* Parse a single-event Slice message into a view.
+ * Returns EP_SUCCESS on success, otherwise a negative error code.
+ */
+static int epp_single_ran_slice_view(
+	char *              buf,
+	unsigned int        size,
+	slice_id_t *        slice_id,
+	ep_ran_slice_view * view)
+{
+	if(!buf) {
+		ep_dbg_log(EP_DBG_2"P - Single RANT View: Invalid buffer!\n");
+		return EP_ERROR;
+	}
 
-	/* Inject the message size */
-	epf_msg_length(buf, size, ret);
+	if(size < sizeof(ep_hdr) + sizeof(ep_s_hdr)) {
+		ep_dbg_log(EP_DBG_2"P - Single RANT View: Not enough space!\n");
+		return EP_ERROR;
+	}
 
-	return ret;
+	return epp_ran_sinf_view(
+		buf  +  sizeof(ep_hdr) + sizeof(ep_s_hdr),
+		size - (sizeof(ep_hdr) + sizeof(ep_s_hdr)),
+		slice_id,
+		view);
 }
 
-/*
- * 
- * Parser public procedures for RAN Setup messages
- * 
+/* Parse a single-event Slice message, copying its users in an arena.
+ * Returns EP_SUCCESS on success, otherwise a negative error code.
  */
-
-int epf_single_ran_setup_req(
-	char *       buf,
-	unsigned int size,
-	enb_id_t     enb_id,
-	cell_id_t    cell_id,
-	mod_id_t     mod_id)
+static int epp_single_ran_slice_a(
+	char *              buf,
+	unsigned int        size,
+	ep_arena *          arena,
+	slice_id_t *        slice_id,
+	ep_ran_slice_ldet * det)
 {
-	int ms = 0;
-	int ret= 0 ;
+	ep_ran_slice_view v;
+	uint32_t          i;
 
-	if(!buf) {
-		ep_dbg_log(EP_DBG_2"F - Single RANS Req: Invalid buffer!\n");
-		return -1;
+	if(!arena || !det) {
+		ep_dbg_log(EP_DBG_2"P - Single RANT Arena: Invalid pointer!\n");
+		return EP_ERROR;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
-		EP_TYPE_SINGLE_MSG,
-		enb_id,
-		cell_id,
-		mod_id,
-		EP_HDR_FLAG_DIR_REQ);
-
-	if(ms < 0) {
-		return ms;
+	if(epp_single_ran_slice_view(buf, size, slice_id, &v)) {
+		return EP_ERROR;
 	}
 
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_RAN_SETUP,
-		EP_OPERATION_UNSPECIFIED);
+	det->nof_users = v.nof_users;
+	det->users     = 0;
+	det->l2        = v.l2;
 
-	if(ms < 0) {
-		return ms;
+	if(!v.nof_users) {
+		return EP_SUCCESS;
 	}
 
-	ret += ms;
-	ms   = epf_ran_euq(buf + ret, size - ret);
+	det->users = ep_arena_alloc(arena, v.nof_users * sizeof(rnti_id_t));
 
-	if(ms < 0) {
-		return ms;
+	if(!det->users) {
+		return EP_ERROR;
 	}
 
-	ret += ms;
+	for(i = 0; i < v.nof_users; i++) {
+		det->users[i] = ep_ran_slice_user(&v, i);
+	}
 
-	/* Inject the message size */
-	epf_msg_length(buf, size, ret);
+	return EP_SUCCESS;
+}
+
+/* Size of SBQ, Slice Bulk reQuest, as formatted by epf_ran_sbq_w() */
+unsigned int epf_ran_sbq_size(uint16_t nof, ep_ran_sblk_det * ops)
+{
+	unsigned int s = sizeof(ep_ran_sblk) + nof * sizeof(ep_ran_sblk_op);
+	int          i;
+
+	for(i = 0; ops && i < nof; i++) {
+		/* Removal carries no details */
+		if(ops[i].op != EP_OPERATION_REM) {
+			s += epf_ran_TLV_size(&ops[i].det);
+		}
+	}
+
+	return s;
+}
+
+/* Format SBQ, Slice Bulk reQuest */
+void epf_ran_sbq_w(ep_writer * w, uint16_t nof, ep_ran_sblk_det * ops)
+{
+	ep_ran_sblk *    b;
+	ep_ran_sblk_op * o;
+	unsigned int     p;
+	int              i;
+
+	if(nof > 0 && !ops) {
+		ep_dbg_log(EP_DBG_2"F - RANS Bulk Req: Invalid operations!\n");
+		ep_w_fail(w);
+		return;
+	}
+
+	b = (ep_ran_sblk *)ep_w_put(w, sizeof(ep_ran_sblk));
+
+	b->nof_slices = htons(nof);
+
+	for(i = 0; i < nof; i++) {
+		o = (ep_ran_sblk_op *)ep_w_put(w, sizeof(ep_ran_sblk_op));
+
+		o->id = htobe64(ops[i].id);
+		o->op = (uint8_t)ops[i].op;
+		p     = w->pos;
+
+		/* Removal carries no details */
+		if(ops[i].op != EP_OPERATION_REM) {
+			epf_ran_TLV_l_w(w, &ops[i].det);
+		}
+
+		o->length = htons(w->pos - p);
+	}
+
+	ep_dbg_dump(EP_DBG_2"F - RANS Bulk Req: ", 
+		(char *)b, (w->buf + w->pos) - (char *)b);
+}
+
+/* Parse SBQ, Slice Bulk reQuest.
+ * Returns the SUCCESS/FAILED error codes.
+ */
+int epp_ran_sbq(
+	char *             buf,
+	unsigned int       size,
+	uint16_t *         nof,
+	uint16_t           max,
+	ep_ran_sblk_view * ops)
+{
+	char *           c = buf + sizeof(ep_ran_sblk);
+	ep_ran_sblk *    b = (ep_ran_sblk *)buf;
+	ep_ran_sblk_op * o;
+	uint16_t         n;
+	int              i;
+
+	if(size < sizeof(ep_ran_sblk)) {
+		ep_dbg_log(EP_DBG_2"P - RANS Bulk Req: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	n = ntohs(b->nof_slices);
+
+	for(i = 0; i < n; i++) {
+		o = (ep_ran_sblk_op *)c;
+
+		if(c + sizeof(ep_ran_sblk_op) > buf + size ||
+			c + sizeof(ep_ran_sblk_op) + ntohs(o->length) >
+				buf + size)
+		{
+			ep_dbg_log(EP_DBG_2"P - RANS Bulk Req: Not enough space!\n");
+			return EP_ERROR;
+		}
+
+		if(ops && i < max) {
+			ops[i].id = be64toh(o->id);
+			ops[i].op = (ep_op_type)o->op;
+
+			if(epp_ran_sdet_view(
+				c + sizeof(ep_ran_sblk_op),
+				ntohs(o->length),
+				&ops[i].det))
+			{
+				return EP_ERROR;
+			}
+		}
+
+		c += sizeof(ep_ran_sblk_op) + ntohs(o->length);
+	}
+
+	if(nof) {
+		*nof = n;
+	}
+
+	ep_dbg_dump(EP_DBG_2"P - RANS Bulk Req: ", buf, c - buf);
+
+	return EP_SUCCESS;
+}
+
+/* Size of SBP, Slice Bulk rePly, as formatted by epf_ran_sbp_w() */
+unsigned int epf_ran_sbp_size(uint16_t nof)
+{
+	return sizeof(ep_ran_sblk) + nof * sizeof(ep_ran_sblk_res);
+}
+
+/* Format SBP, Slice Bulk rePly */
+void epf_ran_sbp_w(ep_writer * w, uint16_t nof, ep_ran_sblk_out * outs)
+{
+	ep_ran_sblk *     b;
+	ep_ran_sblk_res * r;
+	int               i;
+
+	if(nof > 0 && !outs) {
+		ep_dbg_log(EP_DBG_2"F - RANS Bulk Rep: Invalid outcomes!\n");
+		ep_w_fail(w);
+		return;
+	}
+
+	b = (ep_ran_sblk *)ep_w_put(w, sizeof(ep_ran_sblk));
+	r = (ep_ran_sblk_res *)ep_w_put(w, nof * sizeof(ep_ran_sblk_res));
+
+	b->nof_slices = htons(nof);
+
+	for(i = 0; i < nof; i++) {
+		r[i].id     = htobe64(outs[i].id);
+		r[i].result = (uint8_t)outs[i].result;
+	}
 
-	return ret;
+	ep_dbg_dump(
+		EP_DBG_2"F - RANS Bulk Rep: ",
+		(char *)b,
+		epf_ran_sbp_size(nof));
+}
+
+/* Parse SBP, Slice Bulk rePly.
+ * Returns the SUCCESS/FAILED error codes.
+ */
+int epp_ran_sbp(
+	char *            buf,
+	unsigned int      size,
+	uint16_t *        nof,
+	uint16_t          max,
+	ep_ran_sblk_out * outs)
+{
+	ep_ran_sblk *     b = (ep_ran_sblk *)buf;
+	ep_ran_sblk_res * r = (ep_ran_sblk_res *)(buf + sizeof(ep_ran_sblk));
+	uint16_t          n;
+	int               i;
+
+	if(size < sizeof(ep_ran_sblk)) {
+		ep_dbg_log(EP_DBG_2"P - RANS Bulk Rep: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	n = ntohs(b->nof_slices);
+
+	if(size < sizeof(ep_ran_sblk) + (n * sizeof(ep_ran_sblk_res))) {
+		ep_dbg_log(EP_DBG_2"P - RANS Bulk Rep: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	if(nof) {
+		*nof = n;
+	}
+
+	for(i = 0; outs && i < n && i < max; i++) {
+		outs[i].id     = be64toh(r[i].id);
+		outs[i].result = (ep_op_type)r[i].result;
+	}
+
+	ep_dbg_dump(
+		EP_DBG_2"P - RANS Bulk Rep: ",
+		buf,
+		sizeof(ep_ran_sblk) + (n * sizeof(ep_ran_sblk_res)));
+
+	return EP_SUCCESS;
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+int epf_single_ran_rep_success(
+	char *       buf,
+	unsigned int size,
+	ep_act_type  type,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id)
+{
+	ep_writer w;
+
+	/* Check of given buffer size here */
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_2"F - Single RAN Fail: Invalid buffer!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_rep_success_size())) {
+		ep_dbg_log(EP_DBG_2"F - Single RAN Fail: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, type, EP_OPERATION_SUCCESS);
+
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_single_ran_rep_success_size(void)
+{
+	return EP_SINGLE_HDR_SIZE;
+}
+
+int epf_single_ran_rep_fail(
+	char *       buf,
+	unsigned int size,
+	ep_act_type  type,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	slice_id_t   slice_id)
+{
+	ep_writer    w;
+	slice_id_t * s;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_2"F - Single RAN Fail: Invalid buffer!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_rep_fail_size())) {
+		ep_dbg_log(EP_DBG_2"F - Single RAN Fail: No space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, type, EP_OPERATION_FAIL);
+
+	s  = (slice_id_t *)ep_w_put(&w, sizeof(uint64_t));
+	*s = htobe64(slice_id);
+
+	ep_dbg_log(EP_DBG_2"F - Single RAN Fail: %" PRIu64 "\n", slice_id);
+
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_single_ran_rep_fail_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(uint64_t);
+}
+
+int epf_single_ran_rep_ns(
+	char *       buf,
+	unsigned int size,
+	ep_act_type  type,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	slice_id_t   slice_id)
+{
+	ep_writer w;
+
+	/* Check of given buffer size here */
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_2"F - Single RAN NS: Invalid buffer!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_rep_ns_size())) {
+		ep_dbg_log(EP_DBG_2"F - Single RAN NS: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, type, EP_OPERATION_NOT_SUPPORTED);
+
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_single_ran_rep_ns_size(void)
+{
+	return EP_SINGLE_HDR_SIZE;
+}
+
+/*
+ * 
+ * Parser public procedures for RAN Setup messages
+ * 
+ */
+
+int epf_single_ran_setup_req(
+	char *       buf,
+	unsigned int size,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id)
+{
+	ep_writer w;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_2"F - Single RANS Req: Invalid buffer!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_setup_req_size())) {
+		ep_dbg_log(EP_DBG_2"F - Single RANS Req: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REQ);
+	epf_single_w(&w, EP_ACT_RAN_SETUP, EP_OPERATION_UNSPECIFIED);
+	epf_ran_euq_w(&w);
+
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_single_ran_setup_req_size(void)
+{
+	return EP_SINGLE_HDR_SIZE;
 }
 
 int epp_single_ran_setup_req(
@@ -866,54 +1229,36 @@ int epf_single_ran_setup_rep(
 	mod_id_t     mod_id,
 	ep_ran_det * det)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf || !det) {
 		ep_dbg_log(EP_DBG_2"F - Single RAN Rep: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_setup_rep_size(det))) {
+		ep_dbg_log(EP_DBG_2"F - Single RAN Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_RAN_SETUP, EP_OPERATION_UNSPECIFIED);
+	epf_ran_eup_w(&w, det);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_RAN_SETUP,
-		EP_OPERATION_UNSPECIFIED);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ran_eup(
-		buf + ret,
-		size - ret,
-		det);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	/* Inject the message size */
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ran_setup_rep_size(ep_ran_det * ran)
+{
+	return EP_SINGLE_HDR_SIZE + (ran ? epf_ran_eup_size(ran) : 0);
 }
 
 int epp_single_ran_setup_rep(
@@ -946,54 +1291,36 @@ int epf_single_ran_slice_req(
 	mod_id_t           mod_id,
 	slice_id_t         slice_id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_2"F - Single RANT Req: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_slice_req_size())) {
+		ep_dbg_log(EP_DBG_2"F - Single RANT Req: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
+	epf_single_w(&w, EP_ACT_RAN_SLICE, EP_OPERATION_UNSPECIFIED);
+	epf_ran_suq_w(&w, slice_id);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_RAN_SLICE,
-		EP_OPERATION_UNSPECIFIED);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ran_suq(
-		buf + ret,
-		size - ret,
-		slice_id);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	/* Inject the message size */
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ran_slice_req_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_ran_sinf);
 }
 
 int epp_single_ran_slice_req(
@@ -1021,55 +1348,36 @@ int epf_single_ran_slice_rep(
 	slice_id_t         slice_id,
 	ep_ran_slice_det * det)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf || !det) {
 		ep_dbg_log(EP_DBG_2"F - Single RANT Rep: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_slice_rep_size(det))) {
+		ep_dbg_log(EP_DBG_2"F - Single RANT Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_RAN_SLICE, EP_OPERATION_UNSPECIFIED);
+	epf_ran_sup_w(&w, slice_id, det);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_RAN_SLICE,
-		EP_OPERATION_UNSPECIFIED);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ran_sup(
-		buf + ret,
-		size - ret,
-		slice_id,
-		det);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	/* Inject the message size */
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ran_slice_rep_size(ep_ran_slice_det * det)
+{
+	return EP_SINGLE_HDR_SIZE + epf_ran_sinf_det_size(det);
 }
 
 int epp_single_ran_slice_rep(
@@ -1099,55 +1407,36 @@ int epf_single_ran_slice_add(
 	slice_id_t         slice_id,
 	ep_ran_slice_det * det)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf || !det) {
 		ep_dbg_log(EP_DBG_2"F - Single RANT Add: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_slice_add_size(det))) {
+		ep_dbg_log(EP_DBG_2"F - Single RANT Add: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
+	epf_single_w(&w, EP_ACT_RAN_SLICE, EP_OPERATION_ADD);
+	epf_ran_saq_w(&w, slice_id, det);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_RAN_SLICE,
-		EP_OPERATION_ADD);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ran_saq(
-		buf + ret, 
-		size - ret, 
-		slice_id, 
-		det);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	/* Inject the message size */
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ran_slice_add_size(ep_ran_slice_det * det)
+{
+	return EP_SINGLE_HDR_SIZE + epf_ran_sinf_det_size(det);
 }
 
 int epp_single_ran_slice_add(
@@ -1176,54 +1465,36 @@ int epf_single_ran_slice_rem(
 	mod_id_t           mod_id,
 	slice_id_t         slice_id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log("F - Single RANT Rem: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_slice_rem_size())) {
+		ep_dbg_log("F - Single RANT Rem: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
+	epf_single_w(&w, EP_ACT_RAN_SLICE, EP_OPERATION_REM);
+	epf_ran_srq_w(&w, slice_id);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_RAN_SLICE,
-		EP_OPERATION_REM);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ran_srq(
-		buf + ret, 
-		size - ret, 
-		slice_id);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	/* Inject the message size */
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ran_slice_rem_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_ran_sinf);
 }
 
 int epp_single_ran_slice_rem(
@@ -1251,71 +1522,369 @@ int epf_single_ran_slice_set(
 	slice_id_t         slice_id,
 	ep_ran_slice_det * det)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_2"F - Single RANT Rem: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_slice_set_size(det))) {
+		ep_dbg_log(EP_DBG_2"F - Single RANT Rem: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
+	epf_single_w(&w, EP_ACT_RAN_SLICE, EP_OPERATION_SET);
+	epf_ran_ssq_w(&w, slice_id, det);
 
-	if(ms < 0) {
-		return ms;
-	}
+	return epf_msg_end_w(&w);
+}
 
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_RAN_SLICE,
-		EP_OPERATION_SET);
+unsigned int epf_single_ran_slice_set_size(ep_ran_slice_det * det)
+{
+	return EP_SINGLE_HDR_SIZE + epf_ran_sinf_det_size(det);
+}
 
-	if(ms < 0) {
-		return ms;
+int epp_single_ran_slice_set(
+	char *             buf,
+	unsigned int       size,
+	slice_id_t *       slice_id,
+	ep_ran_slice_det * det)
+{
+	if(!buf) {
+		ep_dbg_log("P - Single RANT Rem: Invalid buffer!\n");
+		return EP_ERROR;
 	}
 
-	ret += ms;
-	ms   = epf_ran_ssq(
-		buf + ret, 
-		size - ret, 
+	return epp_ran_ssq(
+		buf  +  sizeof(ep_hdr) + sizeof(ep_s_hdr),
+		size - (sizeof(ep_hdr) + sizeof(ep_s_hdr)),
+		slice_id,
+		det);
+}
+
+int epf_single_ran_slice_rep_l(
+	char *              buf,
+	unsigned int        size,
+	enb_id_t            enb_id,
+	cell_id_t           cell_id,
+	mod_id_t            mod_id,
+	slice_id_t          slice_id,
+	ep_ran_slice_ldet * det)
+{
+	return epf_single_ran_slice_l(
+		buf,
+		size,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REP,
+		EP_OPERATION_UNSPECIFIED,
+		slice_id,
+		det);
+}
+
+unsigned int epf_single_ran_slice_rep_l_size(ep_ran_slice_ldet * det)
+{
+	return EP_SINGLE_HDR_SIZE + epf_ran_sinf_size(det);
+}
+
+int epp_single_ran_slice_rep_view(
+	char *              buf,
+	unsigned int        size,
+	slice_id_t *        slice_id,
+	ep_ran_slice_view * view)
+{
+	return epp_single_ran_slice_view(buf, size, slice_id, view);
+}
+
+int epp_single_ran_slice_rep_a(
+	char *              buf,
+	unsigned int        size,
+	ep_arena *          arena,
+	slice_id_t *        slice_id,
+	ep_ran_slice_ldet * det)
+{
+	return epp_single_ran_slice_a(buf, size, arena, slice_id, det);
+}
+
+int epf_single_ran_slice_add_l(
+	char *              buf,
+	unsigned int        size,
+	enb_id_t            enb_id,
+	cell_id_t           cell_id,
+	mod_id_t            mod_id,
+	slice_id_t          slice_id,
+	ep_ran_slice_ldet * det)
+{
+	return epf_single_ran_slice_l(
+		buf,
+		size,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REQ,
+		EP_OPERATION_ADD,
+		slice_id,
+		det);
+}
+
+unsigned int epf_single_ran_slice_add_l_size(ep_ran_slice_ldet * det)
+{
+	return EP_SINGLE_HDR_SIZE + epf_ran_sinf_size(det);
+}
+
+int epp_single_ran_slice_add_view(
+	char *              buf,
+	unsigned int        size,
+	slice_id_t *        slice_id,
+	ep_ran_slice_view * view)
+{
+	return epp_single_ran_slice_view(buf, size, slice_id, view);
+}
+
+int epp_single_ran_slice_add_a(
+	char *              buf,
+	unsigned int        size,
+	ep_arena *          arena,
+	slice_id_t *        slice_id,
+	ep_ran_slice_ldet * det)
+{
+	return epp_single_ran_slice_a(buf, size, arena, slice_id, det);
+}
+
+int epf_single_ran_slice_set_l(
+	char *              buf,
+	unsigned int        size,
+	enb_id_t            enb_id,
+	cell_id_t           cell_id,
+	mod_id_t            mod_id,
+	slice_id_t          slice_id,
+	ep_ran_slice_ldet * det)
+{
+	return epf_single_ran_slice_l(
+		buf,
+		size,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REQ,
+		EP_OPERATION_SET,
 		slice_id,
 		det);
+}
 
-	if(ms < 0) {
-		return ms;
+unsigned int epf_single_ran_slice_set_l_size(ep_ran_slice_ldet * det)
+{
+	return EP_SINGLE_HDR_SIZE + epf_ran_sinf_size(det);
+}
+
+int epp_single_ran_slice_set_view(
+	char *              buf,
+	unsigned int        size,
+	slice_id_t *        slice_id,
+	ep_ran_slice_view * view)
+{
+	return epp_single_ran_slice_view(buf, size, slice_id, view);
+}
+
+int epp_single_ran_slice_set_a(
+	char *              buf,
+	unsigned int        size,
+	ep_arena *          arena,
+	slice_id_t *        slice_id,
+	ep_ran_slice_ldet * det)
+{
+	return epp_single_ran_slice_a(buf, size, arena, slice_id, det);
+}
+
+int epf_single_ran_slice_bulk_req(
+	char *            buf,
+	unsigned int      size,
+	enb_id_t          enb_id,
+	cell_id_t         cell_id,
+	mod_id_t          mod_id,
+	uint16_t          nof,
+	ep_ran_sblk_det * ops)
+{
+	ep_writer w;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_2"F - Single RANB Req: Invalid buffer!\n");
+		return -1;
 	}
 
-	ret += ms;
+	ep_w_init(&w, buf, size);
 
-	/* Inject the message size */
-	epf_msg_length(buf, size, ret);
+	if(ep_w_need(&w, epf_single_ran_slice_bulk_req_size(nof, ops))) {
+		ep_dbg_log(EP_DBG_2"F - Single RANB Req: Not enough space!\n");
+		return -1;
+	}
 
-	return ret;
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REQ);
+	epf_single_w(&w, EP_ACT_RAN_SLICE_BULK, EP_OPERATION_UNSPECIFIED);
+	epf_ran_sbq_w(&w, nof, ops);
+
+	return epf_msg_end_w(&w);
 }
 
-int epp_single_ran_slice_set(
+unsigned int epf_single_ran_slice_bulk_req_size(
+	uint16_t          nof,
+	ep_ran_sblk_det * ops)
+{
+	return EP_SINGLE_HDR_SIZE + epf_ran_sbq_size(nof, ops);
+}
+
+int epp_single_ran_slice_bulk_req(
 	char *             buf,
 	unsigned int       size,
-	slice_id_t *       slice_id,
-	ep_ran_slice_det * det)
+	uint16_t *         nof,
+	uint16_t           max,
+	ep_ran_sblk_view * ops)
 {
 	if(!buf) {
-		ep_dbg_log("P - Single RANT Rem: Invalid buffer!\n");
+		ep_dbg_log(EP_DBG_2"P - Single RANB Req: Invalid buffer!\n");
 		return EP_ERROR;
 	}
 
-	return epp_ran_ssq(
+	if(size < sizeof(ep_hdr) + sizeof(ep_s_hdr)) {
+		ep_dbg_log(EP_DBG_2"P - Single RANB Req: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	return epp_ran_sbq(
 		buf  +  sizeof(ep_hdr) + sizeof(ep_s_hdr),
 		size - (sizeof(ep_hdr) + sizeof(ep_s_hdr)),
-		slice_id,
-		det);
-}
\ No newline at end of file
+		nof,
+		max,
+		ops);
+}
+
+int epf_single_ran_slice_bulk_rep(
+	char *            buf,
+	unsigned int      size,
+	enb_id_t          enb_id,
+	cell_id_t         cell_id,
+	mod_id_t          mod_id,
+	uint16_t          nof,
+	ep_ran_sblk_out * outs)
+{
+	ep_writer  w;
+	int        i;
+	ep_op_type op = EP_OPERATION_SUCCESS;
+
+	/* Whole request succeeded only if every slice did */
+	for(i = 0; outs && i < nof; i++) {
+		if(outs[i].result != EP_OPERATION_SUCCESS) {
+			op = EP_OPERATION_FAIL;
+			break;
+		}
+	}
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_2"F - Single RANB Rep: Invalid buffer!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_slice_bulk_rep_size(nof))) {
+		ep_dbg_log(EP_DBG_2"F - Single RANB Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_RAN_SLICE_BULK, op);
+	epf_ran_sbp_w(&w, nof, outs);
+
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_single_ran_slice_bulk_rep_size(uint16_t nof)
+{
+	return EP_SINGLE_HDR_SIZE + epf_ran_sbp_size(nof);
+}
+
+int epf_single_ran_slice_bulk_rep_ns(
+	char *            buf,
+	unsigned int      size,
+	enb_id_t          enb_id,
+	cell_id_t         cell_id,
+	mod_id_t          mod_id)
+{
+	ep_writer w;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_2"F - Single RANB NS: Invalid buffer!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ran_slice_bulk_rep_ns_size())) {
+		ep_dbg_log(EP_DBG_2"F - Single RANB NS: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_RAN_SLICE_BULK, EP_OPERATION_NOT_SUPPORTED);
+
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_single_ran_slice_bulk_rep_ns_size(void)
+{
+	return EP_SINGLE_HDR_SIZE;
+}
+
+int epp_single_ran_slice_bulk_rep(
+	char *            buf,
+	unsigned int      size,
+	uint16_t *        nof,
+	uint16_t          max,
+	ep_ran_sblk_out * outs)
+{
+	if(!buf) {
+		ep_dbg_log(EP_DBG_2"P - Single RANB Rep: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(size < sizeof(ep_hdr) + sizeof(ep_s_hdr)) {
+		ep_dbg_log(EP_DBG_2"P - Single RANB Rep: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	return epp_ran_sbp(
+		buf  +  sizeof(ep_hdr) + sizeof(ep_s_hdr),
+		size - (sizeof(ep_hdr) + sizeof(ep_s_hdr)),
+		nof,
+		max,
+		outs);
+}
@@ -0,0 +1,416 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_ACT(EP_ACT_ECAP)
+
+#include <emproto.h>
+
+/* Allocate a new capabilities record, with one reference */
+static ep_caps * ep_caps_new(enb_id_t enb_id, uint32_t nof_cells)
+{
+	ep_caps * caps;
+
+	caps = malloc(sizeof(ep_caps) + nof_cells * sizeof(ep_cell_det));
+
+	if(!caps) {
+		ep_dbg_log(EP_DBG_0"CAPC: Not enough memory!\n");
+		return 0;
+	}
+
+	caps->refs      = 1;
+	caps->enb_id    = enb_id;
+	caps->hash      = EP_HELLO_NO_HASH;
+	caps->capmask   = 0;
+	caps->nof_cells = nof_cells;
+
+	return caps;
+}
+
+/* Read the capabilities of a cell from its TLV body */
+static void ep_capc_cell(ep_ccap_rep * ccap, ep_cell_det * cell)
+{
+	cell->pci       = ntohs(ccap->pci);
+	cell->cap       = ntohl(ccap->cap);
+	cell->DL_earfcn = ntohs(ccap->DL_earfcn);
+	cell->DL_prbs   = ccap->DL_prbs;
+	cell->UL_earfcn = ntohs(ccap->UL_earfcn);
+	cell->UL_prbs   = ccap->UL_prbs;
+}
+
+/* Replace the capabilities of an eNB; the cache takes the reference of the
+ * given record.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+static int ep_capc_set(ep_capc * c, enb_id_t enb_id, ep_caps * caps)
+{
+	uint32_t i = ep_hmap_get(&c->map, enb_id, 0);
+
+	if(!i) {
+		if(!c->free) {
+			ep_dbg_log(EP_DBG_0"CAPC: Cache is full!\n");
+			return EP_ERROR;
+		}
+
+		i       = c->free;
+		c->free = c->ents[i - 1].next;
+
+		if(ep_hmap_put(&c->map, enb_id, 0, i)) {
+			c->ents[i - 1].next = c->free;
+			c->free             = i;
+			return EP_ERROR;
+		}
+
+		c->ents[i - 1].caps = 0;
+	}
+
+	ep_caps_put(c->ents[i - 1].caps);
+
+	c->ents[i - 1].enb_id = enb_id;
+	c->ents[i - 1].caps   = caps;
+
+	return EP_SUCCESS;
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+ep_caps * ep_caps_get(ep_caps * caps)
+{
+	if(caps) {
+		__atomic_add_fetch(&caps->refs, 1, __ATOMIC_RELAXED);
+	}
+
+	return caps;
+}
+
+void ep_caps_put(ep_caps * caps)
+{
+	if(caps && __atomic_sub_fetch(&caps->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+		free(caps);
+	}
+}
+
+int ep_capc_init(ep_capc * c, uint32_t max)
+{
+	uint32_t i;
+
+	if(!c || max == 0) {
+		ep_dbg_log(EP_DBG_0"CAPC: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	if(ep_hmap_init(&c->map, max)) {
+		return EP_ERROR;
+	}
+
+	c->ents = calloc(max, sizeof(ep_capc_ent));
+
+	if(!c->ents) {
+		ep_dbg_log(EP_DBG_0"CAPC: Not enough memory!\n");
+		ep_hmap_release(&c->map);
+		return EP_ERROR;
+	}
+
+	c->max  = max;
+	c->free = 0;
+
+	for(i = max; i > 0; i--) {
+		c->ents[i - 1].next = c->free;
+		c->free             = i;
+	}
+
+	return EP_SUCCESS;
+}
+
+void ep_capc_release(ep_capc * c)
+{
+	uint32_t i;
+
+	if(!c) {
+		return;
+	}
+
+	for(i = 0; c->ents && i < c->max; i++) {
+		ep_caps_put(c->ents[i].caps);
+	}
+
+	ep_hmap_release(&c->map);
+	free(c->ents);
+
+	c->ents = 0;
+	c->max  = 0;
+	c->free = 0;
+}
+
+int ep_capc_store(
+	ep_capc *    c,
+	enb_id_t     enb_id,
+	uint64_t     hash,
+	ep_enb_det * det)
+{
+	ep_caps * caps;
+	uint32_t  n;
+
+	if(!c || !det) {
+		ep_dbg_log(EP_DBG_0"CAPC: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	/* Agents without fingerprint can't use the cache */
+	if(hash == EP_HELLO_NO_HASH) {
+		ep_capc_remove(c, enb_id);
+		return EP_SUCCESS;
+	}
+
+	n    = det->nof_cells < EP_ECAP_CELL_MAX ?
+		det->nof_cells : EP_ECAP_CELL_MAX;
+	caps = ep_caps_new(enb_id, n);
+
+	if(!caps) {
+		return EP_ERROR;
+	}
+
+	caps->hash    = hash;
+	caps->capmask = det->capmask;
+
+	memcpy(caps->cells, det->cells, n * sizeof(ep_cell_det));
+
+	if(ep_capc_set(c, enb_id, caps)) {
+		ep_caps_put(caps);
+		return EP_ERROR;
+	}
+
+	return EP_SUCCESS;
+}
+
+int ep_capc_ecap(ep_capc * c, char * buf, unsigned int size)
+{
+	ep_msg_type   type;
+	enb_id_t      enb_id;
+	ep_caps *     old;
+	ep_caps *     caps;
+	ep_ecap_rep * rep;
+	ep_ccap_rep * ccap;
+	ep_TLV *      tlv;
+	ep_cell_det   cell;
+	char *        b;
+	char *        p;
+	unsigned int  hs = sizeof(ep_hdr) + sizeof(ep_s_hdr);
+	uint32_t      capmask;
+	uint32_t      n    = 0;
+	int           same;
+
+	if(!c || !buf) {
+		ep_dbg_log(EP_DBG_0"CAPC: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	if(epp_head_peek(buf, size, &type, &enb_id, 0, 0, 0)) {
+		return EP_ERROR;
+	}
+
+	if(type != EP_TYPE_SINGLE_MSG ||
+		size < hs + sizeof(ep_ecap_rep) ||
+		epp_single_type(buf, size) != EP_ACT_ECAP ||
+		epp_dir(buf, size) != EP_HDR_FLAG_DIR_REP ||
+		epp_single_op(buf, size) != EP_OPERATION_UNSPECIFIED)
+	{
+		ep_dbg_log(EP_DBG_0"CAPC: Not an eNB capabilities reply!\n");
+		return EP_ERROR;
+	}
+
+	if(epp_msg_length(buf, size) >= hs && epp_msg_length(buf, size) < size) {
+		size = epp_msg_length(buf, size);
+	}
+
+	rep     = (ep_ecap_rep *)(buf + hs);
+	capmask = ntohl(rep->cap);
+	b       = buf + hs + sizeof(ep_ecap_rep);
+	old     = ep_capc_get(c, enb_id);
+	same    = old && old->capmask == capmask;
+
+	/* Count the cells, while checking them against the current record */
+	for(p = b; p + sizeof(ep_TLV) <= buf + size; ) {
+		tlv = (ep_TLV *)p;
+
+		if(p + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
+			break;
+		}
+
+		if(ntohs(tlv->type) == EP_TLV_CELL_CAP &&
+			ntohs(tlv->length) >= sizeof(ep_ccap_rep))
+		{
+			if(same) {
+				ep_capc_cell(
+					(ep_ccap_rep *)(p + sizeof(ep_TLV)),
+					&cell);
+
+				same = n < old->nof_cells &&
+					old->cells[n].pci       == cell.pci &&
+					old->cells[n].cap       == cell.cap &&
+					old->cells[n].DL_earfcn == cell.DL_earfcn &&
+					old->cells[n].UL_earfcn == cell.UL_earfcn &&
+					old->cells[n].DL_prbs   == cell.DL_prbs &&
+					old->cells[n].UL_prbs   == cell.UL_prbs;
+			}
+
+			n++;
+		}
+
+		p += sizeof(ep_TLV) + ntohs(tlv->length);
+	}
+
+	if(same && n == old->nof_cells) {
+		return 0;
+	}
+
+	caps = ep_caps_new(enb_id, n);
+
+	if(!caps) {
+		return EP_ERROR;
+	}
+
+	caps->capmask = capmask;
+	n             = 0;
+
+	for(p = b; n < caps->nof_cells; ) {
+		tlv = (ep_TLV *)p;
+
+		if(ntohs(tlv->type) == EP_TLV_CELL_CAP &&
+			ntohs(tlv->length) >= sizeof(ep_ccap_rep))
+		{
+			ccap = (ep_ccap_rep *)(p + sizeof(ep_TLV));
+			ep_capc_cell(ccap, &caps->cells[n++]);
+		}
+
+		p += sizeof(ep_TLV) + ntohs(tlv->length);
+	}
+
+	caps->hash = ep_ecap_fingerprint_l(capmask, n, caps->cells);
+
+	if(ep_capc_set(c, enb_id, caps)) {
+		ep_caps_put(caps);
+		return EP_ERROR;
+	}
+
+	return 1;
+}
+
+ep_caps * ep_capc_get(ep_capc * c, enb_id_t enb_id)
+{
+	uint32_t i;
+
+	if(!c) {
+		return 0;
+	}
+
+	i = ep_hmap_get(&c->map, enb_id, 0);
+
+	return i ? c->ents[i - 1].caps : 0;
+}
+
+ep_caps * ep_capc_lookup(ep_capc * c, enb_id_t enb_id, uint64_t hash)
+{
+	ep_caps * caps;
+
+	if(hash == EP_HELLO_NO_HASH) {
+		return 0;
+	}
+
+	caps = ep_capc_get(c, enb_id);
+
+	if(!caps || caps->hash != hash) {
+		return 0;
+	}
+
+	return caps;
+}
+
+ep_caps * ep_capc_hello(
+	ep_capc *    c,
+	char *       buf,
+	unsigned int size,
+	uint64_t *   hash)
+{
+	enb_id_t    enb_id;
+	ep_msg_type type;
+	uint64_t    h = EP_HELLO_NO_HASH;
+	int         ret;
+
+	if(hash) {
+		*hash = EP_HELLO_NO_HASH;
+	}
+
+	if(!c || !buf) {
+		ep_dbg_log(EP_DBG_0"CAPC: Invalid buffer!\n");
+		return 0;
+	}
+
+	if(epp_head_peek(buf, size, &type, &enb_id, 0, 0, 0)) {
+		return 0;
+	}
+
+	switch(type) {
+	case EP_TYPE_SINGLE_MSG:
+		ret = epp_single_hello_req_fp(buf, size, 0, &h);
+		break;
+	case EP_TYPE_SCHEDULE_MSG:
+		ret = epp_sched_hello_req_fp(buf, size, 0, &h);
+		break;
+	default:
+		ret = EP_ERROR;
+		break;
+	}
+
+	if(ret) {
+		return 0;
+	}
+
+	if(hash) {
+		*hash = h;
+	}
+
+	return ep_capc_lookup(c, enb_id, h);
+}
+
+int ep_capc_remove(ep_capc * c, enb_id_t enb_id)
+{
+	uint32_t i;
+
+	if(!c) {
+		return EP_ERROR;
+	}
+
+	i = ep_hmap_del(&c->map, enb_id, 0);
+
+	if(!i) {
+		return EP_ERROR;
+	}
+
+	ep_caps_put(c->ents[i - 1].caps);
+
+	c->ents[i - 1].caps = 0;
+	c->ents[i - 1].next = c->free;
+	c->free             = i;
+
+	return EP_SUCCESS;
+}
@@ -0,0 +1,777 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _DEFAULT_SOURCE
+#include <endian.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_CORE
+
+#include <emproto.h>
+
+/* Size of the buffer of pending records */
+#define EP_CAP_BUF_SIZE		(1024 * 1024)
+
+/* Size of a record, message included */
+#define ep_cap_rec_size(l)	((sizeof(ep_cap_rec) + (l) + 7) & ~7ULL)
+
+typedef struct __ep_capture_index_header {
+	char     magic[8];  /* EP_CAP_IDX_MAGIC */
+	uint32_t nof_segs;  /* Segments of the indexed capture */
+	uint32_t dummy;
+	uint64_t total;     /* Size of the indexed capture */
+	uint64_t nof_ents;  /* Number of entries following */
+} ep_capr_ihdr;
+
+int ep_cap_on = 0;
+
+static pthread_mutex_t ep_cap_lock    = PTHREAD_MUTEX_INITIALIZER;
+static char            ep_cap_pfx[256];
+static int             ep_cap_fd      = -1;
+static uint64_t        ep_cap_max     = 0;  /* Size of the segments */
+static uint32_t        ep_cap_segn    = 0;  /* Current segment */
+static uint32_t        ep_cap_gen     = 0;  /* Segments opened so far */
+static uint64_t        ep_cap_size    = 0;  /* Size of the segment */
+static uint64_t        ep_cap_flushed = 0;  /* Part of it in the file */
+static char *          ep_cap_buf     = 0;  /* Pending records */
+static uint32_t        ep_cap_blen    = 0;
+
+/* Last message formatted by the thread, whose sequence can still change */
+static __thread struct {
+	char *   buf;
+	uint32_t gen;
+	uint64_t off;
+} ep_cap_last;
+
+/* Current time, in ns since Epoch */
+static uint64_t ep_cap_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Write out the pending records; lock must be held */
+static void ep_cap_write(void)
+{
+	uint32_t w = 0;
+	ssize_t  n;
+
+	while(w < ep_cap_blen) {
+		n = write(ep_cap_fd, ep_cap_buf + w, ep_cap_blen - w);
+
+		if(n <= 0) {
+			ep_dbg_log(EP_DBG_0"CAP: Write failed; records lost!\n");
+			break;
+		}
+
+		w += n;
+	}
+
+	ep_cap_flushed += ep_cap_blen;
+	ep_cap_blen     = 0;
+}
+
+/* Close the current segment, if any, and open the given one; lock must be
+ * held.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+static int ep_cap_segment(uint32_t n)
+{
+	char          path[300];
+	ep_cap_shdr * sh;
+
+	if(ep_cap_fd >= 0) {
+		ep_cap_write();
+		close(ep_cap_fd);
+	}
+
+	snprintf(path, sizeof(path), "%s.%u.epcap", ep_cap_pfx, n);
+
+	ep_cap_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if(ep_cap_fd < 0) {
+		ep_dbg_log(EP_DBG_0"CAP: Cannot open %s!\n", path);
+		return EP_ERROR;
+	}
+
+	sh = (ep_cap_shdr *)ep_cap_buf;
+
+	memcpy(sh->magic, EP_CAP_MAGIC, sizeof(sh->magic));
+	sh->seg   = n;
+	sh->dummy = 0;
+	sh->start = ep_cap_now();
+
+	ep_cap_segn    = n;
+	ep_cap_gen++;
+	ep_cap_blen    = sizeof(ep_cap_shdr);
+	ep_cap_size    = sizeof(ep_cap_shdr);
+	ep_cap_flushed = 0;
+
+	return EP_SUCCESS;
+}
+
+/* Close the capture; lock must be held */
+static void ep_cap_stop(void)
+{
+	__atomic_store_n(&ep_cap_on, 0, __ATOMIC_RELEASE);
+
+	if(ep_cap_fd >= 0) {
+		ep_cap_write();
+		close(ep_cap_fd);
+	}
+
+	free(ep_cap_buf);
+
+	ep_cap_fd  = -1;
+	ep_cap_buf = 0;
+}
+
+static void ep_cap_exit(void)
+{
+	ep_cap_close();
+}
+
+/* Start the capture if asked by the environment */
+__attribute__((constructor)) static void ep_cap_env(void)
+{
+	char * pfx = getenv("EMPROTO_CAPTURE");
+
+	if(pfx && *pfx) {
+		ep_cap_open(pfx, 0);
+	}
+}
+
+/* Find the record at the given position of a segment.
+ * Returns the message, or NULL if there's no valid record there.
+ */
+static char * ep_capr_at(
+	ep_capr *     r,
+	uint32_t      seg,
+	uint64_t      off,
+	ep_cap_rec ** rec)
+{
+	ep_cap_rec * c;
+
+	if(seg >= r->nof_segs || off + sizeof(ep_cap_rec) > r->sizes[seg]) {
+		return 0;
+	}
+
+	c = (ep_cap_rec *)(r->segs[seg] + off);
+
+	if(c->len > r->sizes[seg] - off - sizeof(ep_cap_rec)) {
+		return 0;
+	}
+
+	if(rec) {
+		*rec = c;
+	}
+
+	return (char *)(c + 1);
+}
+
+/* Order of the index: eNB, type, action, sequence, then capture order */
+static int ep_capr_cmp(const void * a, const void * b)
+{
+	const ep_cap_ent * x = (const ep_cap_ent *)a;
+	const ep_cap_ent * y = (const ep_cap_ent *)b;
+
+	if(x->enb_id != y->enb_id) {
+		return x->enb_id < y->enb_id ? -1 : 1;
+	}
+
+	if(x->type != y->type) {
+		return x->type < y->type ? -1 : 1;
+	}
+
+	if(x->action != y->action) {
+		return x->action < y->action ? -1 : 1;
+	}
+
+	if(x->seq != y->seq) {
+		return x->seq < y->seq ? -1 : 1;
+	}
+
+	if(x->seg != y->seg) {
+		return x->seg < y->seg ? -1 : 1;
+	}
+
+	return x->off < y->off ? -1 : (x->off > y->off);
+}
+
+/* Compare an entry with a, possibly partial, key */
+static int ep_capr_key(ep_cap_ent * e, enb_id_t enb_id, int type, int action)
+{
+	if(e->enb_id != enb_id) {
+		return e->enb_id < enb_id ? -1 : 1;
+	}
+
+	if(type < 0) {
+		return 0;
+	}
+
+	if(e->type != type) {
+		return e->type < type ? -1 : 1;
+	}
+
+	if(action < 0 || e->action == action) {
+		return 0;
+	}
+
+	return e->action < action ? -1 : 1;
+}
+
+/* Fill an index entry from a captured message.
+ * Returns EP_SUCCESS, or a negative error code if it's not a message.
+ */
+static int ep_capr_entry(
+	ep_cap_ent * e,
+	ep_cap_rec * rec,
+	char *       msg,
+	uint32_t     seg,
+	uint64_t     off)
+{
+	ep_hdr * h = (ep_hdr *)msg;
+
+	if(rec->len < sizeof(ep_hdr)) {
+		return EP_ERROR;
+	}
+
+	e->enb_id = be64toh(h->id.enb_id);
+	e->seq    = ntohl(h->seq);
+	e->type   = h->type;
+	e->dir    = rec->dir;
+	e->ts     = rec->ts;
+	e->seg    = seg;
+	e->dummy  = 0;
+	e->off    = off;
+
+	switch(h->type) {
+	case EP_TYPE_SINGLE_MSG:
+		e->action = epp_single_type(msg, rec->len);
+		break;
+	case EP_TYPE_SCHEDULE_MSG:
+		e->action = epp_schedule_type(msg, rec->len);
+		break;
+	case EP_TYPE_TRIGGER_MSG:
+		e->action = epp_trigger_type(msg, rec->len);
+		break;
+	default:
+		e->action = EP_ACT_INVALID;
+		break;
+	}
+
+	return EP_SUCCESS;
+}
+
+/* Build the index of the capture, and try to save it for the next time.
+ * Returns EP_SUCCESS, or a negative error code.
+ */
+static int ep_capr_index(ep_capr * r, const char * prefix, uint64_t total)
+{
+	char         path[300];
+	char         tmp[310];
+	ep_capr_pos  pos = {0};
+	ep_capr_ihdr ih;
+	ep_cap_rec * rec;
+	char *       msg;
+	FILE *       f;
+	uint64_t     n   = 0;
+
+	/* Count first, to allocate the index at once */
+	while(ep_capr_next(r, &pos, &rec)) {
+		n++;
+	}
+
+	r->ents = malloc((n ? n : 1) * sizeof(ep_cap_ent));
+
+	if(!r->ents) {
+		ep_dbg_log(EP_DBG_0"CAPR: Not enough memory!\n");
+		return EP_ERROR;
+	}
+
+	memset(&pos, 0, sizeof(pos));
+	r->nof_ents = 0;
+
+	while((msg = ep_capr_next(r, &pos, &rec))) {
+		if(!ep_capr_entry(
+			&r->ents[r->nof_ents],
+			rec,
+			msg,
+			pos.seg,
+			(char *)rec - r->segs[pos.seg]))
+		{
+			r->nof_ents++;
+		}
+	}
+
+	qsort(r->ents, r->nof_ents, sizeof(ep_cap_ent), ep_capr_cmp);
+
+	memcpy(ih.magic, EP_CAP_IDX_MAGIC, sizeof(ih.magic));
+	ih.nof_segs = r->nof_segs;
+	ih.dummy    = 0;
+	ih.total    = total;
+	ih.nof_ents = r->nof_ents;
+
+	snprintf(path, sizeof(path), "%s.epidx", prefix);
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+	/* Not being able to save the index is not an error */
+	f = fopen(tmp, "w");
+
+	if(!f) {
+		return EP_SUCCESS;
+	}
+
+	if(fwrite(&ih, sizeof(ih), 1, f) != 1 ||
+		fwrite(r->ents, sizeof(ep_cap_ent), r->nof_ents, f) !=
+			r->nof_ents)
+	{
+		fclose(f);
+		unlink(tmp);
+		return EP_SUCCESS;
+	}
+
+	if(fclose(f) || rename(tmp, path)) {
+		unlink(tmp);
+	}
+
+	return EP_SUCCESS;
+}
+
+/* Use the saved index of the capture, if still valid.
+ * Returns EP_SUCCESS, or a negative error code if it has to be built.
+ */
+static int ep_capr_load(ep_capr * r, const char * prefix, uint64_t total)
+{
+	char           path[300];
+	struct stat    st;
+	ep_capr_ihdr * ih;
+	int            fd;
+
+	snprintf(path, sizeof(path), "%s.epidx", prefix);
+
+	fd = open(path, O_RDONLY);
+
+	if(fd < 0) {
+		return EP_ERROR;
+	}
+
+	if(fstat(fd, &st) || st.st_size < (off_t)sizeof(ep_capr_ihdr)) {
+		close(fd);
+		return EP_ERROR;
+	}
+
+	r->imap = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(r->imap == MAP_FAILED) {
+		r->imap = 0;
+		return EP_ERROR;
+	}
+
+	r->isize = st.st_size;
+	ih       = (ep_capr_ihdr *)r->imap;
+
+	if(memcmp(ih->magic, EP_CAP_IDX_MAGIC, sizeof(ih->magic)) ||
+		ih->nof_segs != r->nof_segs ||
+		ih->total != total ||
+		ih->nof_ents != (r->isize - sizeof(ep_capr_ihdr)) /
+			sizeof(ep_cap_ent))
+	{
+		munmap(r->imap, r->isize);
+		r->imap  = 0;
+		r->isize = 0;
+		return EP_ERROR;
+	}
+
+	r->ents     = (ep_cap_ent *)(r->imap + sizeof(ep_capr_ihdr));
+	r->nof_ents = ih->nof_ents;
+
+	return EP_SUCCESS;
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+int ep_cap_open(const char * prefix, uint64_t seg_size)
+{
+	static int reg = 0;
+
+	if(!prefix || strlen(prefix) >= sizeof(ep_cap_pfx)) {
+		ep_dbg_log(EP_DBG_0"CAP: Invalid prefix!\n");
+		return EP_ERROR;
+	}
+
+	pthread_mutex_lock(&ep_cap_lock);
+
+	ep_cap_stop();
+
+	ep_cap_buf = malloc(EP_CAP_BUF_SIZE);
+
+	if(!ep_cap_buf) {
+		ep_dbg_log(EP_DBG_0"CAP: Not enough memory!\n");
+		pthread_mutex_unlock(&ep_cap_lock);
+		return EP_ERROR;
+	}
+
+	strcpy(ep_cap_pfx, prefix);
+	ep_cap_max = seg_size ? seg_size : EP_CAP_SEG_DEFAULT;
+
+	if(ep_cap_segment(0)) {
+		ep_cap_stop();
+		pthread_mutex_unlock(&ep_cap_lock);
+		return EP_ERROR;
+	}
+
+	if(!reg) {
+		atexit(ep_cap_exit);
+		reg = 1;
+	}
+
+	__atomic_store_n(&ep_cap_on, 1, __ATOMIC_RELEASE);
+
+	pthread_mutex_unlock(&ep_cap_lock);
+
+	return EP_SUCCESS;
+}
+
+void ep_cap_close()
+{
+	pthread_mutex_lock(&ep_cap_lock);
+	ep_cap_stop();
+	pthread_mutex_unlock(&ep_cap_lock);
+}
+
+void ep_cap_flush()
+{
+	pthread_mutex_lock(&ep_cap_lock);
+
+	if(ep_cap_fd >= 0) {
+		ep_cap_write();
+	}
+
+	pthread_mutex_unlock(&ep_cap_lock);
+}
+
+void ep_cap_msg(char * buf, unsigned int size, int dir)
+{
+	ep_hdr *   h = (ep_hdr *)buf;
+	ep_cap_rec rec;
+	uint32_t   len;
+	uint64_t   rs;
+
+	if(!buf || size < sizeof(ep_hdr)) {
+		return;
+	}
+
+	len = ntohs(h->length);
+
+	/* Only whole messages are captured */
+	if(len < sizeof(ep_hdr) || len > size) {
+		return;
+	}
+
+	rec.len      = len;
+	rec.dir      = dir;
+	rec.dummy[0] = rec.dummy[1] = rec.dummy[2] = 0;
+	rs           = ep_cap_rec_size(len);
+
+	pthread_mutex_lock(&ep_cap_lock);
+
+	if(!ep_cap_on || ep_cap_fd < 0) {
+		pthread_mutex_unlock(&ep_cap_lock);
+		return;
+	}
+
+	/* Taken under the lock, so that records of concurrent threads are in
+	 * order of time; only a step of the clock can still reorder them.
+	 */
+	rec.ts = ep_cap_now();
+
+	if(ep_cap_size + rs > ep_cap_max && ep_cap_size > sizeof(ep_cap_shdr)) {
+		if(ep_cap_segment(ep_cap_segn + 1)) {
+			ep_cap_stop();
+			pthread_mutex_unlock(&ep_cap_lock);
+			return;
+		}
+	}
+
+	if(ep_cap_blen + rs > EP_CAP_BUF_SIZE) {
+		ep_cap_write();
+	}
+
+	memcpy(ep_cap_buf + ep_cap_blen, &rec, sizeof(ep_cap_rec));
+	memcpy(ep_cap_buf + ep_cap_blen + sizeof(ep_cap_rec), buf, len);
+	memset(ep_cap_buf + ep_cap_blen + sizeof(ep_cap_rec) + len, 0,
+		rs - sizeof(ep_cap_rec) - len);
+
+	if(dir == EP_CAP_OUT) {
+		ep_cap_last.buf = buf;
+		ep_cap_last.gen = ep_cap_gen;
+		ep_cap_last.off = ep_cap_size;
+	}
+
+	ep_cap_blen += rs;
+	ep_cap_size += rs;
+
+	pthread_mutex_unlock(&ep_cap_lock);
+}
+
+void ep_cap_seq(char * buf, uint32_t seq)
+{
+	uint32_t s = htonl(seq);
+	uint64_t p;
+
+	if(!buf || ep_cap_last.buf != buf) {
+		return;
+	}
+
+	/* Only once; the buffer can be reused for the following messages */
+	ep_cap_last.buf = 0;
+
+	pthread_mutex_lock(&ep_cap_lock);
+
+	if(ep_cap_fd >= 0 && ep_cap_last.gen == ep_cap_gen) {
+		p = ep_cap_last.off + sizeof(ep_cap_rec) + offsetof(ep_hdr, seq);
+
+		if(p >= ep_cap_flushed) {
+			memcpy(ep_cap_buf + (p - ep_cap_flushed), &s, sizeof(s));
+		} else if(pwrite(ep_cap_fd, &s, sizeof(s), p) != sizeof(s)) {
+			ep_dbg_log(EP_DBG_0"CAP: Cannot update the sequence!\n");
+		}
+	}
+
+	pthread_mutex_unlock(&ep_cap_lock);
+}
+
+int ep_capr_open(ep_capr * r, const char * prefix)
+{
+	char        path[300];
+	struct stat st;
+	char *      m;
+	void *      p;
+	uint64_t    total = 0;
+	int         fd;
+
+	if(!r || !prefix) {
+		ep_dbg_log(EP_DBG_0"CAPR: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	memset(r, 0, sizeof(ep_capr));
+
+	for(;;) {
+		snprintf(path, sizeof(path), "%s.%u.epcap", prefix, r->nof_segs);
+
+		fd = open(path, O_RDONLY);
+
+		if(fd < 0) {
+			break;
+		}
+
+		if(fstat(fd, &st) || st.st_size < (off_t)sizeof(ep_cap_shdr)) {
+			ep_dbg_log(EP_DBG_0"CAPR: Invalid segment %s!\n", path);
+			close(fd);
+			ep_capr_close(r);
+			return EP_ERROR;
+		}
+
+		m = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if(m == MAP_FAILED ||
+			memcmp(m, EP_CAP_MAGIC, sizeof(((ep_cap_shdr *)0)->magic)))
+		{
+			ep_dbg_log(EP_DBG_0"CAPR: Invalid segment %s!\n", path);
+
+			if(m != MAP_FAILED) {
+				munmap(m, st.st_size);
+			}
+
+			ep_capr_close(r);
+			return EP_ERROR;
+		}
+
+		/* Segments are scanned sequentially */
+		madvise(m, st.st_size, MADV_SEQUENTIAL);
+
+		p = realloc(r->segs, (r->nof_segs + 1) * sizeof(char *));
+
+		if(p) {
+			r->segs = p;
+			p = realloc(r->sizes, (r->nof_segs + 1) * sizeof(uint64_t));
+		}
+
+		if(!p) {
+			ep_dbg_log(EP_DBG_0"CAPR: Not enough memory!\n");
+			munmap(m, st.st_size);
+			ep_capr_close(r);
+			return EP_ERROR;
+		}
+
+		r->sizes = p;
+		r->segs[r->nof_segs]  = m;
+		r->sizes[r->nof_segs] = st.st_size;
+		r->nof_segs++;
+		total += st.st_size;
+	}
+
+	if(!r->nof_segs) {
+		ep_dbg_log(EP_DBG_0"CAPR: No capture %s!\n", prefix);
+		return EP_ERROR;
+	}
+
+	if(ep_capr_load(r, prefix, total) && ep_capr_index(r, prefix, total)) {
+		ep_capr_close(r);
+		return EP_ERROR;
+	}
+
+	return EP_SUCCESS;
+}
+
+void ep_capr_close(ep_capr * r)
+{
+	uint32_t i;
+
+	if(!r) {
+		return;
+	}
+
+	for(i = 0; i < r->nof_segs; i++) {
+		munmap(r->segs[i], r->sizes[i]);
+	}
+
+	if(r->imap) {
+		munmap(r->imap, r->isize);
+	} else {
+		free(r->ents);
+	}
+
+	free(r->segs);
+	free(r->sizes);
+
+	memset(r, 0, sizeof(ep_capr));
+}
+
+ep_cap_ent * ep_capr_find(
+	ep_capr *    r,
+	enb_id_t     enb_id,
+	int          type,
+	int          action,
+	uint64_t *   nof)
+{
+	uint64_t lo = 0;
+	uint64_t hi;
+	uint64_t m;
+	uint64_t first;
+
+	if(nof) {
+		*nof = 0;
+	}
+
+	if(!r || !r->ents) {
+		return 0;
+	}
+
+	/* First entry not lower than the key */
+	for(hi = r->nof_ents; lo < hi; ) {
+		m = lo + (hi - lo) / 2;
+
+		if(ep_capr_key(&r->ents[m], enb_id, type, action) < 0) {
+			lo = m + 1;
+		} else {
+			hi = m;
+		}
+	}
+
+	first = lo;
+
+	/* First entry greater than the key */
+	for(hi = r->nof_ents; lo < hi; ) {
+		m = lo + (hi - lo) / 2;
+
+		if(ep_capr_key(&r->ents[m], enb_id, type, action) <= 0) {
+			lo = m + 1;
+		} else {
+			hi = m;
+		}
+	}
+
+	if(lo == first) {
+		return 0;
+	}
+
+	if(nof) {
+		*nof = lo - first;
+	}
+
+	return &r->ents[first];
+}
+
+char * ep_capr_msg(ep_capr * r, ep_cap_ent * e, ep_cap_rec ** rec)
+{
+	if(!r || !e) {
+		return 0;
+	}
+
+	return ep_capr_at(r, e->seg, e->off, rec);
+}
+
+char * ep_capr_next(ep_capr * r, ep_capr_pos * pos, ep_cap_rec ** rec)
+{
+	ep_cap_rec * c;
+	char *       msg;
+
+	if(!r || !pos) {
+		return 0;
+	}
+
+	for(; pos->seg < r->nof_segs; pos->seg++, pos->off = 0) {
+		if(pos->off < sizeof(ep_cap_shdr)) {
+			pos->off = sizeof(ep_cap_shdr);
+		}
+
+		/* A truncated record ends the segment */
+		msg = ep_capr_at(r, pos->seg, pos->off, &c);
+
+		if(msg) {
+			pos->off += ep_cap_rec_size(c->len);
+
+			if(rec) {
+				*rec = c;
+			}
+
+			return msg;
+		}
+	}
+
+	return 0;
+}
@@ -16,19 +16,14 @@
 
 #include <netinet/in.h>
 
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_ACT(EP_ACT_CCAP)
+
 #include <emproto.h>
 
-int epf_ccap_rep(
-	char *        buf,
-	unsigned int  size,
-	ep_cell_det * cell)
+void epf_ccap_rep_w(ep_writer * w, ep_cell_det * cell)
 {
-	ep_ccap_rep * rep = (ep_ccap_rep *)buf;
-
-	if(size < sizeof(ep_ccap_rep)) {
-		ep_dbg_log(EP_DBG_2"F - CCAP Rep: Not enough space!\n");
-		return -1;
-	}
+	ep_ccap_rep * rep = (ep_ccap_rep *)ep_w_put(w, sizeof(ep_ccap_rep));
 
 	if(!cell) {
 		rep->cap        = 0;
@@ -44,9 +39,7 @@ int epf_ccap_rep(
 		rep->UL_prbs    = cell->UL_prbs;
 	}
 
-	ep_dbg_dump(EP_DBG_2"F - CCAP Rep: ", buf, sizeof(ep_ccap_rep));
-
-	return sizeof(ep_ccap_rep);
+	ep_dbg_dump(EP_DBG_2"F - CCAP Rep: ", (char *)rep, sizeof(ep_ccap_rep));
 }
 
 int epp_ccap_rep(
@@ -74,20 +67,13 @@ int epp_ccap_rep(
 	return EP_SUCCESS;
 }
 
-int epf_ccap_req(char * buf, unsigned int size)
+void epf_ccap_req_w(ep_writer * w)
 {
-	ep_ccap_req * rep = (ep_ccap_req *)buf;
-
-	if(size < sizeof(ep_ccap_req)) {
-		ep_dbg_log(EP_DBG_2"F - CCAP Req: Not enough space!\n");
-		return -1;
-	}
+	ep_ccap_req * rep = (ep_ccap_req *)ep_w_put(w, sizeof(ep_ccap_req));
 
 	rep->dummy = 0;
 
-	ep_dbg_dump(EP_DBG_2"F - CCAP Req: ", buf, sizeof(ep_ccap_req));
-
-	return sizeof(ep_ccap_req);
+	ep_dbg_dump(EP_DBG_2"F - CCAP Req: ", (char *)rep, sizeof(ep_ccap_req));
 }
 
 int epp_ccap_req(char * buf, unsigned int size)
@@ -113,49 +99,36 @@ int epf_single_ccap_rep_fail(
 	cell_id_t     cell_id,
 	mod_id_t      mod_id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single CCAP Fail: Invalid buffer!\n");
 		return EP_ERROR;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ccap_rep_fail_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single CCAP Fail: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_CCAP, EP_OPERATION_FAIL);
+	epf_ccap_rep_w(&w, 0);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_CCAP,
-		EP_OPERATION_FAIL);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ccap_rep(buf + ret, size - ret, 0);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ccap_rep_fail_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_ccap_rep);
 }
 
 int epf_single_ccap_rep(
@@ -166,49 +139,36 @@ int epf_single_ccap_rep(
 	mod_id_t      mod_id,
 	ep_cell_det * cell)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single CCAP Rep: Invalid buffer!\n");
 		return EP_ERROR;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ccap_rep_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single CCAP Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_CCAP, EP_OPERATION_UNSPECIFIED);
+	epf_ccap_rep_w(&w, cell);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_CCAP,
-		EP_OPERATION_UNSPECIFIED);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ccap_rep(buf + ret, size - ret, cell);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ccap_rep_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_ccap_rep);
 }
 
 int epp_single_ccap_rep(
@@ -234,49 +194,36 @@ int epf_single_ccap_req(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single CCAP Req: Invalid buffer!\n");
 		return EP_ERROR;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ccap_req_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single CCAP Req: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_CCAP, EP_OPERATION_UNSPECIFIED);
+	epf_ccap_req_w(&w);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_CCAP,
-		EP_OPERATION_UNSPECIFIED);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ccap_req(buf + ret, size - ret);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ms;
+unsigned int epf_single_ccap_req_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_ccap_req);
 }
 
 int epp_single_ccap_req(char * buf, unsigned int size)
@@ -0,0 +1,373 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_CORE
+
+#include <emproto.h>
+
+/* Return an entry to the free list */
+static void ep_corr_free(ep_corr * c, ep_corr_ent * e)
+{
+	e->next = c->free;
+	c->free = (e - c->ents) + 1;
+	c->nof_pending--;
+}
+
+/* Histogram where the latencies of an action are accounted */
+static ep_corr_hist * ep_corr_hist_of(ep_corr * c, uint8_t act)
+{
+	return &c->hist[act < EP_CORR_ACT_MAX ? act : EP_ACT_INVALID];
+}
+
+/* Bucket of the histogram where a latency falls */
+static int ep_corr_bucket(uint64_t lat)
+{
+	int b;
+
+	if(!lat) {
+		return 0;
+	}
+
+	b = 64 - __builtin_clzll(lat);
+
+	return b < EP_CORR_BUCKETS ? b : EP_CORR_BUCKETS - 1;
+}
+
+/* Request did not receive its reply in time */
+static void ep_corr_expired(ep_tw_timer * t, void * arg)
+{
+	ep_corr *     c = (ep_corr *)arg;
+	ep_corr_ent * e = (ep_corr_ent *)t;
+
+	ep_hmap_del(&c->map, e->enb_id, e->seq);
+	ep_corr_free(c, e);
+
+	ep_corr_hist_of(c, e->act)->nof_timeout++;
+	c->nof_expired++;
+
+	ep_dbg_log(EP_DBG_0"CORR: Request %u to %" PRIu64 " timed out!\n",
+		e->seq, e->enb_id);
+
+	if(c->cb) {
+		c->cb(e->enb_id, e->seq, (ep_act_type)e->act, c->arg);
+	}
+}
+
+/* Extract the identity of a request/reply from its headers */
+static int ep_corr_msg(
+	char *        buf,
+	unsigned int  size,
+	enb_id_t *    enb_id,
+	uint32_t *    seq,
+	ep_act_type * act)
+{
+	ep_msg_type type;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"CORR: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(epp_head_peek(buf, size, &type, enb_id, 0, 0, 0)) {
+		return EP_ERROR;
+	}
+
+	*seq = epp_seq(buf, size);
+
+	switch(type) {
+	case EP_TYPE_SINGLE_MSG:
+		*act = epp_single_type(buf, size);
+		break;
+	case EP_TYPE_SCHEDULE_MSG:
+		*act = epp_schedule_type(buf, size);
+		break;
+	case EP_TYPE_TRIGGER_MSG:
+		*act = epp_trigger_type(buf, size);
+		break;
+	default:
+		ep_dbg_log(EP_DBG_0"CORR: Unknown message type %d!\n", type);
+		return EP_ERROR;
+	}
+
+	return EP_SUCCESS;
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+uint64_t ep_corr_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int ep_corr_init(
+	ep_corr *    c,
+	uint32_t     max,
+	uint32_t     timeout,
+	uint64_t     now,
+	ep_corr_cb   cb,
+	void *       arg)
+{
+	uint32_t i;
+
+	if(!c || max == 0) {
+		ep_dbg_log(EP_DBG_0"CORR: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	if(ep_hmap_init(&c->map, max)) {
+		return EP_ERROR;
+	}
+
+	c->ents = calloc(max, sizeof(ep_corr_ent));
+
+	if(!c->ents) {
+		ep_dbg_log(EP_DBG_0"CORR: Not enough memory!\n");
+		ep_hmap_release(&c->map);
+		return EP_ERROR;
+	}
+
+	/* The wheel runs with a resolution of 1 ms */
+	ep_tw_init(&c->wheel, now / 1000);
+
+	c->max         = max;
+	c->free        = 0;
+	c->nof_pending = 0;
+	c->nof_expired = 0;
+	c->timeout     = timeout ? timeout : EP_CORR_TIMEOUT_DEFAULT;
+	c->cb          = cb;
+	c->arg         = arg;
+
+	memset(c->hist, 0, sizeof(c->hist));
+
+	/* Lower elements are used first */
+	for(i = max; i > 0; i--) {
+		ep_tw_timer_init(&c->ents[i - 1].timer, ep_corr_expired, c);
+		c->ents[i - 1].next = c->free;
+		c->free             = i;
+	}
+
+	return EP_SUCCESS;
+}
+
+void ep_corr_release(ep_corr * c)
+{
+	if(!c) {
+		return;
+	}
+
+	ep_hmap_release(&c->map);
+	free(c->ents);
+
+	c->ents        = 0;
+	c->max         = 0;
+	c->free        = 0;
+	c->nof_pending = 0;
+}
+
+int ep_corr_request(ep_corr * c, char * buf, unsigned int size, uint64_t now)
+{
+	enb_id_t      enb_id;
+	uint32_t      seq;
+	ep_act_type   act;
+	uint32_t      i;
+	uint64_t      deadline;
+	ep_corr_ent * e;
+
+	if(!c) {
+		return EP_ERROR;
+	}
+
+	if(ep_corr_msg(buf, size, &enb_id, &seq, &act)) {
+		return EP_ERROR;
+	}
+
+	if(epp_dir(buf, size) != EP_HDR_FLAG_DIR_REQ) {
+		ep_dbg_log(EP_DBG_0"CORR: Not a request!\n");
+		return EP_ERROR;
+	}
+
+	i = ep_hmap_get(&c->map, enb_id, seq);
+
+	/* Sequence number re-used while still pending; restart the request */
+	if(!i) {
+		if(!c->free) {
+			ep_dbg_log(EP_DBG_0"CORR: Too many pending requests!\n");
+			return EP_ERROR;
+		}
+
+		i       = c->free;
+		c->free = c->ents[i - 1].next;
+
+		if(ep_hmap_put(&c->map, enb_id, seq, i)) {
+			c->ents[i - 1].next = c->free;
+			c->free             = i;
+			return EP_ERROR;
+		}
+
+		c->nof_pending++;
+	}
+
+	e         = &c->ents[i - 1];
+	e->enb_id = enb_id;
+	e->seq    = seq;
+	e->act    = (uint8_t)act;
+	e->start  = now;
+	deadline  = now / 1000 + c->timeout;
+
+	return ep_tw_add(
+		&c->wheel,
+		&e->timer,
+		deadline > c->wheel.now ? deadline - c->wheel.now : 0);
+}
+
+int ep_corr_reply(
+	ep_corr *    c,
+	char *       buf,
+	unsigned int size,
+	uint64_t     now,
+	uint64_t *   lat)
+{
+	enb_id_t       enb_id;
+	uint32_t       seq;
+	ep_act_type    act;
+	uint32_t       i;
+	uint64_t       l;
+	ep_corr_ent *  e;
+	ep_corr_hist * h;
+
+	if(!c) {
+		return EP_ERROR;
+	}
+
+	if(ep_corr_msg(buf, size, &enb_id, &seq, &act)) {
+		return EP_ERROR;
+	}
+
+	i = ep_hmap_del(&c->map, enb_id, seq);
+
+	if(!i) {
+		ep_dbg_log(EP_DBG_1"CORR: No request %u pending for %" PRIu64 "\n",
+			seq, enb_id);
+		return EP_ERROR;
+	}
+
+	e = &c->ents[i - 1];
+	l = now > e->start ? now - e->start : 0;
+	h = ep_corr_hist_of(c, e->act);
+
+	ep_tw_cancel(&c->wheel, &e->timer);
+	ep_corr_free(c, e);
+
+	if(!h->count || l < h->min) {
+		h->min = l;
+	}
+
+	if(l > h->max) {
+		h->max = l;
+	}
+
+	h->count++;
+	h->sum += l;
+	h->buckets[ep_corr_bucket(l)]++;
+
+	if(lat) {
+		*lat = l;
+	}
+
+	return EP_SUCCESS;
+}
+
+int ep_corr_cancel(ep_corr * c, enb_id_t enb_id, uint32_t seq)
+{
+	uint32_t i;
+
+	if(!c) {
+		return EP_ERROR;
+	}
+
+	i = ep_hmap_del(&c->map, enb_id, seq);
+
+	if(!i) {
+		return EP_ERROR;
+	}
+
+	ep_tw_cancel(&c->wheel, &c->ents[i - 1].timer);
+	ep_corr_free(c, &c->ents[i - 1]);
+
+	return EP_SUCCESS;
+}
+
+int ep_corr_expire(ep_corr * c, uint64_t now)
+{
+	if(!c) {
+		return 0;
+	}
+
+	c->nof_expired = 0;
+
+	ep_tw_advance(&c->wheel, now / 1000);
+
+	return c->nof_expired;
+}
+
+ep_corr_hist * ep_corr_stats(ep_corr * c, ep_act_type act)
+{
+	if(!c) {
+		return 0;
+	}
+
+	return ep_corr_hist_of(c, (uint8_t)act);
+}
+
+uint64_t ep_corr_percentile(ep_corr_hist * h, unsigned int perc)
+{
+	uint64_t n;
+	uint64_t t = 0;
+	int      i;
+
+	if(!h || !h->count) {
+		return 0;
+	}
+
+	if(perc > 100) {
+		perc = 100;
+	}
+
+	/* Number of replies which must be covered, rounded up */
+	n = (h->count * perc + 99) / 100;
+
+	for(i = 0; i < EP_CORR_BUCKETS - 1; i++) {
+		t += h->buckets[i];
+
+		if(t >= n) {
+			return (1ULL << i) < h->max ? (1ULL << i) : h->max;
+		}
+	}
+
+	return h->max;
+}
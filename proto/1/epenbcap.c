@@ -16,52 +16,62 @@
 
 #include <netinet/in.h>
 
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_ACT(EP_ACT_ECAP)
+
 #include <emproto.h>
 
-int epf_ecap_rep(
-	char *        buf, 
-	unsigned int  size,
-	ep_enb_det *  det)
+unsigned int epf_ecap_rep_size(uint32_t nof_cells)
+{
+	return sizeof(ep_ecap_rep) + nof_cells * sizeof(ep_ccap_TLV);
+}
+
+void epf_ecap_rep_l_w(
+	ep_writer *   w,
+	uint32_t      capmask,
+	uint32_t      nof_cells,
+	ep_cell_det * cells)
 {
-	char *        c   = buf + sizeof(ep_ecap_rep);
 	int           i   = 0;
-	ep_ecap_rep * rep = (ep_ecap_rep *)buf;
+	ep_ecap_rep * rep = (ep_ecap_rep *)ep_w_put(w, sizeof(ep_ecap_rep));
 	ep_ccap_TLV * ctlv;
 
-	if(size < sizeof(ep_ecap_rep)) {
-		ep_dbg_log(EP_DBG_2"F - ECAP Rep: Not enough space!\n");
-		return -1;
-	}
-
-	rep->cap       = htonl(det->capmask);
+	rep->cap       = htonl(capmask);
 
-	ep_dbg_dump(EP_DBG_2"F - ECAP Rep: ", buf, sizeof(ep_ecap_rep));
-
-	for(i = 0; i < det->nof_cells && i < EP_ECAP_CELL_MAX; i++) {
-		if(c + sizeof(ep_ccap_TLV) > buf + size) {
-			ep_dbg_log(EP_DBG_3"F - ECAP Rep: Not enough space!\n");
-			return -1;
-		}
+	ep_dbg_dump(EP_DBG_2"F - ECAP Rep: ", (char *)rep, sizeof(ep_ecap_rep));
 
-		ctlv = (ep_ccap_TLV *)c;
+	for(i = 0; cells && i < nof_cells; i++) {
+		ctlv = (ep_ccap_TLV *)ep_w_put(w, sizeof(ep_ccap_TLV));
 
 		ctlv->header.type   = htons(EP_TLV_CELL_CAP);
 		ctlv->header.length = htons(sizeof(ep_ccap_rep));
 
-		ctlv->body.pci      = htons(det->cells[i].pci);
-		ctlv->body.cap      = htonl(det->cells[i].cap);
-		ctlv->body.DL_earfcn= htons(det->cells[i].DL_earfcn);
-		ctlv->body.DL_prbs  = det->cells[i].DL_prbs;
-		ctlv->body.UL_earfcn= htons(det->cells[i].UL_earfcn);
-		ctlv->body.UL_prbs  = det->cells[i].UL_prbs;
+		ctlv->body.pci      = htons(cells[i].pci);
+		ctlv->body.cap      = htonl(cells[i].cap);
+		ctlv->body.DL_earfcn= htons(cells[i].DL_earfcn);
+		ctlv->body.DL_prbs  = cells[i].DL_prbs;
+		ctlv->body.UL_earfcn= htons(cells[i].UL_earfcn);
+		ctlv->body.UL_prbs  = cells[i].UL_prbs;
 
-		ep_dbg_dump(EP_DBG_3"F - CCAP TLV: ", c, sizeof(ep_ccap_TLV));
+		ep_dbg_dump(EP_DBG_3"F - CCAP TLV: ", 
+			(char *)ctlv, sizeof(ep_ccap_TLV));
+	}
+}
 
-		/* Point to the next token */
-		c += sizeof(ep_ccap_TLV);
+void epf_ecap_rep_w(ep_writer * w, ep_enb_det * det)
+{
+	/* Negative replies carry no capabilities */
+	if(!det) {
+		epf_ecap_rep_l_w(w, EP_ECAP_NOTHING, 0, 0);
+		return;
 	}
 
-	return c - buf;
+	epf_ecap_rep_l_w(
+		w,
+		det->capmask,
+		det->nof_cells < EP_ECAP_CELL_MAX ?
+			det->nof_cells : EP_ECAP_CELL_MAX,
+		det->cells);
 }
 
 /* Parse a single TLV field.
@@ -89,6 +99,7 @@ int epp_ecap_single_TLV(char * buf, ep_enb_det * det)
 		ccap = (ep_ccap_rep *)(buf + sizeof(ep_TLV));
 
 		det->cells[det->nof_cells].pci       = ntohs(ccap->pci);
+		det->cells[det->nof_cells].cap       = ntohl(ccap->cap);
 		det->cells[det->nof_cells].DL_earfcn = ntohs(ccap->DL_earfcn);
 		det->cells[det->nof_cells].DL_prbs   = ccap->DL_prbs;
 		det->cells[det->nof_cells].UL_earfcn = ntohs(ccap->UL_earfcn);
@@ -140,10 +151,10 @@ int epp_ecap_rep(
 		tlv = (ep_TLV *)c;
 
 		/* Reading next TLV token will overflow the buffer? */
-		if(c + sizeof(ep_TLV) + ntohs(tlv->length) >= buf + size) {
+		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
 			ep_dbg_log(EP_DBG_3"P - ECAP Rep: TLV %d > %d\n",
-				ntohs(sizeof(ep_TLV)) + tlv->length,
-				(buf + size) - c);
+				(int)(sizeof(ep_TLV) + ntohs(tlv->length)),
+				(int)((buf + size) - c));
 			break;
 		}
 
@@ -157,20 +168,97 @@ int epp_ecap_rep(
 	return EP_SUCCESS;
 }
 
-int epf_ecap_req(char * buf, unsigned int size)
+int epp_ecap_rep_a(
+	char *        buf,
+	unsigned int  size,
+	ep_arena *    arena,
+	ep_enb_ldet * det)
 {
-	ep_ecap_req * rep = (ep_ecap_req *)buf;
+	char *        c;
+	ep_ecap_rep * rep = (ep_ecap_rep *)buf;
+	ep_ccap_rep * ccap;
+	ep_TLV *      tlv;
+	uint32_t      n   = 0;
 
-	if(size < sizeof(ep_ecap_req)) {
-		ep_dbg_log(EP_DBG_2"F - ECAP Req: Not enough space!\n");
-		return -1;
+	if(size < sizeof(ep_ecap_rep)) {
+		ep_dbg_log(EP_DBG_2"P - ECAP Rep: Not enough space!\n");
+		return EP_ERROR;
 	}
 
-	rep->dummy = 0;
+	if(!arena || !det) {
+		ep_dbg_log(EP_DBG_2"P - ECAP Rep: Invalid pointer!\n");
+		return EP_ERROR;
+	}
+
+	/* Count the cells first, to allocate exactly what's needed */
+	for(c = buf + sizeof(ep_ecap_rep); c + sizeof(ep_TLV) <= buf + size; ) {
+		tlv = (ep_TLV *)c;
+
+		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
+			ep_dbg_log(EP_DBG_3"P - ECAP Rep: TLV %d > %d\n",
+				(int)(sizeof(ep_TLV) + ntohs(tlv->length)),
+				(int)((buf + size) - c));
+			break;
+		}
+
+		if(ntohs(tlv->type) == EP_TLV_CELL_CAP &&
+			ntohs(tlv->length) >= sizeof(ep_ccap_rep))
+		{
+			n++;
+		}
+
+		c += sizeof(ep_TLV) + ntohs(tlv->length);
+	}
+
+	det->capmask   = ntohl(rep->cap);
+	det->nof_cells = 0;
+	det->cells     = 0;
+
+	ep_dbg_dump(EP_DBG_2"P - ECAP Rep: ", buf, sizeof(ep_ecap_rep));
+
+	if(!n) {
+		return EP_SUCCESS;
+	}
+
+	det->cells = ep_arena_alloc(arena, n * sizeof(ep_cell_det));
+
+	if(!det->cells) {
+		return EP_ERROR;
+	}
+
+	for(c = buf + sizeof(ep_ecap_rep); det->nof_cells < n; ) {
+		tlv = (ep_TLV *)c;
+
+		if(ntohs(tlv->type) == EP_TLV_CELL_CAP &&
+			ntohs(tlv->length) >= sizeof(ep_ccap_rep))
+		{
+			ccap = (ep_ccap_rep *)(c + sizeof(ep_TLV));
+
+			det->cells[det->nof_cells].pci       = ntohs(ccap->pci);
+			det->cells[det->nof_cells].cap       = ntohl(ccap->cap);
+			det->cells[det->nof_cells].DL_earfcn =
+				ntohs(ccap->DL_earfcn);
+			det->cells[det->nof_cells].DL_prbs   = ccap->DL_prbs;
+			det->cells[det->nof_cells].UL_earfcn =
+				ntohs(ccap->UL_earfcn);
+			det->cells[det->nof_cells].UL_prbs   = ccap->UL_prbs;
+
+			det->nof_cells++;
+		}
+
+		c += sizeof(ep_TLV) + ntohs(tlv->length);
+	}
+
+	return EP_SUCCESS;
+}
+
+void epf_ecap_req_w(ep_writer * w)
+{
+	ep_ecap_req * rep = (ep_ecap_req *)ep_w_put(w, sizeof(ep_ecap_req));
 
-	ep_dbg_dump(EP_DBG_2"F - ECAP Req: ", buf, sizeof(ep_ecap_req));
+	rep->dummy = 0;
 
-	return sizeof(ep_ecap_req);
+	ep_dbg_dump(EP_DBG_2"F - ECAP Req: ", (char *)rep, sizeof(ep_ecap_req));
 }
 
 int epp_ecap_req(char * buf, unsigned int size)
@@ -185,10 +273,64 @@ int epp_ecap_req(char * buf, unsigned int size)
 	return EP_SUCCESS;
 }
 
+/* FNV-1a step over 'n' bytes of a value, less significant byte first */
+static uint64_t ep_ecap_fnv(uint64_t h, uint64_t v, int n)
+{
+	int i;
+
+	for(i = 0; i < n; i++) {
+		h ^= (v >> (i * 8)) & 0xff;
+		h *= 0x100000001b3ULL;
+	}
+
+	return h;
+}
+
 /******************************************************************************
  * Public API                                                                 *
  ******************************************************************************/
 
+uint64_t ep_ecap_fingerprint(ep_enb_det * det)
+{
+	if(!det) {
+		return ~EP_HELLO_NO_HASH;
+	}
+
+	return ep_ecap_fingerprint_l(
+		det->capmask,
+		det->nof_cells < EP_ECAP_CELL_MAX ?
+			det->nof_cells : EP_ECAP_CELL_MAX,
+		det->cells);
+}
+
+uint64_t ep_ecap_fingerprint_l(
+	uint32_t      capmask,
+	uint32_t      nof_cells,
+	ep_cell_det * cells)
+{
+	int      i;
+	uint64_t h = 0xcbf29ce484222325ULL;
+
+	h = ep_ecap_fnv(h, capmask,   4);
+	h = ep_ecap_fnv(h, nof_cells, 4);
+
+	for(i = 0; cells && i < nof_cells; i++) {
+		h = ep_ecap_fnv(h, cells[i].pci,       2);
+		h = ep_ecap_fnv(h, cells[i].cap,       4);
+		h = ep_ecap_fnv(h, cells[i].DL_earfcn, 2);
+		h = ep_ecap_fnv(h, cells[i].UL_earfcn, 2);
+		h = ep_ecap_fnv(h, cells[i].DL_prbs,   1);
+		h = ep_ecap_fnv(h, cells[i].UL_prbs,   1);
+	}
+
+	/* Zero is reserved for "no fingerprint" */
+	if(h == EP_HELLO_NO_HASH) {
+		h = ~EP_HELLO_NO_HASH;
+	}
+
+	return h;
+}
+
 int epf_single_ecap_rep_fail(
 	char *        buf,
 	unsigned int  size,
@@ -196,49 +338,36 @@ int epf_single_ecap_rep_fail(
 	cell_id_t     cell_id,
 	mod_id_t      mod_id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single ECAP Fail: Invalid buffer!\n");
 		return EP_ERROR;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ecap_rep_fail_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single ECAP Fail: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_ECAP, EP_OPERATION_FAIL);
+	epf_ecap_rep_w(&w, 0);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_ECAP,
-		EP_OPERATION_FAIL);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ecap_rep(buf + ret, size - ret, 0);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ecap_rep_fail_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + epf_ecap_rep_size(0);
 }
 
 int epf_single_ecap_rep(
@@ -249,49 +378,84 @@ int epf_single_ecap_rep(
 	mod_id_t      mod_id,
 	ep_enb_det *  det)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single ECAP Rep: Invalid buffer!\n");
 		return EP_ERROR;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ecap_rep_size(det))) {
+		ep_dbg_log(EP_DBG_0"F - Single ECAP Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_ECAP, EP_OPERATION_UNSPECIFIED);
+	epf_ecap_rep_w(&w, det);
+
+	return epf_msg_end_w(&w);
+}
 
-	if(ms < 0) {
-		return ms;
+unsigned int epf_single_ecap_rep_size(ep_enb_det * det)
+{
+	if(!det) {
+		return EP_SINGLE_HDR_SIZE + epf_ecap_rep_size(0);
 	}
 
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_ECAP,
-		EP_OPERATION_UNSPECIFIED);
+	return EP_SINGLE_HDR_SIZE + epf_ecap_rep_size(
+		det->nof_cells < EP_ECAP_CELL_MAX ?
+			det->nof_cells : EP_ECAP_CELL_MAX);
+}
+
+int epf_single_ecap_rep_l(
+	char *        buf,
+	unsigned int  size,
+	enb_id_t      enb_id,
+	cell_id_t     cell_id,
+	mod_id_t      mod_id,
+	uint32_t      capmask,
+	uint32_t      nof_cells,
+	ep_cell_det * cells)
+{
+	ep_writer w;
 
-	if(ms < 0) {
-		return ms;
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - Single ECAP Rep: Invalid buffer!\n");
+		return EP_ERROR;
 	}
 
-	ret += ms;
-	ms   = epf_ecap_rep(buf + ret, size - ret, det);
+	ep_w_init(&w, buf, size);
 
-	if(ms < 0) {
-		return ms;
+	if(ep_w_need(&w, epf_single_ecap_rep_l_size(cells ? nof_cells : 0))) {
+		ep_dbg_log(EP_DBG_0"F - Single ECAP Rep: Not enough space!\n");
+		return -1;
 	}
 
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_ECAP, EP_OPERATION_UNSPECIFIED);
+	epf_ecap_rep_l_w(&w, capmask, nof_cells, cells);
 
-	return ret;
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_single_ecap_rep_l_size(uint32_t nof_cells)
+{
+	return EP_SINGLE_HDR_SIZE + epf_ecap_rep_size(nof_cells);
 }
 
 int epp_single_ecap_rep(
@@ -304,9 +468,37 @@ int epp_single_ecap_rep(
 		return EP_ERROR;
 	}
 
+	if(size < sizeof(ep_hdr) + sizeof(ep_s_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - Single ECAP Rep: Not enough space!\n");
+		return EP_ERROR;
+	}
+
 	return epp_ecap_rep(
-		buf + sizeof(ep_hdr) + sizeof(ep_s_hdr),
-		size,
+		buf  +  sizeof(ep_hdr) + sizeof(ep_s_hdr),
+		size - (sizeof(ep_hdr) + sizeof(ep_s_hdr)),
+		det);
+}
+
+int epp_single_ecap_rep_a(
+	char *        buf,
+	unsigned int  size,
+	ep_arena *    arena,
+	ep_enb_ldet * det)
+{
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"P - Single ECAP Rep: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(size < sizeof(ep_hdr) + sizeof(ep_s_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - Single ECAP Rep: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	return epp_ecap_rep_a(
+		buf  +  sizeof(ep_hdr) + sizeof(ep_s_hdr),
+		size - (sizeof(ep_hdr) + sizeof(ep_s_hdr)),
+		arena,
 		det);
 }
 
@@ -317,49 +509,36 @@ int epf_single_ecap_req(
 	cell_id_t     cell_id,
 	mod_id_t      mod_id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single ECAP Req: Invalid buffer!\n");
 		return EP_ERROR;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ecap_req_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single ECAP Req: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
+	epf_single_w(&w, EP_ACT_ECAP, EP_OPERATION_UNSPECIFIED);
+	epf_ecap_req_w(&w);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_ECAP,
-		EP_OPERATION_UNSPECIFIED);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ecap_req(buf + ret, size - ret);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ecap_req_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_ecap_req);
 }
 
 int epp_single_ecap_req(char * buf, unsigned int size)
@@ -14,27 +14,24 @@
  * limitations under the License.
  */
 
+#define _DEFAULT_SOURCE
+#include <endian.h>
 #include <netinet/in.h>
 
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_ACT(EP_ACT_HELLO)
+
 #include <emproto.h>
 
-int epf_hello_rep(
-	char *       buf,
-	unsigned int size,
-	uint32_t     id)
+void epf_hello_rep_w(ep_writer * w, uint32_t id)
 {
-	ep_hello_rep * hr = (ep_hello_rep *)buf;
-
-	if(size < sizeof(ep_hello_rep)) {
-		ep_dbg_log(EP_DBG_2"F - HELLO Rep: Not enough space!\n");
-		return -1;
-	}
+	ep_hello_rep * hr;
 
+	hr     = (ep_hello_rep *)ep_w_put(w, sizeof(ep_hello_rep));
 	hr->id = htonl(id);
 
-	ep_dbg_dump(EP_DBG_2"F - HELLO Rep: ", buf, sizeof(ep_hello_rep));
-
-	return sizeof(ep_hello_rep);
+	ep_dbg_dump(EP_DBG_2"F - HELLO Rep: ", 
+		(char *)hr, sizeof(ep_hello_rep));
 }
 
 int epp_hello_rep(
@@ -58,31 +55,47 @@ int epp_hello_rep(
 	return 0;
 }
 
-int epf_hello_req(
-	char *       buf,
-	unsigned int size,
-	uint32_t     id)
+unsigned int epf_hello_req_size(uint64_t hash)
 {
-	ep_hello_req * hr = (ep_hello_req *)buf;
+	return sizeof(ep_hello_req) +
+		(hash != EP_HELLO_NO_HASH ? sizeof(ep_hello_chash_TLV) : 0);
+}
 
-	if(size < sizeof(ep_hello_req)) {
-		ep_dbg_log(EP_DBG_2"F - HELLO Req: Not enough space!\n");
-		return -1;
-	}
+void epf_hello_req_w(ep_writer * w, uint32_t id, uint64_t hash)
+{
+	ep_hello_req *       hr;
+	ep_hello_chash_TLV * ht;
 
+	hr     = (ep_hello_req *)ep_w_put(w, sizeof(ep_hello_req));
 	hr->id = htonl(id);
 
-	ep_dbg_dump(EP_DBG_2"F - HELLO Req: ", buf, sizeof(ep_hello_req));
+	ep_dbg_dump(EP_DBG_2"F - HELLO Req: ", 
+		(char *)hr, sizeof(ep_hello_req));
+
+	if(hash == EP_HELLO_NO_HASH) {
+		return;
+	}
+
+	ht = (ep_hello_chash_TLV *)ep_w_put(w, sizeof(ep_hello_chash_TLV));
 
-	return sizeof(ep_hello_req);
+	ht->header.type   = htons(EP_TLV_ENB_CAP_HASH);
+	ht->header.length = htons(sizeof(ep_hello_chash));
+	ht->body.hash     = htobe64(hash);
+
+	ep_dbg_dump(EP_DBG_3"F - HELLO Hash TLV: ", 
+		(char *)ht, sizeof(ep_hello_chash_TLV));
 }
 
 int epp_hello_req(
 	char *       buf,
 	unsigned int size,
-	uint32_t *   id)
+	uint32_t *   id,
+	uint64_t *   hash)
 {
-	ep_hello_req * hr = (ep_hello_req *)buf;
+	char *               c  = buf + sizeof(ep_hello_req);
+	ep_hello_req *       hr = (ep_hello_req *)buf;
+	ep_TLV *             tlv;
+	ep_hello_chash_TLV * ht;
 
 	if(size < sizeof(ep_hello_req)) {
 		ep_dbg_log(EP_DBG_2"P - HELLO Req: Not enough space!\n");
@@ -95,9 +108,56 @@ int epp_hello_req(
 
 	ep_dbg_dump(EP_DBG_2"P - HELLO Req: ", buf, sizeof(ep_hello_req));
 
+	if(!hash) {
+		return 0;
+	}
+
+	*hash = EP_HELLO_NO_HASH;
+
+	/* Look for optional tokens until the end of the message */
+	while(c + sizeof(ep_TLV) <= buf + size) {
+		tlv = (ep_TLV *)c;
+
+		/* Reading next TLV token will overflow the buffer? */
+		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
+			ep_dbg_log(EP_DBG_3"P - HELLO Req: TLV %d > %d\n",
+				(int)(sizeof(ep_TLV) + ntohs(tlv->length)),
+				(int)((buf + size) - c));
+			break;
+		}
+
+		if(ntohs(tlv->type) == EP_TLV_ENB_CAP_HASH && 
+			ntohs(tlv->length) >= sizeof(ep_hello_chash))
+		{
+			ht    = (ep_hello_chash_TLV *)c;
+			*hash = be64toh(ht->body.hash);
+
+			ep_dbg_dump(EP_DBG_3"P - HELLO Hash TLV: ", 
+				c, sizeof(ep_hello_chash_TLV));
+		}
+
+		c += sizeof(ep_TLV) + ntohs(tlv->length);
+	}
+
 	return 0;
 }
 
+/* Size of the body of an Hello message, as reported by its header */
+int epp_hello_body(char * buf, unsigned int size, unsigned int hdr)
+{
+	unsigned int len = epp_msg_length(buf, size);
+
+	if(len > size) {
+		len = size;
+	}
+
+	if(len < hdr) {
+		return 0;
+	}
+
+	return len - hdr;
+}
+
 /******************************************************************************
  * Public API                                                                 *
  ******************************************************************************/
@@ -114,48 +174,54 @@ int epf_single_hello_req(
 	mod_id_t     mod_id,
 	uint32_t     id)
 {
-	int ms = 0;
-	int ret= 0;
+	return epf_single_hello_req_fp(
+		buf, size, enb_id, cell_id, mod_id, id, EP_HELLO_NO_HASH);
+}
+
+unsigned int epf_single_hello_req_size(void)
+{
+	return epf_single_hello_req_fp_size(EP_HELLO_NO_HASH);
+}
+
+int epf_single_hello_req_fp(
+	char *       buf,
+	unsigned int size,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	uint32_t     id,
+	uint64_t     hash)
+{
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single HELLO Req: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf, size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_hello_req_fp_size(hash))) {
+		ep_dbg_log(EP_DBG_0"F - Single HELLO Req: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
+	epf_single_w(&w, EP_ACT_HELLO, EP_OPERATION_UNSPECIFIED);
+	epf_hello_req_w(&w, id, hash);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_HELLO,
-		EP_OPERATION_UNSPECIFIED);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_hello_req(buf + ret, size - ret, id);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_hello_req_fp_size(uint64_t hash)
+{
+	return EP_SINGLE_HDR_SIZE + epf_hello_req_size(hash);
 }
 
 
@@ -163,6 +229,15 @@ int epp_single_hello_req(
 	char *       buf,
 	unsigned int size,
 	uint32_t *   id)
+{
+	return epp_single_hello_req_fp(buf, size, id, 0);
+}
+
+int epp_single_hello_req_fp(
+	char *       buf,
+	unsigned int size,
+	uint32_t *   id,
+	uint64_t *   hash)
 {
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"P - Single HELLO Req: Invalid buffer!\n");
@@ -171,8 +246,9 @@ int epp_single_hello_req(
 
 	return epp_hello_req(
 		buf + sizeof(ep_hdr) + sizeof(ep_s_hdr),
-		size,
-		id);
+		epp_hello_body(buf, size, sizeof(ep_hdr) + sizeof(ep_s_hdr)),
+		id,
+		hash);
 }
 
 int epf_single_hello_rep(
@@ -183,48 +259,36 @@ int epf_single_hello_rep(
 	mod_id_t     mod_id,
 	uint32_t     id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single HELLO Rep: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf, size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_hello_rep_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single HELLO Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_HELLO, EP_OPERATION_SUCCESS);
+	epf_hello_rep_w(&w, id);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_HELLO,
-		EP_OPERATION_SUCCESS);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_hello_rep(buf + ret, size - ret, id);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_hello_rep_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_hello_rep);
 }
 
 int epp_single_hello_rep(
@@ -255,55 +319,77 @@ int epf_sched_hello_req(
 	uint32_t     interval,
 	uint32_t     id)
 {
-	int ms = 0;
-	int ret= 0;
+	return epf_sched_hello_req_fp(
+		buf, 
+		size, 
+		enb_id, 
+		cell_id, 
+		mod_id, 
+		interval, 
+		id, 
+		EP_HELLO_NO_HASH);
+}
+
+unsigned int epf_sched_hello_req_size(void)
+{
+	return epf_sched_hello_req_fp_size(EP_HELLO_NO_HASH);
+}
+
+int epf_sched_hello_req_fp(
+	char *       buf,
+	unsigned int size,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	uint32_t     interval,
+	uint32_t     id,
+	uint64_t     hash)
+{
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Sched HELLO Req: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf, size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_sched_hello_req_fp_size(hash))) {
+		ep_dbg_log(EP_DBG_0"F - Sched HELLO Req: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SCHEDULE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
+	epf_schedule_w(&w, EP_ACT_HELLO, EP_OPERATION_UNSPECIFIED, interval);
+	epf_hello_req_w(&w, id, hash);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_schedule(
-		buf + ret,
-		size - ret,
-		EP_ACT_HELLO,
-		EP_OPERATION_UNSPECIFIED,
-		interval);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_hello_req(buf + ret, size - ret, id);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_sched_hello_req_fp_size(uint64_t hash)
+{
+	return EP_SCHED_HDR_SIZE + epf_hello_req_size(hash);
 }
 
 int epp_sched_hello_req(
 	char *       buf,
 	unsigned int size,
 	uint32_t *   id)
+{
+	return epp_sched_hello_req_fp(buf, size, id, 0);
+}
+
+int epp_sched_hello_req_fp(
+	char *       buf,
+	unsigned int size,
+	uint32_t *   id,
+	uint64_t *   hash)
 {
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"P - Sched HELLO Req: Invalid buffer!\n");
@@ -312,8 +398,9 @@ int epp_sched_hello_req(
 
 	return epp_hello_req(
 		buf + sizeof(ep_hdr) + sizeof(ep_c_hdr),
-		size,
-		id);
+		epp_hello_body(buf, size, sizeof(ep_hdr) + sizeof(ep_c_hdr)),
+		id,
+		hash);
 }
 
 int epf_sched_hello_rep(
@@ -325,44 +412,36 @@ int epf_sched_hello_rep(
 	uint32_t     interval,
 	uint32_t     id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Sched HELLO Rep: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf, size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_sched_hello_rep_size())) {
+		ep_dbg_log(EP_DBG_0"F - Sched HELLO Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SCHEDULE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_schedule_w(&w, EP_ACT_HELLO, EP_OPERATION_SUCCESS, interval);
+	epf_hello_rep_w(&w, id);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_schedule(
-		buf + ret,
-		size - ret,
-		EP_ACT_HELLO,
-		EP_OPERATION_SUCCESS,
-		interval);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_hello_rep(buf + ret, size - ret, id);
-
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_sched_hello_rep_size(void)
+{
+	return EP_SCHED_HDR_SIZE + sizeof(ep_hello_rep);
 }
 
 int epp_sched_hello_rep(
@@ -18,31 +18,27 @@
 #include <endian.h>
 #include <netinet/in.h>
 
+/* Trace points of the module */
+#define EP_TRC_CAT		(EP_TRC_ACT(EP_ACT_HANDOVER) |	\
+			 EP_TRC_ACT(EP_ACT_HO_BATCH))
+
 #include <emproto.h>
 
-int epf_ho_rep(
-	char *       buf,
-	unsigned int size,
+void epf_ho_rep_w(
+	ep_writer *  w,
 	enb_id_t     origin_eNB,
 	uint16_t     origin_pci,
 	uint16_t     origin_rnti,
 	uint16_t     target_rnti)
 {
-	ep_ho_rep * rep = (ep_ho_rep *)buf;
-
-	if(size < sizeof(ep_ho_rep)) {
-		ep_dbg_log(EP_DBG_2"F - HO Rep: Not enough space!\n");
-		return -1;
-	}
+	ep_ho_rep * rep = (ep_ho_rep *)ep_w_put(w, sizeof(ep_ho_rep));
 
 	rep->origin_eNB  = htobe64(origin_eNB);
 	rep->origin_pci  = htons(origin_pci);
 	rep->origin_rnti = htons(origin_rnti);
 	rep->target_rnti = htons(target_rnti);
 
-	ep_dbg_dump(EP_DBG_2"F - HO Rep:   ", buf, sizeof(ep_ho_rep));
-
-	return sizeof(ep_ho_rep);
+	ep_dbg_dump(EP_DBG_2"F - HO Rep:   ", (char *)rep, sizeof(ep_ho_rep));
 }
 
 int epp_ho_rep(
@@ -81,29 +77,21 @@ int epp_ho_rep(
 	return EP_SUCCESS;
 }
 
-int epf_ho_req(
-	char *       buf,
-	unsigned int size,
+void epf_ho_req_w(
+	ep_writer *  w,
 	uint16_t     rnti,
 	enb_id_t     enb,
 	uint16_t     pci,
 	uint8_t      cause)
 {
-	ep_ho_req * req = (ep_ho_req *)buf;
-
-	if(size < sizeof(ep_ho_req)) {
-		ep_dbg_log(EP_DBG_2"F - HO Req: Not enough space!\n");
-		return -1;
-	}
+	ep_ho_req * req = (ep_ho_req *)ep_w_put(w, sizeof(ep_ho_req));
 
 	req->rnti       = htons(rnti);
 	req->target_eNB = htobe64(enb);
 	req->target_pci = htons(pci);
 	req->cause      = cause;
 
-	ep_dbg_dump(EP_DBG_2"F - HO Req:   ", buf, sizeof(ep_ho_req));
-
-	return sizeof(ep_ho_req);
+	ep_dbg_dump(EP_DBG_2"F - HO Req:   ", (char *)req, sizeof(ep_ho_req));
 }
 
 int epp_ho_req(
@@ -142,6 +130,177 @@ int epp_ho_req(
 	return EP_SUCCESS;
 }
 
+unsigned int epf_hob_req_size(uint16_t nof_ho)
+{
+	return sizeof(ep_hob_req) + nof_ho * sizeof(ep_ho_req);
+}
+
+void epf_hob_req_w(ep_writer * w, uint16_t nof_ho, ep_ho_det * hos)
+{
+	ep_hob_req * req;
+	ep_ho_req *  ho;
+	int          i;
+
+	if(nof_ho > 0 && !hos) {
+		ep_dbg_log(EP_DBG_2"F - HOB Req: Invalid handovers!\n");
+		ep_w_fail(w);
+		return;
+	}
+
+	req = (ep_hob_req *)ep_w_put(w, sizeof(ep_hob_req));
+	ho  = (ep_ho_req *)ep_w_put(w, nof_ho * sizeof(ep_ho_req));
+
+	req->nof_ho = htons(nof_ho);
+
+	for(i = 0; i < nof_ho; i++) {
+		ho[i].rnti       = htons(hos[i].rnti);
+		ho[i].target_eNB = htobe64(hos[i].target_eNB);
+		ho[i].target_pci = htons(hos[i].target_pci);
+		ho[i].cause      = hos[i].cause;
+	}
+
+	ep_dbg_dump(
+		EP_DBG_2"F - HOB Req:  ",
+		(char *)req,
+		sizeof(ep_hob_req) + (nof_ho * sizeof(ep_ho_req)));
+}
+
+int epp_hob_req(
+	char *       buf,
+	unsigned int size,
+	uint16_t *   nof_ho,
+	uint16_t     max,
+	ep_ho_det *  hos)
+{
+	ep_hob_req * req = (ep_hob_req *)buf;
+	ep_ho_req *  ho  = (ep_ho_req *)(buf + sizeof(ep_hob_req));
+	uint16_t     n;
+	int          i;
+
+	if(size < sizeof(ep_hob_req)) {
+		ep_dbg_log(EP_DBG_2"P - HOB Req: Not enough space!\n");
+		return -1;
+	}
+
+	n = ntohs(req->nof_ho);
+
+	if(size < sizeof(ep_hob_req) + (n * sizeof(ep_ho_req))) {
+		ep_dbg_log(EP_DBG_2"P - HOB Req: Not enough space!\n");
+		return -1;
+	}
+
+	if(nof_ho) {
+		*nof_ho = n;
+	}
+
+	for(i = 0; hos && i < n && i < max; i++) {
+		hos[i].rnti       = ntohs(ho[i].rnti);
+		hos[i].target_eNB = be64toh(ho[i].target_eNB);
+		hos[i].target_pci = ntohs(ho[i].target_pci);
+		hos[i].cause      = ho[i].cause;
+	}
+
+	ep_dbg_dump(
+		EP_DBG_2"P - HOB Req:  ",
+		buf,
+		sizeof(ep_hob_req) + (n * sizeof(ep_ho_req)));
+
+	return EP_SUCCESS;
+}
+
+unsigned int epf_hob_rep_size(uint16_t nof_ho)
+{
+	return sizeof(ep_hob_rep) + nof_ho * sizeof(ep_hob_res);
+}
+
+void epf_hob_rep_w(
+	ep_writer *  w,
+	enb_id_t     origin_eNB,
+	uint16_t     origin_pci,
+	uint16_t     nof_ho,
+	ep_ho_out *  outs)
+{
+	ep_hob_rep * rep;
+	ep_hob_res * res;
+	int          i;
+
+	if(nof_ho > 0 && !outs) {
+		ep_dbg_log(EP_DBG_2"F - HOB Rep: Invalid outcomes!\n");
+		ep_w_fail(w);
+		return;
+	}
+
+	rep = (ep_hob_rep *)ep_w_put(w, sizeof(ep_hob_rep));
+	res = (ep_hob_res *)ep_w_put(w, nof_ho * sizeof(ep_hob_res));
+
+	rep->origin_eNB = htobe64(origin_eNB);
+	rep->origin_pci = htons(origin_pci);
+	rep->nof_ho     = htons(nof_ho);
+
+	for(i = 0; i < nof_ho; i++) {
+		res[i].rnti        = htons(outs[i].rnti);
+		res[i].target_rnti = htons(outs[i].target_rnti);
+		res[i].result      = (uint8_t)outs[i].result;
+	}
+
+	ep_dbg_dump(
+		EP_DBG_2"F - HOB Rep:  ",
+		(char *)rep,
+		sizeof(ep_hob_rep) + (nof_ho * sizeof(ep_hob_res)));
+}
+
+int epp_hob_rep(
+	char *       buf,
+	unsigned int size,
+	enb_id_t *   origin_eNB,
+	uint16_t *   origin_pci,
+	uint16_t *   nof_ho,
+	uint16_t     max,
+	ep_ho_out *  outs)
+{
+	ep_hob_rep * rep = (ep_hob_rep *)buf;
+	ep_hob_res * res = (ep_hob_res *)(buf + sizeof(ep_hob_rep));
+	uint16_t     n;
+	int          i;
+
+	if(size < sizeof(ep_hob_rep)) {
+		ep_dbg_log(EP_DBG_2"P - HOB Rep: Not enough space!\n");
+		return -1;
+	}
+
+	n = ntohs(rep->nof_ho);
+
+	if(size < sizeof(ep_hob_rep) + (n * sizeof(ep_hob_res))) {
+		ep_dbg_log(EP_DBG_2"P - HOB Rep: Not enough space!\n");
+		return -1;
+	}
+
+	if(origin_eNB) {
+		*origin_eNB = be64toh(rep->origin_eNB);
+	}
+
+	if(origin_pci) {
+		*origin_pci = ntohs(rep->origin_pci);
+	}
+
+	if(nof_ho) {
+		*nof_ho = n;
+	}
+
+	for(i = 0; outs && i < n && i < max; i++) {
+		outs[i].rnti        = ntohs(res[i].rnti);
+		outs[i].target_rnti = ntohs(res[i].target_rnti);
+		outs[i].result      = (ep_op_type)res[i].result;
+	}
+
+	ep_dbg_dump(
+		EP_DBG_2"P - HOB Rep:  ",
+		buf,
+		sizeof(ep_hob_rep) + (n * sizeof(ep_hob_res)));
+
+	return EP_SUCCESS;
+}
+
 /******************************************************************************
  * Public API                                                                 *
  ******************************************************************************/
@@ -157,55 +316,36 @@ int epf_single_ho_rep_fail(
 	uint16_t     origin_rnti,
 	uint16_t     target_rnti)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single HO Fail: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms += epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ho_rep_fail_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single HO Fail: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_HANDOVER, EP_OPERATION_FAIL);
+	epf_ho_rep_w(&w, origin_eNB, origin_pci, origin_rnti, target_rnti);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_HANDOVER,
-		EP_OPERATION_FAIL);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ho_rep(
-		buf + ret,
-		size - ret,
-		origin_eNB, 
-		origin_pci, 
-		origin_rnti, 
-		target_rnti);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ho_rep_fail_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_ho_rep);
 }
 
 int epf_single_ho_rep_ns(
@@ -219,56 +359,36 @@ int epf_single_ho_rep_ns(
 	uint16_t     origin_rnti,
 	uint16_t     target_rnti)
 {
-	int ms = 0;
-	int ret= 0 ;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single HO NS: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ho_rep_ns_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single HO NS: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_HANDOVER, EP_OPERATION_NOT_SUPPORTED);
+	epf_ho_rep_w(&w, origin_eNB, origin_pci, origin_rnti, target_rnti);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_HANDOVER,
-		EP_OPERATION_NOT_SUPPORTED);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ho_rep(
-		buf + ret,
-		size - ret,
-		origin_eNB,
-		origin_pci,
-		origin_rnti,
-		target_rnti);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ho_rep_ns_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_ho_rep);
 }
 
 int epf_single_ho_rep(
@@ -282,56 +402,36 @@ int epf_single_ho_rep(
 	uint16_t     origin_rnti,
 	uint16_t     target_rnti)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single HO Rep: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ho_rep_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single HO Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_HANDOVER, EP_OPERATION_SUCCESS);
+	epf_ho_rep_w(&w, origin_eNB, origin_pci, origin_rnti, target_rnti);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_HANDOVER,
-		EP_OPERATION_SUCCESS);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ho_rep(
-		buf + ret,
-		size - ret,
-		origin_eNB,
-		origin_pci,
-		origin_rnti,
-		target_rnti);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ho_rep_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_ho_rep);
 }
 
 int epp_single_ho_rep(
@@ -367,50 +467,36 @@ int epf_single_ho_req(
 	uint16_t     pci,
 	uint8_t      cause)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single HO Req: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ho_req_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single HO Req: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_SINGLE_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
+	epf_single_w(&w, EP_ACT_HANDOVER, EP_OPERATION_UNSPECIFIED);
+	epf_ho_req_w(&w, rnti, enb, pci, cause);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_single(
-		buf + ret,
-		size - ret,
-		EP_ACT_HANDOVER,
-		EP_OPERATION_UNSPECIFIED);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_ho_req(buf + ret, size - ret, rnti, enb, pci, cause);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_single_ho_req_size(void)
+{
+	return EP_SINGLE_HDR_SIZE + sizeof(ep_ho_req);
 }
 
 int epp_single_ho_req(
@@ -434,3 +520,179 @@ int epp_single_ho_req(
 		pci,
 		cause);
 }
+
+int epf_single_ho_batch_req(
+	char *       buf,
+	unsigned int size,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	uint16_t     nof_ho,
+	ep_ho_det *  hos)
+{
+	ep_writer w;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - Single HOB Req: Invalid buffer!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ho_batch_req_size(nof_ho))) {
+		ep_dbg_log(EP_DBG_0"F - Single HOB Req: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REQ);
+	epf_single_w(&w, EP_ACT_HO_BATCH, EP_OPERATION_UNSPECIFIED);
+	epf_hob_req_w(&w, nof_ho, hos);
+
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_single_ho_batch_req_size(uint16_t nof_ho)
+{
+	return EP_SINGLE_HDR_SIZE + epf_hob_req_size(nof_ho);
+}
+
+int epp_single_ho_batch_req(
+	char *       buf,
+	unsigned int size,
+	uint16_t *   nof_ho,
+	uint16_t     max,
+	ep_ho_det *  hos)
+{
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"P - Single HOB Req: Invalid buffer!\n");
+		return -1;
+	}
+
+	if(size < sizeof(ep_hdr) + sizeof(ep_s_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - Single HOB Req: Not enough space!\n");
+		return -1;
+	}
+
+	return epp_hob_req(
+		buf + sizeof(ep_hdr) + sizeof(ep_s_hdr),
+		size - sizeof(ep_hdr) - sizeof(ep_s_hdr),
+		nof_ho,
+		max,
+		hos);
+}
+
+int epf_single_ho_batch_rep(
+	char *       buf,
+	unsigned int size,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id,
+	enb_id_t     origin_eNB,
+	uint16_t     origin_pci,
+	uint16_t     nof_ho,
+	ep_ho_out *  outs)
+{
+	ep_writer w;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - Single HOB Rep: Invalid buffer!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ho_batch_rep_size(nof_ho))) {
+		ep_dbg_log(EP_DBG_0"F - Single HOB Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_HO_BATCH, EP_OPERATION_UNSPECIFIED);
+	epf_hob_rep_w(&w, origin_eNB, origin_pci, nof_ho, outs);
+
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_single_ho_batch_rep_size(uint16_t nof_ho)
+{
+	return EP_SINGLE_HDR_SIZE + epf_hob_rep_size(nof_ho);
+}
+
+int epf_single_ho_batch_rep_ns(
+	char *       buf,
+	unsigned int size,
+	enb_id_t     enb_id,
+	cell_id_t    cell_id,
+	mod_id_t     mod_id)
+{
+	ep_writer w;
+
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"F - Single HOB NS: Invalid buffer!\n");
+		return -1;
+	}
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_single_ho_batch_rep_ns_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single HOB NS: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
+		EP_TYPE_SINGLE_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REP);
+	epf_single_w(&w, EP_ACT_HO_BATCH, EP_OPERATION_NOT_SUPPORTED);
+
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_single_ho_batch_rep_ns_size(void)
+{
+	return EP_SINGLE_HDR_SIZE;
+}
+
+int epp_single_ho_batch_rep(
+	char *       buf,
+	unsigned int size,
+	enb_id_t *   origin_eNB,
+	uint16_t *   origin_pci,
+	uint16_t *   nof_ho,
+	uint16_t     max,
+	ep_ho_out *  outs)
+{
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"P - Single HOB Rep: Invalid buffer!\n");
+		return -1;
+	}
+
+	if(size < sizeof(ep_hdr) + sizeof(ep_s_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - Single HOB Rep: Not enough space!\n");
+		return -1;
+	}
+
+	return epp_hob_rep(
+		buf + sizeof(ep_hdr) + sizeof(ep_s_hdr),
+		size - sizeof(ep_hdr) - sizeof(ep_s_hdr),
+		origin_eNB,
+		origin_pci,
+		nof_ho,
+		max,
+		outs);
+}
@@ -0,0 +1,244 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_ACT(EP_ACT_HELLO)
+
+#include <emproto.h>
+
+/* Return an agent element to the free list */
+static void ep_ka_free(ep_ka * ka, ep_ka_agent * a)
+{
+	a->next  = ka->free;
+	ka->free = (a - ka->agents) + 1;
+}
+
+/* Keep alive period of an agent expired */
+static void ep_ka_expired(ep_tw_timer * t, void * arg)
+{
+	ep_ka *       ka = (ep_ka *)arg;
+	ep_ka_agent * a  = (ep_ka_agent *)t;
+
+	ep_hmap_del(&ka->map, a->enb_id, 0);
+	ep_ka_free(ka, a);
+
+	ka->nof_expired++;
+
+	ep_dbg_log(EP_DBG_0"KA: Agent %" PRIu64 " is down!\n", a->enb_id);
+
+	if(ka->cb) {
+		ka->cb(a->enb_id, ka->arg);
+	}
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+int ep_ka_init(
+	ep_ka *      ka,
+	uint32_t     max,
+	uint32_t     period,
+	uint64_t     now,
+	ep_ka_cb     cb,
+	void *       arg)
+{
+	uint32_t i;
+
+	if(!ka || max == 0) {
+		ep_dbg_log(EP_DBG_0"KA: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	if(ep_hmap_init(&ka->map, max)) {
+		return EP_ERROR;
+	}
+
+	ka->agents = calloc(max, sizeof(ep_ka_agent));
+
+	if(!ka->agents) {
+		ep_dbg_log(EP_DBG_0"KA: Not enough memory!\n");
+		ep_hmap_release(&ka->map);
+		return EP_ERROR;
+	}
+
+	ep_tw_init(&ka->wheel, now);
+
+	ka->max         = max;
+	ka->free        = 0;
+	ka->period      = period ? period : EP_KA_PERIOD_DEFAULT;
+	ka->nof_expired = 0;
+	ka->cb          = cb;
+	ka->arg         = arg;
+
+	/* Lower elements are used first */
+	for(i = max; i > 0; i--) {
+		ep_tw_timer_init(&ka->agents[i - 1].timer, ep_ka_expired, ka);
+		ep_ka_free(ka, &ka->agents[i - 1]);
+	}
+
+	return EP_SUCCESS;
+}
+
+void ep_ka_release(ep_ka * ka)
+{
+	if(!ka) {
+		return;
+	}
+
+	ep_hmap_release(&ka->map);
+	free(ka->agents);
+
+	ka->agents = 0;
+	ka->max    = 0;
+	ka->free   = 0;
+}
+
+int ep_ka_hello(ep_ka * ka, char * buf, unsigned int size, uint64_t now)
+{
+	enb_id_t    enb_id;
+	ep_msg_type type;
+	int         ret;
+
+	if(!ka || !buf) {
+		ep_dbg_log(EP_DBG_0"KA: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(epp_head_peek(buf, size, &type, &enb_id, 0, 0, 0)) {
+		return EP_ERROR;
+	}
+
+	if(epp_dir(buf, size) != EP_HDR_FLAG_DIR_REQ) {
+		ep_dbg_log(EP_DBG_0"KA: Not an Hello request!\n");
+		return EP_ERROR;
+	}
+
+	switch(type) {
+	case EP_TYPE_SINGLE_MSG:
+		if(epp_single_type(buf, size) != EP_ACT_HELLO) {
+			ret = EP_ERROR;
+			break;
+		}
+
+		ret = epp_single_hello_req(buf, size, 0);
+		break;
+	case EP_TYPE_SCHEDULE_MSG:
+		if(epp_schedule_type(buf, size) != EP_ACT_HELLO) {
+			ret = EP_ERROR;
+			break;
+		}
+
+		ret = epp_sched_hello_req(buf, size, 0);
+		break;
+	default:
+		ret = EP_ERROR;
+		break;
+	}
+
+	if(ret) {
+		ep_dbg_log(EP_DBG_0"KA: Not an Hello request!\n");
+		return EP_ERROR;
+	}
+
+	return ep_ka_touch(ka, enb_id, now);
+}
+
+int ep_ka_touch(ep_ka * ka, enb_id_t enb_id, uint64_t now)
+{
+	uint32_t      i;
+	uint64_t      deadline;
+	ep_ka_agent * a;
+
+	if(!ka) {
+		return EP_ERROR;
+	}
+
+	i = ep_hmap_get(&ka->map, enb_id, 0);
+
+	/* New agent to track */
+	if(!i) {
+		if(!ka->free) {
+			ep_dbg_log(EP_DBG_0"KA: Too many agents!\n");
+			return EP_ERROR;
+		}
+
+		i        = ka->free;
+		ka->free = ka->agents[i - 1].next;
+
+		if(ep_hmap_put(&ka->map, enb_id, 0, i)) {
+			ep_ka_free(ka, &ka->agents[i - 1]);
+			return EP_ERROR;
+		}
+
+		ka->agents[i - 1].enb_id = enb_id;
+	}
+
+	a        = &ka->agents[i - 1];
+	a->last  = now;
+	deadline = now + ka->period;
+
+	/* Re-arm the timer; O(1) whatever the number of agents */
+	return ep_tw_add(
+		&ka->wheel,
+		&a->timer,
+		deadline > ka->wheel.now ? deadline - ka->wheel.now : 0);
+}
+
+int ep_ka_remove(ep_ka * ka, enb_id_t enb_id)
+{
+	uint32_t i;
+
+	if(!ka) {
+		return EP_ERROR;
+	}
+
+	i = ep_hmap_del(&ka->map, enb_id, 0);
+
+	if(!i) {
+		return EP_ERROR;
+	}
+
+	ep_tw_cancel(&ka->wheel, &ka->agents[i - 1].timer);
+	ep_ka_free(ka, &ka->agents[i - 1]);
+
+	return EP_SUCCESS;
+}
+
+int ep_ka_alive(ep_ka * ka, enb_id_t enb_id)
+{
+	if(!ka) {
+		return 0;
+	}
+
+	return ep_hmap_get(&ka->map, enb_id, 0) != 0;
+}
+
+int ep_ka_check(ep_ka * ka, uint64_t now)
+{
+	if(!ka) {
+		return 0;
+	}
+
+	ka->nof_expired = 0;
+
+	ep_tw_advance(&ka->wheel, now);
+
+	return ka->nof_expired;
+}
@@ -16,28 +16,31 @@
 
 #include <netinet/in.h>
 
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_ACT(EP_ACT_MAC_REPORT)
+
 #include <emproto.h>
 
-int epf_macrep_rep(
-	char *          buf,
-	unsigned int    size,
-	ep_macrep_det * report)
+void epf_macrep_rep_w(ep_writer * w, ep_macrep_det * report)
 {
-	ep_macrep_rep * rep = (ep_macrep_rep *)buf;
-
-	if(size < sizeof(ep_macrep_rep)) {
-		ep_dbg_log("F - MREP Rep: Not enough space!\n");
-		return -1;
+	ep_macrep_rep * rep;
+
+	rep = (ep_macrep_rep *)ep_w_put(w, sizeof(ep_macrep_rep));
+
+	if(!report) {
+		rep->DL_prbs_used   = 0;
+		rep->DL_prbs_total  = 0;
+		rep->UL_prbs_used   = 0;
+		rep->UL_prbs_total  = 0;
+	} else {
+		rep->DL_prbs_used   = htonl(report->DL_prbs_used);
+		rep->DL_prbs_total  = report->DL_prbs_total;
+		rep->UL_prbs_used   = htonl(report->UL_prbs_used);
+		rep->UL_prbs_total  = report->UL_prbs_total;
 	}
 
-	rep->DL_prbs_used   = htonl(report->DL_prbs_used);
-	rep->DL_prbs_total  = report->DL_prbs_total;
-	rep->UL_prbs_used   = htonl(report->UL_prbs_used);
-	rep->UL_prbs_total  = report->UL_prbs_total;
-
-	ep_dbg_dump(EP_DBG_2"F - MREP Rep: ", buf, sizeof(ep_macrep_rep));
-
-	return sizeof(ep_macrep_rep);
+	ep_dbg_dump(EP_DBG_2"F - MREP Rep: ", 
+		(char *)rep, sizeof(ep_macrep_rep));
 }
 
 int epp_macrep_rep(
@@ -64,20 +67,74 @@ int epp_macrep_rep(
 	return EP_SUCCESS;
 }
 
-int epf_macrep_req(char * buf, unsigned int size, uint16_t interval)
+void epf_macrep_unch_w(ep_writer * w, uint32_t seq)
 {
-	ep_macrep_req * req = (ep_macrep_req *)buf;
+	ep_macrep_unch * unch;
 
-	if(size < sizeof(ep_macrep_req)) {
-		ep_dbg_log(EP_DBG_2"F - MREP Req: Not enough space!\n");
+	unch      = (ep_macrep_unch *)ep_w_put(w, sizeof(ep_macrep_unch));
+	unch->seq = htonl(seq);
+
+	ep_dbg_dump(EP_DBG_2"F - MREP Unch: ", 
+		(char *)unch, sizeof(ep_macrep_unch));
+}
+
+int epp_macrep_unch(char * buf, unsigned int size, uint32_t * seq)
+{
+	ep_macrep_unch * unch = (ep_macrep_unch *)buf;
+
+	if(size < sizeof(ep_macrep_unch)) {
+		ep_dbg_log(EP_DBG_2"P - MREP Unch: Not enough space!\n");
 		return -1;
 	}
 
-	req->interval = htons(interval);
+	if(seq) {
+		*seq = ntohl(unch->seq);
+	}
 
-	ep_dbg_dump(EP_DBG_2"F - MREP Req: ", buf, sizeof(ep_macrep_req));
+	ep_dbg_dump(EP_DBG_2"P - MREP Unch: ", buf, sizeof(ep_macrep_unch));
+
+	return EP_SUCCESS;
+}
+
+/* Check if a report can be considered unchanged since the last one sent.
+ * Counters of the used PRBs are allowed to overflow.
+ */
+static int ep_macrep_sup_same(ep_macrep_sup * sup, ep_macrep_det * det)
+{
+	if(!sup->valid) {
+		return 0;
+	}
+
+	if(det->DL_prbs_total != sup->last.DL_prbs_total ||
+		det->UL_prbs_total != sup->last.UL_prbs_total)
+	{
+		return 0;
+	}
+
+	if((uint32_t)(det->DL_prbs_used - sup->last.DL_prbs_used) > 
+		sup->tolerance) 
+	{
+		return 0;
+	}
+
+	if((uint32_t)(det->UL_prbs_used - sup->last.UL_prbs_used) > 
+		sup->tolerance) 
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+void epf_macrep_req_w(ep_writer * w, uint16_t interval)
+{
+	ep_macrep_req * req;
+
+	req           = (ep_macrep_req *)ep_w_put(w, sizeof(ep_macrep_req));
+	req->interval = htons(interval);
 
-	return sizeof(ep_macrep_req);
+	ep_dbg_dump(EP_DBG_2"F - MREP Req: ", 
+		(char *)req, sizeof(ep_macrep_req));
 }
 
 int epp_macrep_req(char * buf, unsigned int size, uint16_t * interval)
@@ -109,50 +166,37 @@ int epf_trigger_macrep_rep_fail(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single MACREP Fail: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_trigger_macrep_rep_fail_size())) {
+		ep_dbg_log(EP_DBG_0
+			"F - Single MACREP Fail: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_TRIGGER_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_trigger_w(&w, EP_ACT_MAC_REPORT, EP_OPERATION_FAIL);
+	epf_macrep_rep_w(&w, 0);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_trigger(
-		buf + ret,
-		size - ret,
-		EP_ACT_MAC_REPORT,
-		EP_OPERATION_FAIL);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_macrep_rep(buf + ret, size - ret, 0);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_trigger_macrep_rep_fail_size(void)
+{
+	return EP_TRIGGER_HDR_SIZE + sizeof(ep_macrep_rep);
 }
 
 int epf_trigger_macrep_rep_ns(
@@ -162,120 +206,211 @@ int epf_trigger_macrep_rep_ns(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single MACREP NS: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_trigger_macrep_rep_ns_size())) {
+		ep_dbg_log(EP_DBG_0"F - Single MACREP NS: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_TRIGGER_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_trigger_w(&w, EP_ACT_MAC_REPORT, EP_OPERATION_NOT_SUPPORTED);
+	epf_macrep_rep_w(&w, 0);
+
+	return epf_msg_end_w(&w);
+}
+
+unsigned int epf_trigger_macrep_rep_ns_size(void)
+{
+	return EP_TRIGGER_HDR_SIZE + sizeof(ep_macrep_rep);
+}
+
+int epf_trigger_macrep_rep(
+	char *          buf,
+	unsigned int    size,
+	enb_id_t        enb_id,
+	cell_id_t       cell_id,
+	mod_id_t        mod_id,
+	ep_macrep_det * det)
+{
+	ep_writer w;
 
-	if(ms < 0) {
-		return ms;
+	if(!buf || !det) {
+		ep_dbg_log(EP_DBG_0"F - Single MACREP Rep: Invalid buffer!\n");
+		return -1;
 	}
 
-	ret += ms;
-	ms   = epf_trigger(
-		buf + ret,
-		size - ret,
-		EP_ACT_MAC_REPORT,
-		EP_OPERATION_NOT_SUPPORTED);
+	ep_w_init(&w, buf, size);
 
-	if(ms < 0) {
-		return ms;
+	if(ep_w_need(&w, epf_trigger_macrep_rep_size())) {
+		ep_dbg_log(EP_DBG_0
+			"F - Single MACREP Rep: Not enough space!\n");
+		return -1;
 	}
 
-	ret += ms;
-	ms   = epf_macrep_rep(buf + ret, size - ret, 0);
+	epf_head_w(
+		&w,
+		EP_TYPE_TRIGGER_MSG,
+		enb_id,
+		cell_id,
+		mod_id,
+		EP_HDR_FLAG_DIR_REP);
+	epf_trigger_w(&w, EP_ACT_MAC_REPORT, EP_OPERATION_SUCCESS);
+	epf_macrep_rep_w(&w, det);
+
+	return epf_msg_end_w(&w);
+}
 
-	if(ms < 0) {
-		return ms;
+unsigned int epf_trigger_macrep_rep_size(void)
+{
+	return EP_TRIGGER_HDR_SIZE + sizeof(ep_macrep_rep);
+}
+
+int epp_trigger_macrep_rep(
+	char *          buf,
+	unsigned int    size,
+	ep_macrep_det * det)
+{
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"P - Single MACREP Rep: Invalid buffer!\n");
+		return -1;
 	}
 
-	ret += ms;
+	return epp_macrep_rep(
+		buf + sizeof(ep_hdr) + sizeof(ep_t_hdr),
+		size,
+		det);
+}
 
-	epf_msg_length(buf, size, ret);
+void ep_macrep_sup_init(
+	ep_macrep_sup *    sup,
+	ep_macrep_sup_mode mode,
+	uint32_t           tolerance)
+{
+	if(!sup) {
+		return;
+	}
 
-	return ret;
+	sup->mode      = mode;
+	sup->tolerance = tolerance;
+	sup->valid     = 0;
+	sup->last_seq  = 0;
 }
 
-int epf_trigger_macrep_rep(
+int epf_trigger_macrep_rep_sup(
 	char *          buf,
 	unsigned int    size,
 	enb_id_t        enb_id,
 	cell_id_t       cell_id,
 	mod_id_t        mod_id,
+	uint32_t        seq,
+	ep_macrep_sup * sup,
 	ep_macrep_det * det)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
+	int       ret;
 
-	if(!buf || !det) {
-		ep_dbg_log(EP_DBG_0"F - Single MACREP Rep: Invalid buffer!\n");
+	if(!buf || !sup || !det) {
+		ep_dbg_log(EP_DBG_0"F - Single MACREP Sup: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	/* Something changed, or suppression is off; send the whole report */
+	if(sup->mode == EP_MACREP_SUP_OFF || !ep_macrep_sup_same(sup, det)) {
+		ret = epf_trigger_macrep_rep(
+			buf, size, enb_id, cell_id, mod_id, det);
+
+		if(ret < 0) {
+			return ret;
+		}
+
+		epf_seq(buf, size, seq);
+
+		sup->last     = *det;
+		sup->last_seq = seq;
+		sup->valid    = 1;
+
+		return ret;
+	}
+
+	if(sup->mode == EP_MACREP_SUP_SKIP) {
+		return 0;
+	}
+
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, EP_TRIGGER_HDR_SIZE + sizeof(ep_macrep_unch))) {
+		ep_dbg_log(EP_DBG_0
+			"F - Single MACREP Sup: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_TRIGGER_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_trigger_w(&w, EP_ACT_MAC_REPORT, EP_OPERATION_UNCHANGED);
+	epf_macrep_unch_w(&w, sup->last_seq);
 
-	if(ms < 0) {
-		return ms;
-	}
+	epf_seq(buf, size, seq);
 
-	ret += ms;
-	ms   = epf_trigger(
-		buf + ret,
-		size - ret,
-		EP_ACT_MAC_REPORT,
-		EP_OPERATION_SUCCESS);
+	return epf_msg_end_w(&w);
+}
 
-	if(ms < 0) {
-		return ms;
+unsigned int epf_trigger_macrep_rep_sup_size(
+	ep_macrep_sup * sup,
+	ep_macrep_det * det)
+{
+	if(!sup || !det) {
+		return 0;
 	}
 
-	ret += ms;
-	ms   = epf_macrep_rep(buf + ret, size - ret, det);
-
-	if(ms < 0) {
-		return ms;
+	if(sup->mode == EP_MACREP_SUP_OFF || !ep_macrep_sup_same(sup, det)) {
+		return EP_TRIGGER_HDR_SIZE + sizeof(ep_macrep_rep);
 	}
 
-	ret += ms;
-
-	epf_msg_length(buf, size, ret);
+	if(sup->mode == EP_MACREP_SUP_SKIP) {
+		return 0;
+	}
 
-	return ret;
+	return EP_TRIGGER_HDR_SIZE + sizeof(ep_macrep_unch);
 }
 
-int epp_trigger_macrep_rep(
+int epp_trigger_macrep_unch(
 	char *          buf,
 	unsigned int    size,
-	ep_macrep_det * det)
+	uint32_t *      seq)
 {
 	if(!buf) {
-		ep_dbg_log(EP_DBG_0"P - Single MACREP Rep: Invalid buffer!\n");
+		ep_dbg_log(EP_DBG_0"P - Single MACREP Unch: Invalid buffer!\n");
 		return -1;
 	}
 
-	return epp_macrep_rep(
-		buf + sizeof(ep_hdr) + sizeof(ep_t_hdr),
-		size,
-		det);
+	if(size < sizeof(ep_hdr) + sizeof(ep_t_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - Single MACREP Unch: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	return epp_macrep_unch(
+		buf  +  sizeof(ep_hdr) + sizeof(ep_t_hdr),
+		size - (sizeof(ep_hdr) + sizeof(ep_t_hdr)),
+		seq);
 }
 
 int epf_trigger_macrep_req(
@@ -286,49 +421,37 @@ int epf_trigger_macrep_req(
 	mod_id_t     mod_id,
 	uint16_t     interval)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Single MACREP Req: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_trigger_macrep_req_size())) {
+		ep_dbg_log(EP_DBG_0
+			"F - Single MACREP Req: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_TRIGGER_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
+	epf_trigger_w(&w, EP_ACT_MAC_REPORT, EP_OPERATION_UNSPECIFIED);
+	epf_macrep_req_w(&w, interval);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_trigger(
-		buf + ret,
-		size - ret,
-		EP_ACT_MAC_REPORT,
-		EP_OPERATION_UNSPECIFIED);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_macrep_req(buf + ret, size - ret, interval);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_trigger_macrep_req_size(void)
+{
+	return EP_TRIGGER_HDR_SIZE + sizeof(ep_macrep_req);
 }
 
 int epp_trigger_macrep_req(
@@ -16,60 +16,9 @@
 
 #include <arpa/inet.h>
 
-#include <emproto.h>
-
-/******************************************************************************
- * Public API                                                                 *
- ******************************************************************************/
-
-int epf_schedule(
-	char *       buf,
-	unsigned int size,
-	ep_act_type  type,
-	ep_op_type   op,
-	uint32_t     interval)
-{
-	ep_c_hdr * h = (ep_c_hdr *)(buf);
-
-	if(size < sizeof(ep_hdr) + sizeof(ep_c_hdr)) {
-		ep_dbg_log(EP_DBG_1"F - SCHED: Not enough space!\n");
-		return -1;
-	}
-
-	h->type     = htons(type);
-	h->op       = (uint8_t)op;
-	h->interval = htonl(interval);
-	
-	ep_dbg_dump(EP_DBG_1"F - SCHE: ", buf, sizeof(ep_c_hdr));
-
-	return sizeof(ep_c_hdr);
-}
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_HDR
 
-uint32_t epp_sched_interval(char * buf, unsigned int size)
-{
-	ep_c_hdr * h = (ep_c_hdr *)(buf + sizeof(ep_hdr));
-
-	if(size < sizeof(ep_hdr) + sizeof(ep_c_hdr)) {
-		ep_dbg_log(EP_DBG_0"P - SCHED Int: Not enough space!\n");
-		return 0;
-	}
-
-	return ntohl(h->interval);
-}
-
-ep_act_type epp_schedule_type(char * buf, unsigned int size)
-{
-	ep_c_hdr * h = (ep_c_hdr *)(buf + sizeof(ep_hdr));
-
-	if(size < sizeof(ep_hdr) + sizeof(ep_c_hdr)) {
-		ep_dbg_log(EP_DBG_0"P - SCHED Type: Not enough space!\n");
-		return EP_ACT_INVALID;
-	}
-
-	ep_dbg_dump(
-		EP_DBG_1"P - SCHE: ", 
-		buf + sizeof(ep_hdr), 
-		sizeof(ep_c_hdr));
+#include <emproto.h>
 
-	return ntohs(h->type);
-}
+#include <emproto/v1/epsched_inl.h>
@@ -16,58 +16,9 @@
 
 #include <arpa/inet.h>
 
-#include <emproto.h>
-
-int epf_single(
-	char *       buf, 
-	unsigned int size,
-	ep_act_type  type,
-	ep_op_type   op)
-{
-	ep_s_hdr * h = (ep_s_hdr *)(buf);
-
-	if(size < sizeof(ep_s_hdr)) {
-		ep_dbg_log(EP_DBG_1"F - SING: Not enough space!\n");
-		return -1;
-	}
-
-	h->type = htons(type);
-	h->op   = (uint8_t)op;
-
-	ep_dbg_dump(EP_DBG_1"F - SING: ", buf, sizeof(ep_s_hdr));
-
-	return sizeof(ep_s_hdr);
-}
-
-/******************************************************************************
- * Public API                                                                 *
- ******************************************************************************/
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_HDR
 
-ep_act_type epp_single_type(char * buf, unsigned int size)
-{
-	ep_s_hdr * h = (ep_s_hdr *)(buf + sizeof(ep_hdr));
-
-	if(size < sizeof(ep_hdr) + sizeof(ep_s_hdr)) {
-		ep_dbg_log(EP_DBG_0"P - Single Type: Not enough space!\n");
-		return EP_ACT_INVALID;
-	}
-
-	ep_dbg_dump(
-		EP_DBG_1"P - SING: ", 
-		buf + sizeof(ep_hdr), 
-		sizeof(ep_s_hdr));
-
-	return ntohs(h->type);
-}
-
-ep_op_type epp_single_op(char * buf, unsigned int size)
-{
-	ep_s_hdr * h = (ep_s_hdr *)(buf + sizeof(ep_hdr));
-
-	if(size < sizeof(ep_hdr) + sizeof(ep_s_hdr)) {
-		ep_dbg_log(EP_DBG_0"P - Single Op: Not enough space!\n");
-		return EP_ERROR;
-	}
+#include <emproto.h>
 
-	return (ep_op_type)h->op;
-}
+#include <emproto/v1/epsingle_inl.h>
@@ -0,0 +1,1156 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _DEFAULT_SOURCE
+#include <endian.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+
+/* Trace points of the module */
+#define EP_TRC_CAT		(EP_TRC_ACT(EP_ACT_RAN_SLICE) |	\
+			 EP_TRC_ACT(EP_ACT_RAN_SLICE_BULK))
+
+#include <emproto.h>
+
+/* Make room for 'nof' users in a slice */
+static int ep_ran_stab_room(ep_ran_stab_ent * e, uint32_t nof)
+{
+	rnti_id_t * u;
+	uint32_t    n = e->max_users ? e->max_users : EP_RAN_USERS_MAX;
+
+	if(nof <= e->max_users) {
+		return EP_SUCCESS;
+	}
+
+	while(n < nof) {
+		n <<= 1;
+	}
+
+	u = realloc(e->users, n * sizeof(rnti_id_t));
+
+	if(!u) {
+		ep_dbg_log(EP_DBG_0"STAB: Not enough memory!\n");
+		return EP_ERROR;
+	}
+
+	e->users     = u;
+	e->max_users = n;
+
+	return EP_SUCCESS;
+}
+
+/* Update the users of a slice with the content of an RNTI report TLV.
+ * Returns the mask of the changes, or a negative error code.
+ */
+static int ep_ran_stab_users_TLV(ep_ran_stab_ent * e, char * buf)
+{
+	ep_TLV *    tlv = (ep_TLV *)buf;
+	rnti_id_t * r   = (rnti_id_t *)(buf + sizeof(ep_TLV));
+	uint32_t    n   = ntohs(tlv->length) / sizeof(rnti_id_t);
+	uint32_t    i   = 0;
+
+	/* Skip the part of the list which is already up to date */
+	if(n == e->nof_users) {
+		for(; i < n && e->users[i] == ntohs(r[i]); i++) {
+			/* Nothing */
+		}
+
+		if(i == n) {
+			return 0;
+		}
+	}
+
+	if(ep_ran_stab_room(e, n)) {
+		return EP_ERROR;
+	}
+
+	for(; i < n; i++) {
+		e->users[i] = ntohs(r[i]);
+	}
+
+	e->nof_users = n;
+
+	return EP_RAN_STAB_USERS;
+}
+
+/* Update the users of a slice with an array of RNTIs.
+ * Returns the mask of the changes, or a negative error code.
+ */
+static int ep_ran_stab_users(ep_ran_stab_ent * e, rnti_id_t * r, uint32_t n)
+{
+	uint32_t i = 0;
+
+	if(n == e->nof_users) {
+		for(; i < n && e->users[i] == r[i]; i++) {
+			/* Nothing */
+		}
+
+		if(i == n) {
+			return 0;
+		}
+	}
+
+	if(ep_ran_stab_room(e, n)) {
+		return EP_ERROR;
+	}
+
+	for(; i < n; i++) {
+		e->users[i] = r[i];
+	}
+
+	e->nof_users = n;
+
+	return EP_RAN_STAB_USERS;
+}
+
+/* Apply the TLVs of a slice message body to a slice. If 'full' is set the
+ * message describes the whole slice, and the fields not present are reset.
+ * Returns the mask of the changes, or a negative error code.
+ */
+static int ep_ran_stab_TLV(
+	ep_ran_stab_ent * e, char * buf, unsigned int size, int full)
+{
+	char *            c    = buf;
+	int               mask = 0;
+	int               seen = 0;
+	int               r;
+	uint16_t          rbgs;
+	sched_id_t        usched;
+	ep_TLV *          tlv;
+
+	while(c + sizeof(ep_TLV) <= buf + size) {
+		tlv = (ep_TLV *)c;
+
+		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
+			ep_dbg_log(EP_DBG_3"STAB: TLV %d > %d\n",
+				(int)(sizeof(ep_TLV) + ntohs(tlv->length)),
+				(int)((buf + size) - c));
+			break;
+		}
+
+		switch(ntohs(tlv->type)) {
+		case EP_TLV_RAN_SLICE_MAC_RES:
+			if(ntohs(tlv->length) < sizeof(ep_ran_sres)) {
+				break;
+			}
+
+			rbgs  = ntohs(((ep_ran_sres_TLV *)c)->body.rbgs);
+			seen |= EP_RAN_STAB_RBGS;
+
+			if(e->rbgs != rbgs) {
+				e->rbgs = rbgs;
+				mask   |= EP_RAN_STAB_RBGS;
+			}
+
+			break;
+		case EP_TLV_RAN_SLICE_MAC_SCHED:
+			if(ntohs(tlv->length) < sizeof(ep_ran_ssch)) {
+				break;
+			}
+
+			usched = ntohl(((ep_ran_ssch_TLV *)c)->body.user_sched);
+			seen  |= EP_RAN_STAB_USCHED;
+
+			if(e->usched != usched) {
+				e->usched = usched;
+				mask     |= EP_RAN_STAB_USCHED;
+			}
+
+			break;
+		case EP_TLV_RNTI_REPORT:
+			r     = ep_ran_stab_users_TLV(e, c);
+			seen |= EP_RAN_STAB_USERS;
+
+			if(r < 0) {
+				return r;
+			}
+
+			mask |= r;
+			break;
+		default:
+			ep_dbg_log(EP_DBG_3"STAB: Unexpected TLV %d!\n",
+				ntohs(tlv->type));
+			break;
+		}
+
+		c += sizeof(ep_TLV) + ntohs(tlv->length);
+	}
+
+	if(!full) {
+		return mask;
+	}
+
+	/* Formatters omit the tokens with default values */
+	if(!(seen & EP_RAN_STAB_RBGS) && e->rbgs) {
+		e->rbgs = 0;
+		mask   |= EP_RAN_STAB_RBGS;
+	}
+
+	if(!(seen & EP_RAN_STAB_USCHED) && e->usched) {
+		e->usched = 0;
+		mask     |= EP_RAN_STAB_USCHED;
+	}
+
+	if(!(seen & EP_RAN_STAB_USERS) && e->nof_users) {
+		e->nof_users = 0;
+		mask        |= EP_RAN_STAB_USERS;
+	}
+
+	return mask;
+}
+
+/* Number of RBGs set in a bitmap */
+static int ep_ran_rbg_pop(uint64_t * m)
+{
+	int i;
+	int n = 0;
+
+	for(i = 0; i < EP_RAN_RBG_WORDS; i++) {
+		n += __builtin_popcountll(m[i]);
+	}
+
+	return n;
+}
+
+/* Can a slice, or a new one if 'e' is NULL, own the given number of RBGs? */
+static int ep_ran_stab_rbg_fit(
+	ep_ran_stab * t, ep_ran_stab_ent * e, uint32_t rbgs)
+{
+	if(!t->nof_rbgs) {
+		return 1;
+	}
+
+	return rbgs <=
+		ep_ran_rbg_pop(t->rbg_free) + (e ? ep_ran_rbg_pop(e->rbg) : 0);
+}
+
+/* Give back to the cell the RBGs exceeding the slice request */
+static void ep_ran_stab_rbg_shrink(ep_ran_stab * t, ep_ran_stab_ent * e)
+{
+	int      n = ep_ran_rbg_pop(e->rbg) - e->rbgs;
+	int      i;
+	uint64_t b;
+
+	/* Release the highest RBGs first */
+	for(i = EP_RAN_RBG_WORDS - 1; i >= 0 && n > 0; i--) {
+		while(e->rbg[i] && n > 0) {
+			b = 1ULL << (63 - __builtin_clzll(e->rbg[i]));
+
+			e->rbg[i]      &= ~b;
+			t->rbg_free[i] |= b;
+			n--;
+		}
+	}
+}
+
+/* Take from the cell the RBGs missing to the slice request.
+ * Returns EP_SUCCESS, or a negative error code if the cell has not enough RBGs.
+ */
+static int ep_ran_stab_rbg_grow(ep_ran_stab * t, ep_ran_stab_ent * e)
+{
+	int      n = e->rbgs - ep_ran_rbg_pop(e->rbg);
+	int      i;
+	uint64_t b;
+
+	/* Take the lowest RBGs first */
+	for(i = 0; i < EP_RAN_RBG_WORDS && n > 0; i++) {
+		while(t->rbg_free[i] && n > 0) {
+			b = t->rbg_free[i] & -t->rbg_free[i];
+
+			t->rbg_free[i] &= ~b;
+			e->rbg[i]      |= b;
+			n--;
+		}
+	}
+
+	return n > 0 ? EP_ERROR : EP_SUCCESS;
+}
+
+/* Align the RBG bitmaps of all the slices with their requests, when the cell
+ * is mapped. Slices which shrink go first, so their RBGs can be taken by slices
+ * which grow.
+ * Returns EP_SUCCESS, or a negative error code if the cell has not enough RBGs.
+ */
+static int ep_ran_stab_rbg_sync(ep_ran_stab * t)
+{
+	ep_ran_stab_ent * e;
+	uint32_t          i;
+	int               r = EP_SUCCESS;
+
+	if(!t->nof_rbgs) {
+		return EP_SUCCESS;
+	}
+
+	for(i = 0; i < t->max; i++) {
+		e = &t->ents[i];
+
+		if(e->used && ep_ran_rbg_pop(e->rbg) > e->rbgs) {
+			ep_ran_stab_rbg_shrink(t, e);
+		}
+	}
+
+	for(i = 0; i < t->max; i++) {
+		e = &t->ents[i];
+
+		if(e->used && ep_ran_rbg_pop(e->rbg) < e->rbgs) {
+			if(ep_ran_stab_rbg_grow(t, e)) {
+				ep_dbg_log(EP_DBG_0"STAB: Not enough RBGs!\n");
+				r = EP_ERROR;
+			}
+		}
+	}
+
+	return r;
+}
+
+/* Align the RBG bitmap of a single slice with its request, as the others are
+ * already aligned.
+ * Returns EP_SUCCESS, or a negative error code if the cell has not enough RBGs.
+ */
+static int ep_ran_stab_rbg_sync_ent(ep_ran_stab * t, ep_ran_stab_ent * e)
+{
+	if(!t->nof_rbgs) {
+		return EP_SUCCESS;
+	}
+
+	ep_ran_stab_rbg_shrink(t, e);
+
+	if(ep_ran_stab_rbg_grow(t, e)) {
+		ep_dbg_log(EP_DBG_0"STAB: Not enough RBGs!\n");
+		return EP_ERROR;
+	}
+
+	return EP_SUCCESS;
+}
+
+/* RBGs a slice will have once the TLVs of a slice message are applied */
+static uint32_t ep_ran_stab_rbgs_of(
+	ep_ran_stab_ent * e, char * buf, unsigned int size, int full)
+{
+	char *   c = buf;
+	ep_TLV * tlv;
+
+	while(c + sizeof(ep_TLV) <= buf + size) {
+		tlv = (ep_TLV *)c;
+
+		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
+			break;
+		}
+
+		if(ntohs(tlv->type) == EP_TLV_RAN_SLICE_MAC_RES &&
+			ntohs(tlv->length) >= sizeof(ep_ran_sres))
+		{
+			return ntohs(((ep_ran_sres_TLV *)c)->body.rbgs);
+		}
+
+		c += sizeof(ep_TLV) + ntohs(tlv->length);
+	}
+
+	return full || !e ? 0 : e->rbgs;
+}
+
+/* Create a new, empty, slice in the table */
+static ep_ran_stab_ent * ep_ran_stab_alloc(ep_ran_stab * t, slice_id_t id)
+{
+	uint32_t          i;
+	ep_ran_stab_ent * e;
+
+	if(!t->free) {
+		ep_dbg_log(EP_DBG_0"STAB: Too many slices!\n");
+		return 0;
+	}
+
+	i = t->free;
+
+	if(ep_hmap_put(&t->map, id, 0, i)) {
+		return 0;
+	}
+
+	e       = &t->ents[i - 1];
+	t->free = e->next;
+	t->nof++;
+
+	/* Users storage is kept across re-use of the entry */
+	e->id        = id;
+	e->used      = 1;
+	e->usched    = 0;
+	e->rbgs      = 0;
+	e->nof_users = 0;
+
+	memset(e->rbg, 0, sizeof(e->rbg));
+
+	return e;
+}
+
+/* Most users listed by any of the RNTI TLVs of a slice, as each of them is
+ * applied in turn, or -1 if not listed.
+ */
+static int ep_ran_stab_nof_users(char * buf, unsigned int size)
+{
+	char *   c = buf;
+	ep_TLV * tlv;
+	int      n = -1;
+
+	while(c + sizeof(ep_TLV) <= buf + size) {
+		tlv = (ep_TLV *)c;
+
+		/* Not applied either, see ep_ran_stab_TLV() */
+		if(c + sizeof(ep_TLV) + ntohs(tlv->length) > buf + size) {
+			break;
+		}
+
+		if(ntohs(tlv->type) == EP_TLV_RNTI_REPORT &&
+			(int)(ntohs(tlv->length) / sizeof(rnti_id_t)) > n)
+		{
+			n = ntohs(tlv->length) / sizeof(rnti_id_t);
+		}
+
+		c += sizeof(ep_TLV) + ntohs(tlv->length);
+	}
+
+	return n;
+}
+
+/* Store the outcome of an operation of a bulk request */
+static void ep_ran_stab_out(
+	ep_ran_sblk_out * outs,
+	uint16_t          max,
+	int               i,
+	slice_id_t        id,
+	ep_op_type        result)
+{
+	if(outs && i < max) {
+		outs[i].id     = id;
+		outs[i].result = result;
+	}
+}
+
+/* Walk to the next operation of a bulk request.
+ * Returns the operation, or NULL if it overflows the message.
+ */
+static ep_ran_sblk_op * ep_ran_stab_blk_op(char * c, char * end)
+{
+	ep_ran_sblk_op * o = (ep_ran_sblk_op *)c;
+
+	if(c + sizeof(ep_ran_sblk_op) > end ||
+		c + sizeof(ep_ran_sblk_op) + ntohs(o->length) > end)
+	{
+		return 0;
+	}
+
+	return o;
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+int ep_ran_stab_init(ep_ran_stab * t, uint32_t max)
+{
+	uint32_t i;
+
+	if(!t || max == 0) {
+		ep_dbg_log(EP_DBG_0"STAB: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	if(ep_hmap_init(&t->map, max)) {
+		return EP_ERROR;
+	}
+
+	t->ents = calloc(max, sizeof(ep_ran_stab_ent));
+
+	if(!t->ents) {
+		ep_dbg_log(EP_DBG_0"STAB: Not enough memory!\n");
+		ep_hmap_release(&t->map);
+		return EP_ERROR;
+	}
+
+	t->max      = max;
+	t->nof      = 0;
+	t->free     = 0;
+	t->nof_rbgs = 0;
+
+	memset(t->rbg_free, 0, sizeof(t->rbg_free));
+
+	for(i = max; i > 0; i--) {
+		t->ents[i - 1].next = t->free;
+		t->free             = i;
+	}
+
+	return EP_SUCCESS;
+}
+
+void ep_ran_stab_release(ep_ran_stab * t)
+{
+	uint32_t i;
+
+	if(!t) {
+		return;
+	}
+
+	for(i = 0; t->ents && i < t->max; i++) {
+		free(t->ents[i].users);
+	}
+
+	ep_hmap_release(&t->map);
+	free(t->ents);
+
+	t->ents = 0;
+	t->max  = 0;
+	t->nof  = 0;
+	t->free = 0;
+}
+
+ep_ran_stab_ent * ep_ran_stab_find(ep_ran_stab * t, slice_id_t id)
+{
+	uint32_t i;
+
+	if(!t) {
+		return 0;
+	}
+
+	i = ep_hmap_get(&t->map, id, 0);
+
+	return i ? &t->ents[i - 1] : 0;
+}
+
+ep_ran_stab_ent * ep_ran_stab_next(ep_ran_stab * t, ep_ran_stab_ent * prev)
+{
+	uint32_t i;
+
+	if(!t) {
+		return 0;
+	}
+
+	for(i = prev ? (prev - t->ents) + 1 : 0; i < t->max; i++) {
+		if(t->ents[i].used) {
+			return &t->ents[i];
+		}
+	}
+
+	return 0;
+}
+
+int ep_ran_stab_set(ep_ran_stab * t, slice_id_t id, ep_ran_slice_det * det)
+{
+	ep_ran_slice_ldet l;
+
+	if(!det) {
+		ep_dbg_log(EP_DBG_0"STAB: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	l.nof_users = det->nof_users < EP_RAN_USERS_MAX ?
+		det->nof_users : EP_RAN_USERS_MAX;
+	l.users     = det->users;
+	l.l2        = det->l2;
+
+	return ep_ran_stab_set_l(t, id, &l);
+}
+
+int ep_ran_stab_set_l(ep_ran_stab * t, slice_id_t id, ep_ran_slice_ldet * det)
+{
+	ep_ran_stab_ent * e;
+	int               mask = 0;
+	int               r;
+
+	if(!t || !det || (det->nof_users && !det->users)) {
+		ep_dbg_log(EP_DBG_0"STAB: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	e = ep_ran_stab_find(t, id);
+
+	if(!ep_ran_stab_rbg_fit(t, e, det->l2.rbgs)) {
+		ep_dbg_log(EP_DBG_1"STAB: Not enough RBGs for %" PRIu64 "\n", id);
+		return EP_ERROR;
+	}
+
+	if(!e) {
+		e = ep_ran_stab_alloc(t, id);
+
+		if(!e) {
+			return EP_ERROR;
+		}
+
+		mask |= EP_RAN_STAB_ADDED;
+	}
+
+	if(e->rbgs != det->l2.rbgs) {
+		e->rbgs = det->l2.rbgs;
+		mask   |= EP_RAN_STAB_RBGS;
+	}
+
+	if(e->usched != det->l2.usched) {
+		e->usched = det->l2.usched;
+		mask     |= EP_RAN_STAB_USCHED;
+	}
+
+	r = ep_ran_stab_users(e, det->users, det->nof_users);
+
+	if(r < 0) {
+		if(mask & EP_RAN_STAB_ADDED) {
+			ep_ran_stab_rem(t, id);
+		}
+
+		return r;
+	}
+
+	if((mask & EP_RAN_STAB_RBGS) && ep_ran_stab_rbg_sync_ent(t, e)) {
+		return EP_ERROR;
+	}
+
+	return mask | r;
+}
+
+int ep_ran_stab_rem(ep_ran_stab * t, slice_id_t id)
+{
+	uint32_t i;
+	int      j;
+
+	if(!t) {
+		return EP_ERROR;
+	}
+
+	i = ep_hmap_del(&t->map, id, 0);
+
+	if(!i) {
+		return EP_ERROR;
+	}
+
+	/* Give back the RBGs of the slice */
+	for(j = 0; j < EP_RAN_RBG_WORDS; j++) {
+		t->rbg_free[j]       |= t->ents[i - 1].rbg[j];
+		t->ents[i - 1].rbg[j] = 0;
+	}
+
+	t->ents[i - 1].used = 0;
+	t->ents[i - 1].next = t->free;
+	t->free             = i;
+	t->nof--;
+
+	return EP_SUCCESS;
+}
+
+int ep_ran_stab_apply(
+	ep_ran_stab * t,
+	char *        buf,
+	unsigned int  size,
+	slice_id_t *  id)
+{
+	ep_msg_type       type;
+	ep_op_type        op;
+	ep_ran_sinf *     inf;
+	ep_ran_stab_ent * e;
+	slice_id_t        sid;
+	unsigned int      hs = sizeof(ep_hdr) + sizeof(ep_s_hdr);
+	int               mask = 0;
+	int               full = 0;
+	int               r;
+
+	if(!t || !buf) {
+		ep_dbg_log(EP_DBG_0"STAB: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	if(epp_head_peek(buf, size, &type, 0, 0, 0, 0)) {
+		return EP_ERROR;
+	}
+
+	/* Do not trust anything beyond the message itself; the size is checked
+	 * only once cut down to it.
+	 */
+	if(epp_msg_length(buf, size) >= hs && epp_msg_length(buf, size) < size) {
+		size = epp_msg_length(buf, size);
+	}
+
+	if(type != EP_TYPE_SINGLE_MSG ||
+		size < hs + sizeof(ep_ran_sinf) ||
+		epp_single_type(buf, size) != EP_ACT_RAN_SLICE)
+	{
+		ep_dbg_log(EP_DBG_0"STAB: Not a RAN Slice message!\n");
+		return EP_ERROR;
+	}
+
+	op  = epp_single_op(buf, size);
+	inf = (ep_ran_sinf *)(buf + hs);
+	sid = be64toh(inf->id);
+
+	if(id) {
+		*id = sid;
+	}
+
+	e = ep_ran_stab_find(t, sid);
+
+	switch(op) {
+	case EP_OPERATION_REM:
+		if(ep_ran_stab_rem(t, sid)) {
+			ep_dbg_log(EP_DBG_1"STAB: Slice %" PRIu64 " not found\n",
+				sid);
+			return EP_ERROR;
+		}
+
+		return EP_RAN_STAB_REMOVED;
+	case EP_OPERATION_ADD:
+		if(e) {
+			ep_dbg_log(EP_DBG_1"STAB: Slice %" PRIu64 " exists\n",
+				sid);
+			return EP_ERROR;
+		}
+
+		full = 1;
+		break;
+	case EP_OPERATION_SET:
+		if(!e) {
+			ep_dbg_log(EP_DBG_1"STAB: Slice %" PRIu64 " not found\n",
+				sid);
+			return EP_ERROR;
+		}
+
+		break;
+	case EP_OPERATION_UNSPECIFIED:
+		/* Replies report the whole state of the slice */
+		if(epp_dir(buf, size) != EP_HDR_FLAG_DIR_REP) {
+			ep_dbg_log(EP_DBG_1"STAB: Slice request not applied\n");
+			return EP_ERROR;
+		}
+
+		full = 1;
+		break;
+	default:
+		ep_dbg_log(EP_DBG_1"STAB: Unexpected operation %d\n", op);
+		return EP_ERROR;
+	}
+
+	/* Refuse the request before touching the slice */
+	if(!ep_ran_stab_rbg_fit(t, e, ep_ran_stab_rbgs_of(
+		e,
+		buf  + hs + sizeof(ep_ran_sinf),
+		size - hs - sizeof(ep_ran_sinf),
+		full)))
+	{
+		ep_dbg_log(EP_DBG_1"STAB: Not enough RBGs for %" PRIu64 "\n",
+			sid);
+		return EP_ERROR;
+	}
+
+	if(!e) {
+		e = ep_ran_stab_alloc(t, sid);
+
+		if(!e) {
+			return EP_ERROR;
+		}
+
+		mask |= EP_RAN_STAB_ADDED;
+	}
+
+	r = ep_ran_stab_TLV(
+		e,
+		buf  + hs + sizeof(ep_ran_sinf),
+		size - hs - sizeof(ep_ran_sinf),
+		full);
+
+	if(r < 0) {
+		if(mask & EP_RAN_STAB_ADDED) {
+			ep_ran_stab_rem(t, sid);
+		}
+
+		return r;
+	}
+
+	if((r & EP_RAN_STAB_RBGS) && ep_ran_stab_rbg_sync_ent(t, e)) {
+		return EP_ERROR;
+	}
+
+	return mask | r;
+}
+
+int ep_ran_stab_apply_bulk(
+	ep_ran_stab *     t,
+	char *            buf,
+	unsigned int      size,
+	uint16_t *        nof,
+	uint16_t          max,
+	ep_ran_sblk_out * outs)
+{
+	ep_msg_type       type;
+	ep_ran_sblk_op *  o;
+	ep_ran_sblk_op *  p;
+	ep_ran_stab_ent * e;
+	slice_id_t        sid;
+	char *            c;
+	char *            d;
+	char *            end;
+	unsigned int      hs = sizeof(ep_hdr) + sizeof(ep_s_hdr);
+	uint16_t          n;
+	uint32_t          adds = 0;
+	uint32_t          rbgs;
+	int               delta= 0;
+	int               grow = -1;
+	int               bad  = -1;
+	int               mask = 0;
+	int               nu;
+	int               i;
+	int               j;
+	int               r;
+
+	if(!t || !buf) {
+		ep_dbg_log(EP_DBG_0"STAB: Invalid arguments!\n");
+		return EP_ERROR;
+	}
+
+	if(epp_head_peek(buf, size, &type, 0, 0, 0, 0)) {
+		return EP_ERROR;
+	}
+
+	/* As for single requests, check the size only once cut down */
+	if(epp_msg_length(buf, size) >= hs && epp_msg_length(buf, size) < size) {
+		size = epp_msg_length(buf, size);
+	}
+
+	if(type != EP_TYPE_SINGLE_MSG ||
+		size < hs + sizeof(ep_ran_sblk) ||
+		epp_single_type(buf, size) != EP_ACT_RAN_SLICE_BULK ||
+		epp_dir(buf, size) != EP_HDR_FLAG_DIR_REQ)
+	{
+		ep_dbg_log(EP_DBG_0"STAB: Not a RAN Slice bulk request!\n");
+		return EP_ERROR;
+	}
+
+	end = buf + size;
+	n   = ntohs(((ep_ran_sblk *)(buf + hs))->nof_slices);
+
+	if(nof) {
+		*nof = n;
+	}
+
+	/*
+	 * Validate the whole request before touching anything
+	 */
+
+	c = buf + hs + sizeof(ep_ran_sblk);
+
+	for(i = 0; i < n; i++) {
+		o = ep_ran_stab_blk_op(c, end);
+
+		if(!o) {
+			ep_dbg_log(EP_DBG_0"STAB: Malformed bulk request!\n");
+			return EP_ERROR;
+		}
+
+		sid = be64toh(o->id);
+		e   = ep_ran_stab_find(t, sid);
+
+		ep_ran_stab_out(outs, max, i, sid, EP_OPERATION_UNCHANGED);
+
+		/* A slice can appear only once per request */
+		for(d = buf + hs + sizeof(ep_ran_sblk); d < c && bad < 0; ) {
+			p = (ep_ran_sblk_op *)d;
+
+			if(p->id == o->id) {
+				bad = i;
+			}
+
+			d += sizeof(ep_ran_sblk_op) + ntohs(p->length);
+		}
+
+		switch(o->op) {
+		case EP_OPERATION_ADD:
+			if(e || ++adds > t->max - t->nof) {
+				bad = bad < 0 ? i : bad;
+			}
+			break;
+		case EP_OPERATION_SET:
+		case EP_OPERATION_REM:
+			if(!e) {
+				bad = bad < 0 ? i : bad;
+			}
+			break;
+		default:
+			bad = bad < 0 ? i : bad;
+			break;
+		}
+
+		/* Account how the RBGs of the cell would change */
+		if(bad < 0) {
+			rbgs = o->op == EP_OPERATION_REM ? 0 :
+				ep_ran_stab_rbgs_of(
+					e,
+					c + sizeof(ep_ran_sblk_op),
+					ntohs(o->length),
+					o->op == EP_OPERATION_ADD);
+
+			delta += (int)rbgs - (e ? e->rbgs : 0);
+
+			if(rbgs > (e ? e->rbgs : 0)) {
+				grow = i;
+			}
+		}
+
+		c += sizeof(ep_ran_sblk_op) + ntohs(o->length);
+	}
+
+	if(bad < 0 && t->nof_rbgs && delta > ep_ran_rbg_pop(t->rbg_free)) {
+		ep_dbg_log(EP_DBG_1"STAB: Not enough RBGs for the bulk request\n");
+		bad = grow;
+	}
+
+	/*
+	 * Reserve what the operations need, so that applying them can't fail
+	 */
+
+	c = buf + hs + sizeof(ep_ran_sblk);
+
+	for(i = 0; i < n && bad < 0; i++) {
+		o  = (ep_ran_sblk_op *)c;
+		sid= be64toh(o->id);
+		nu = ep_ran_stab_nof_users(
+			c + sizeof(ep_ran_sblk_op), ntohs(o->length));
+
+		switch(o->op) {
+		case EP_OPERATION_ADD:
+			e = ep_ran_stab_alloc(t, sid);
+
+			if(!e) {
+				bad = i;
+				break;
+			}
+			/* Fall through */
+		case EP_OPERATION_SET:
+			e = ep_ran_stab_find(t, sid);
+
+			if(nu > 0 && ep_ran_stab_room(e, nu)) {
+				bad = i;
+			}
+			break;
+		}
+
+		c += sizeof(ep_ran_sblk_op) + ntohs(o->length);
+	}
+
+	if(bad >= 0) {
+		c = buf + hs + sizeof(ep_ran_sblk);
+
+		/* Roll back the slices created while reserving */
+		for(j = 0; j < n; j++) {
+			o = (ep_ran_sblk_op *)c;
+
+			if(j < i && o->op == EP_OPERATION_ADD) {
+				ep_ran_stab_rem(t, be64toh(o->id));
+			}
+
+			if(j == bad) {
+				ep_ran_stab_out(
+					outs,
+					max,
+					j,
+					be64toh(o->id),
+					EP_OPERATION_FAIL);
+			}
+
+			c += sizeof(ep_ran_sblk_op) + ntohs(o->length);
+		}
+
+		ep_dbg_log(EP_DBG_1"STAB: Bulk request rejected at %d\n", bad);
+
+		return EP_ERROR;
+	}
+
+	/*
+	 * Apply all the operations
+	 */
+
+	c = buf + hs + sizeof(ep_ran_sblk);
+
+	for(i = 0; i < n; i++) {
+		o  = (ep_ran_sblk_op *)c;
+		sid= be64toh(o->id);
+
+		if(o->op == EP_OPERATION_REM) {
+			ep_ran_stab_rem(t, sid);
+			mask |= EP_RAN_STAB_REMOVED;
+		} else {
+			e = ep_ran_stab_find(t, sid);
+			r = ep_ran_stab_TLV(
+				e,
+				c + sizeof(ep_ran_sblk_op),
+				ntohs(o->length),
+				o->op == EP_OPERATION_ADD);
+
+			/* Room has been reserved for the largest RNTI TLV of
+			 * the operation, so this should not happen
+			 */
+			if(r < 0) {
+				ep_ran_stab_out(
+					outs, max, i, sid, EP_OPERATION_FAIL);
+				return r;
+			}
+
+			mask |= r;
+
+			if(o->op == EP_OPERATION_ADD) {
+				mask |= EP_RAN_STAB_ADDED;
+			}
+
+			/* Slices which shrink go first, see below */
+			if((r & EP_RAN_STAB_RBGS) && t->nof_rbgs) {
+				ep_ran_stab_rbg_shrink(t, e);
+			}
+		}
+
+		ep_ran_stab_out(outs, max, i, sid, EP_OPERATION_SUCCESS);
+
+		c += sizeof(ep_ran_sblk_op) + ntohs(o->length);
+	}
+
+	if(!(mask & EP_RAN_STAB_RBGS) || !t->nof_rbgs) {
+		return mask;
+	}
+
+	/* Slices which grow take what the others released */
+	c = buf + hs + sizeof(ep_ran_sblk);
+	r = EP_SUCCESS;
+
+	for(i = 0; i < n; i++) {
+		o = (ep_ran_sblk_op *)c;
+		e = ep_ran_stab_find(t, be64toh(o->id));
+
+		if(o->op != EP_OPERATION_REM && ep_ran_stab_rbg_sync_ent(t, e)) {
+			r = EP_ERROR;
+		}
+
+		c += sizeof(ep_ran_sblk_op) + ntohs(o->length);
+	}
+
+	return r ? r : mask;
+}
+
+uint16_t ep_ran_rbg_count(uint16_t prbs)
+{
+	uint16_t p;
+
+	/* RBG size P, 3GPP TS 36.213 Table 7.1.6.1-1 */
+	if(prbs == 0 || prbs > 110) {
+		return 0;
+	} else if(prbs <= 10) {
+		p = 1;
+	} else if(prbs <= 26) {
+		p = 2;
+	} else if(prbs <= 63) {
+		p = 3;
+	} else {
+		p = 4;
+	}
+
+	return (prbs + p - 1) / p;
+}
+
+int ep_ran_stab_rbg_init(ep_ran_stab * t, uint16_t prbs)
+{
+	uint16_t n = ep_ran_rbg_count(prbs);
+	uint32_t i;
+	int      j;
+
+	if(!t || n == 0 || n > EP_RAN_RBG_MAX) {
+		ep_dbg_log(EP_DBG_0"STAB: Invalid number of PRBs %d!\n", prbs);
+		return EP_ERROR;
+	}
+
+	/* Every RBG of the cell is free */
+	for(j = 0; j < EP_RAN_RBG_WORDS; j++) {
+		if(n >= (j + 1) * 64) {
+			t->rbg_free[j] = ~0ULL;
+		} else if(n > j * 64) {
+			t->rbg_free[j] = (1ULL << (n - j * 64)) - 1;
+		} else {
+			t->rbg_free[j] = 0;
+		}
+	}
+
+	for(i = 0; i < t->max; i++) {
+		memset(t->ents[i].rbg, 0, sizeof(t->ents[i].rbg));
+	}
+
+	t->nof_rbgs = n;
+
+	if(ep_ran_stab_rbg_sync(t)) {
+		t->nof_rbgs = 0;
+
+		for(i = 0; i < t->max; i++) {
+			memset(t->ents[i].rbg, 0, sizeof(t->ents[i].rbg));
+		}
+
+		memset(t->rbg_free, 0, sizeof(t->rbg_free));
+
+		return EP_ERROR;
+	}
+
+	return n;
+}
+
+uint64_t * ep_ran_stab_rbg_mask(ep_ran_stab * t, slice_id_t id)
+{
+	ep_ran_stab_ent * e = ep_ran_stab_find(t, id);
+
+	return e ? e->rbg : 0;
+}
+
+int ep_ran_stab_rbg_free(ep_ran_stab * t)
+{
+	if(!t) {
+		return 0;
+	}
+
+	return ep_ran_rbg_pop(t->rbg_free);
+}
+
+int ep_ran_stab_rbg_check(ep_ran_stab * t)
+{
+	uint64_t all[EP_RAN_RBG_WORDS];
+	uint32_t i;
+	int      j;
+
+	if(!t || !t->nof_rbgs) {
+		return EP_ERROR;
+	}
+
+	memcpy(all, t->rbg_free, sizeof(all));
+
+	for(i = 0; i < t->max; i++) {
+		if(!t->ents[i].used) {
+			continue;
+		}
+
+		if(ep_ran_rbg_pop(t->ents[i].rbg) != t->ents[i].rbgs) {
+			return EP_ERROR;
+		}
+
+		for(j = 0; j < EP_RAN_RBG_WORDS; j++) {
+			/* Overlapping RBGs */
+			if(all[j] & t->ents[i].rbg[j]) {
+				return EP_ERROR;
+			}
+
+			all[j] |= t->ents[i].rbg[j];
+		}
+	}
+
+	/* Every RBG of the cell is either free or assigned */
+	return ep_ran_rbg_pop(all) == t->nof_rbgs ? EP_SUCCESS : EP_ERROR;
+}
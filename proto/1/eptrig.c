@@ -16,56 +16,9 @@
 
 #include <arpa/inet.h>
 
-#include <emproto.h>
-
-int epf_trigger(
-	char * buf, unsigned int size,
-	ep_act_type type,
-	ep_op_type  op)
-{
-	ep_t_hdr * h = (ep_t_hdr *)(buf);
-
-	if(size < sizeof(ep_t_hdr)) {
-		ep_dbg_log(EP_DBG_1"F - TRIG: Not enough space!\n");
-		return -1;
-	}
-
-	h->type = htons(type);
-	h->op   = (uint8_t)op;
-
-	ep_dbg_dump(EP_DBG_1"F - TRIG: ", buf, sizeof(ep_t_hdr));
-
-	return sizeof(ep_t_hdr);
-}
-/******************************************************************************
- * Public API                                                                 *
- ******************************************************************************/
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_HDR
 
-ep_op_type epp_trigger_op(char * buf, unsigned int size)
-{
-	ep_t_hdr * h = (ep_t_hdr *)(buf + sizeof(ep_hdr));
-
-	if(size < sizeof(ep_hdr) + sizeof(ep_t_hdr)) {
-		ep_dbg_log(EP_DBG_0"F - TRIG Op: Not enough space!\n");
-		return EP_TYPE_INVALID_MSG;
-	}
-
-	return (ep_act_type)h->op;
-}
-
-ep_act_type epp_trigger_type(char * buf, unsigned int size)
-{
-	ep_t_hdr * h = (ep_t_hdr *)(buf + sizeof(ep_hdr));
-
-	if(size < sizeof(ep_hdr) + sizeof(ep_t_hdr)) {
-		ep_dbg_log(EP_DBG_0"F - TRIG Type: Not enough space!\n");
-		return EP_ACT_INVALID;
-	}
-
-	ep_dbg_dump(
-		EP_DBG_1"P - TRIG: ", 
-		buf + sizeof(ep_hdr), 
-		sizeof(ep_t_hdr));
+#include <emproto.h>
 
-	return ntohs(h->type);
-}
+#include <emproto/v1/eptrig_inl.h>
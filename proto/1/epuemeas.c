@@ -16,30 +16,39 @@
 
 #include <netinet/in.h>
 
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_ACT(EP_ACT_UE_MEASURE)
+
 #include <emproto.h>
 
-int epf_uemeas_rep(
-	char *          buf,
-	unsigned int    size,
+unsigned int epf_uemeas_rep_size(uint32_t nof_meas, uint32_t max)
+{
+	return sizeof(ep_uemeas_rep) +
+		sizeof(ep_uemeas_det) * (nof_meas < max ? nof_meas : max);
+}
+
+void epf_uemeas_rep_w(
+	ep_writer *     w,
 	uint32_t        nof_meas,
 	uint32_t        max,
 	ep_ue_measure * ues)
 {
 	int i = 0;
+	int n = nof_meas < max ? nof_meas : max;
 
-	ep_uemeas_rep * rep = (ep_uemeas_rep *) buf;
-	ep_uemeas_det * det = (ep_uemeas_det *)(buf + sizeof(ep_uemeas_rep));
+	ep_uemeas_rep * rep;
+	ep_uemeas_det * det;
 
-	if(size < sizeof(ep_uemeas_rep) + (sizeof(ep_uemeas_det) + nof_meas)) {
-		ep_dbg_log(EP_DBG_2"F - UMEA Rep: Not enough space!\n");
-		return -1;
-	}
+	rep = (ep_uemeas_rep *)ep_w_put(w, sizeof(ep_uemeas_rep));
+	det = (ep_uemeas_det *)ep_w_put(w, sizeof(ep_uemeas_det) * n);
 
-	rep->nof_meas = htonl(nof_meas);
+	/* Only the measurements listed are announced */
+	rep->nof_meas = htonl(n);
 
-	ep_dbg_dump(EP_DBG_2"F - UMEA Rep: ", buf, sizeof(ep_uemeas_rep));
+	ep_dbg_dump(EP_DBG_2"F - UMEA Rep: ", 
+		(char *)rep, sizeof(ep_uemeas_rep));
 
-	for(i = 0; i < nof_meas && i < max; i++) {
+	for(i = 0; i < n; i++) {
 		det[i].meas_id = ues[i].meas_id;
 		det[i].pci     = htons(ues[i].pci);
 		det[i].rsrp    = htons(ues[i].rsrp);
@@ -50,8 +59,6 @@ int epf_uemeas_rep(
 			(char *)(det + i), 
 			sizeof(ep_uemeas_det));
 	}
-
-	return sizeof(ep_uemeas_rep) + (sizeof(ep_uemeas_det) * i);
 }
 
 int epp_uemeas_rep(
@@ -71,8 +78,8 @@ int epp_uemeas_rep(
 		return -1;
 	}
 
-	if(size < sizeof(ep_uemeas_rep) + (
-		sizeof(ep_uemeas_det) + ntohl(rep->nof_meas)))
+	if(ntohl(rep->nof_meas) >
+		(size - sizeof(ep_uemeas_rep)) / sizeof(ep_uemeas_det))
 	{
 		ep_dbg_log(EP_DBG_2"P - UMEA Rep: Not enough space!\n");
 		return -1;
@@ -99,9 +106,8 @@ int epp_uemeas_rep(
 	return EP_SUCCESS;
 }
 
-int epf_uemeas_req(
-	char *        buf,
-	unsigned int  size,
+void epf_uemeas_req_w(
+	ep_writer *   w,
 	uint8_t       meas_id,
 	uint16_t      rnti,
 	uint16_t      earfcn,
@@ -109,12 +115,9 @@ int epf_uemeas_req(
 	int16_t       max_cells,
 	int16_t       max_meas)
 {
-	ep_uemeas_req * req = (ep_uemeas_req *)buf;
+	ep_uemeas_req * req;
 
-	if(size < sizeof(ep_uemeas_req) ) {
-		ep_dbg_log(EP_DBG_2"F - UMEA Req: Not enough space!\n");
-		return -1;
-	}
+	req = (ep_uemeas_req *)ep_w_put(w, sizeof(ep_uemeas_req));
 
 	req->meas_id   = meas_id;
 	req->rnti      = htons(rnti);
@@ -123,9 +126,8 @@ int epf_uemeas_req(
 	req->max_cells = htons(max_cells);
 	req->max_meas  = htons(max_meas);
 
-	ep_dbg_dump(EP_DBG_2"F - UMEA Req: ", buf, sizeof(ep_uemeas_req));
-
-	return sizeof(ep_uemeas_req);
+	ep_dbg_dump(EP_DBG_2"F - UMEA Req: ", 
+		(char *)req, sizeof(ep_uemeas_req));
 }
 
 int epp_uemeas_req(
@@ -184,49 +186,37 @@ int epf_trigger_uemeas_rep_fail(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Trigger UMEA Fail: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_trigger_uemeas_rep_fail_size())) {
+		ep_dbg_log(EP_DBG_0
+			"F - Trigger UMEA Fail: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_TRIGGER_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_trigger_w(&w, EP_ACT_UE_MEASURE, EP_OPERATION_FAIL);
+	epf_uemeas_rep_w(&w, 0, 0, 0);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_trigger(
-		buf + ret,
-		size - ret,
-		EP_ACT_UE_MEASURE,
-		EP_OPERATION_FAIL);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_uemeas_rep(buf + ret, size - ret, 0, 0, 0);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_trigger_uemeas_rep_fail_size(void)
+{
+	return EP_TRIGGER_HDR_SIZE + epf_uemeas_rep_size(0, 0);
 }
 
 int epf_trigger_uemeas_rep(
@@ -239,8 +229,7 @@ int epf_trigger_uemeas_rep(
 	uint32_t        max,
 	ep_ue_measure * ues)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Trigger UMEA Rep: Invalid buffer!\n");
@@ -252,41 +241,29 @@ int epf_trigger_uemeas_rep(
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_trigger_uemeas_rep_size(nof_meas, max))) {
+		ep_dbg_log(EP_DBG_0"F - Trigger UMEA Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_TRIGGER_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_trigger_w(&w, EP_ACT_UE_MEASURE, EP_OPERATION_SUCCESS);
+	epf_uemeas_rep_w(&w, nof_meas, max, ues);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_trigger(
-		buf + ret,
-		size - ret,
-		EP_ACT_UE_MEASURE,
-		EP_OPERATION_SUCCESS);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_uemeas_rep(buf + ret, size - ret, nof_meas, max, ues);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_trigger_uemeas_rep_size(uint32_t nof_meas, uint32_t max)
+{
+	return EP_TRIGGER_HDR_SIZE + epf_uemeas_rep_size(nof_meas, max);
 }
 
 int epp_trigger_uemeas_rep(
@@ -323,47 +300,30 @@ int epf_trigger_uemeas_req(
 	int16_t       max_cells,
 	int16_t       max_meas)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Trigger UMEA Req: Invalid buffer!\n");
 		return -1;
 	}
 
-	if(ms < 0) {
-		return ms;
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_trigger_uemeas_req_size())) {
+		ep_dbg_log(EP_DBG_0"F - Trigger UMEA Req: Not enough space!\n");
+		return -1;
 	}
 
-	ret += ms;
-	ms   = epf_head(
-		buf,
-		size,
+	epf_head_w(
+		&w,
 		EP_TYPE_TRIGGER_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_trigger(
-		buf + ret,
-		size - ret,
-		EP_ACT_UE_MEASURE,
-		op);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_uemeas_req(
-		buf + ret,
-		size - ret,
+	epf_trigger_w(&w, EP_ACT_UE_MEASURE, op);
+	epf_uemeas_req_w(
+		&w,
 		meas_id,
 		rnti,
 		earfcn,
@@ -371,14 +331,12 @@ int epf_trigger_uemeas_req(
 		max_cells,
 		max_meas);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_trigger_uemeas_req_size(void)
+{
+	return EP_TRIGGER_HDR_SIZE + sizeof(ep_uemeas_req);
 }
 
 int epp_trigger_uemeas_req(
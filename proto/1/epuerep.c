@@ -16,30 +16,39 @@
 
 #include <netinet/in.h>
 
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_ACT(EP_ACT_UE_REPORT)
+
 #include <emproto.h>
 
-int epf_uerep_rep(
-	char *          buf,
-	unsigned int    size,
+unsigned int epf_uerep_rep_size(uint32_t nof_ues, uint32_t max_ues)
+{
+	return sizeof(ep_uerep_rep) +
+		sizeof(ep_uerep_det) * (nof_ues < max_ues ? nof_ues : max_ues);
+}
+
+void epf_uerep_rep_w(
+	ep_writer *     w,
 	uint32_t        nof_ues,
 	uint32_t        max_ues,
 	ep_ue_details * ues)
 {
 	int i = 0;
+	int n = nof_ues < max_ues ? nof_ues : max_ues;
 
-	ep_uerep_rep * rep = (ep_uerep_rep *)buf;
-	ep_uerep_det * det = (ep_uerep_det *)(buf + sizeof(ep_uerep_rep));
+	ep_uerep_rep * rep;
+	ep_uerep_det * det;
 
-	if(size < sizeof(ep_uerep_rep) + (sizeof(ep_uerep_det) * nof_ues)) {
-		ep_dbg_log(EP_DBG_2"F - UEREP Rep: Not enough space!\n");
-		return -1;
-	}
+	rep = (ep_uerep_rep *)ep_w_put(w, sizeof(ep_uerep_rep));
+	det = (ep_uerep_det *)ep_w_put(w, sizeof(ep_uerep_det) * n);
 
-	rep->nof_ues = htonl(nof_ues);
+	/* Only the UEs listed are announced, or the message would not parse */
+	rep->nof_ues = htonl(n);
 
-	ep_dbg_dump(EP_DBG_2"F - UREP Rep: ", buf, sizeof(ep_uerep_rep));
+	ep_dbg_dump(EP_DBG_2"F - UREP Rep: ", 
+		(char *)rep, sizeof(ep_uerep_rep));
 
-	for(i = 0; i < nof_ues && i < max_ues; i++) {
+	for(i = 0; i < n; i++) {
 		det[i].pci  = htons(ues[i].pci);
 		det[i].rnti = htons(ues[i].rnti);
 		det[i].plmn = htonl(ues[i].plmn);
@@ -50,8 +59,6 @@ int epf_uerep_rep(
 			(char *)(det + i),
 			sizeof(ep_uerep_det));
 	}
-
-	return sizeof(ep_uerep_rep) + (sizeof(ep_uerep_det) * i);
 }
 
 int epp_uerep_rep(
@@ -72,7 +79,7 @@ int epp_uerep_rep(
 	}
 
 	if(size < sizeof(ep_uerep_rep) + (
-		sizeof(ep_uerep_det) * rep->nof_ues))
+		sizeof(ep_uerep_det) * ntohl(rep->nof_ues)))
 	{
 		ep_dbg_log(EP_DBG_2"P - UEREP Rep: Not enough space!\n");
 		return EP_ERROR;
@@ -101,20 +108,67 @@ int epp_uerep_rep(
 	return EP_SUCCESS;
 }
 
-int epf_uerep_req(char * buf, unsigned int size)
+int epp_uerep_rep_a(
+	char *           buf,
+	unsigned int     size,
+	ep_arena *       arena,
+	uint32_t *       nof_ues,
+	ep_ue_details ** ues)
 {
-	ep_uerep_req * req = (ep_uerep_req *)buf;
+	uint32_t        i;
+	uint32_t        n;
+	ep_ue_details * u   = 0;
+	ep_uerep_rep *  rep = (ep_uerep_rep *)buf;
+	ep_uerep_det *  det = (ep_uerep_det *)(buf + sizeof(ep_uerep_rep));
 
-	if(size < sizeof(ep_uerep_req)) {
-		ep_dbg_log(EP_DBG_2"F - UEREP Req: Not enough space!\n");
-		return -1;
+	if(size < sizeof(ep_uerep_rep)) {
+		ep_dbg_log(EP_DBG_2"P - UEREP Rep: Not enough space!\n");
+		return EP_ERROR;
 	}
 
-	req->dummy = 0;
+	if(!arena || !nof_ues || !ues) {
+		ep_dbg_log(EP_DBG_2"P - UEREP Rep: Invalid pointer!\n");
+		return EP_ERROR;
+	}
+
+	n = ntohl(rep->nof_ues);
+
+	if(n > (size - sizeof(ep_uerep_rep)) / sizeof(ep_uerep_det)) {
+		ep_dbg_log(EP_DBG_2"P - UEREP Rep: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	ep_dbg_dump(EP_DBG_2"P - UREP Rep: ", buf, sizeof(ep_uerep_rep));
+
+	if(n) {
+		u = ep_arena_alloc(arena, n * sizeof(ep_ue_details));
+
+		if(!u) {
+			return EP_ERROR;
+		}
+	}
+
+	for(i = 0; i < n; i++) {
+		u[i].pci  = ntohs(det[i].pci);
+		u[i].rnti = ntohs(det[i].rnti);
+		u[i].plmn = ntohl(det[i].plmn);
+		u[i].imsi = be64toh(det[i].imsi);
+	}
 
-	ep_dbg_dump(EP_DBG_2"F - UREP Req: ", buf, sizeof(ep_uerep_req));
+	*nof_ues = n;
+	*ues     = u;
 
-	return sizeof(ep_uerep_req);
+	return EP_SUCCESS;
+}
+
+void epf_uerep_req_w(ep_writer * w)
+{
+	ep_uerep_req * req = (ep_uerep_req *)ep_w_put(w, sizeof(ep_uerep_req));
+
+	req->dummy = 0;
+
+	ep_dbg_dump(EP_DBG_2"F - UREP Req: ", 
+		(char *)req, sizeof(ep_uerep_req));
 }
 
 int epp_uerep_req(char * buf, unsigned int size)
@@ -140,50 +194,37 @@ int epf_trigger_uerep_rep_fail(
 	cell_id_t    cell_id,
 	mod_id_t     mod_id)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Trigger UEREP Fail: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms += epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_trigger_uerep_rep_fail_size())) {
+		ep_dbg_log(EP_DBG_0
+			"F - Trigger UEREP Fail: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_TRIGGER_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_trigger_w(&w, EP_ACT_UE_REPORT, EP_OPERATION_FAIL);
+	epf_uerep_rep_w(&w, 0, 0, 0);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_trigger(
-		buf + ret,
-		size - ret,
-		EP_ACT_UE_REPORT,
-		EP_OPERATION_FAIL);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_uerep_rep(buf + ret, size - ret, 0, 0, 0);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_trigger_uerep_rep_fail_size(void)
+{
+	return EP_TRIGGER_HDR_SIZE + epf_uerep_rep_size(0, 0);
 }
 
 int epf_trigger_uerep_rep(
@@ -196,8 +237,7 @@ int epf_trigger_uerep_rep(
 	uint32_t        max_ues,
 	ep_ue_details * ues)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Trigger UEREP Rep: Invalid buffer!\n");
@@ -209,42 +249,30 @@ int epf_trigger_uerep_rep(
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_trigger_uerep_rep_size(nof_ues, max_ues))) {
+		ep_dbg_log(EP_DBG_0
+			"F - Trigger UEREP Rep: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_TRIGGER_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REP);
+	epf_trigger_w(&w, EP_ACT_UE_REPORT, EP_OPERATION_SUCCESS);
+	epf_uerep_rep_w(&w, nof_ues, max_ues, ues);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_trigger(
-		buf + ret,
-		size - ret,
-		EP_ACT_UE_REPORT,
-		EP_OPERATION_SUCCESS);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_uerep_rep(buf + ret, size - ret, nof_ues, max_ues, ues);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_trigger_uerep_rep_size(uint32_t nof_ues, uint32_t max_ues)
+{
+	return EP_TRIGGER_HDR_SIZE + epf_uerep_rep_size(nof_ues, max_ues);
 }
 
 int epp_trigger_uerep_rep(
@@ -267,6 +295,31 @@ int epp_trigger_uerep_rep(
 		ues);
 }
 
+int epp_trigger_uerep_rep_a(
+	char *           buf,
+	unsigned int     size,
+	ep_arena *       arena,
+	uint32_t *       nof_ues,
+	ep_ue_details ** ues)
+{
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"P - Trigger UEREP Rep: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(size < sizeof(ep_hdr) + sizeof(ep_t_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - Trigger UEREP Rep: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	return epp_uerep_rep_a(
+		buf  +  sizeof(ep_hdr) + sizeof(ep_t_hdr),
+		size - (sizeof(ep_hdr) + sizeof(ep_t_hdr)),
+		arena,
+		nof_ues,
+		ues);
+}
+
 int epf_trigger_uerep_req(
 	char *       buf,
 	unsigned int size,
@@ -275,49 +328,37 @@ int epf_trigger_uerep_req(
 	mod_id_t     mod_id,
 	ep_op_type   op)
 {
-	int ms = 0;
-	int ret= 0;
+	ep_writer w;
 
 	if(!buf) {
 		ep_dbg_log(EP_DBG_0"F - Trigger UEREP Req: Invalid buffer!\n");
 		return -1;
 	}
 
-	ms = epf_head(
-		buf,
-		size,
+	ep_w_init(&w, buf, size);
+
+	if(ep_w_need(&w, epf_trigger_uerep_req_size())) {
+		ep_dbg_log(EP_DBG_0
+			"F - Trigger UEREP Req: Not enough space!\n");
+		return -1;
+	}
+
+	epf_head_w(
+		&w,
 		EP_TYPE_TRIGGER_MSG,
 		enb_id,
 		cell_id,
 		mod_id,
 		EP_HDR_FLAG_DIR_REQ);
+	epf_trigger_w(&w, EP_ACT_UE_REPORT, op);
+	epf_uerep_req_w(&w);
 
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_trigger(
-		buf + ret,
-		size - ret,
-		EP_ACT_UE_REPORT,
-		op);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	ms   = epf_uerep_req(buf + ret, size - ret);
-
-	if(ms < 0) {
-		return ms;
-	}
-
-	ret += ms;
-	epf_msg_length(buf, size, ret);
+	return epf_msg_end_w(&w);
+}
 
-	return ret;
+unsigned int epf_trigger_uerep_req_size(void)
+{
+	return EP_TRIGGER_HDR_SIZE + sizeof(ep_uerep_req);
 }
 
 int epp_trigger_uerep_req(char * buf, unsigned int size)
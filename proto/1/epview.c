@@ -0,0 +1,449 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_HDR
+
+#include <emproto.h>
+
+/* Check an array of 'nof' entries of 'es' bytes, which follows 'hs' bytes at
+ * the start of the body. If 'trunc' is set the sender may have listed less
+ * entries than declared, and only the listed ones are considered.
+ */
+static int ep_view_array(
+	ep_msg_view * v,
+	unsigned int  hs,
+	unsigned int  es,
+	uint32_t      nof,
+	int           trunc)
+{
+	uint32_t room;
+
+	if(v->blen < hs) {
+		ep_dbg_log(EP_DBG_2"P - View: Body %u < %u!\n", v->blen, hs);
+		return EP_ERROR;
+	}
+
+	room = (v->blen - hs) / es;
+
+	if(nof > room) {
+		if(!trunc) {
+			ep_dbg_log(EP_DBG_2"P - View: %u entries, room for %u!\n",
+				nof, room);
+			return EP_ERROR;
+		}
+
+		nof = room;
+	}
+
+	v->nof = nof;
+	v->arr = v->body + hs;
+
+	return EP_SUCCESS;
+}
+
+/* Check the bounds of the TLV tokens between 'c' and 'end', and locate the
+ * ones of a RAN Slice.
+ */
+static int ep_view_TLVs(ep_msg_view * v, char * c, char * end)
+{
+	ep_TLV * tlv;
+	uint16_t len;
+
+	while(c < end) {
+		tlv = (ep_TLV *)c;
+
+		if(c + sizeof(ep_TLV) > end) {
+			ep_dbg_log(EP_DBG_2"P - View: Truncated TLV header!\n");
+			return EP_ERROR;
+		}
+
+		len = ntohs(tlv->length);
+
+		if(c + sizeof(ep_TLV) + len > end) {
+			ep_dbg_log(EP_DBG_2"P - View: TLV %d > %d!\n",
+				(int)(sizeof(ep_TLV) + len), (int)(end - c));
+			return EP_ERROR;
+		}
+
+		switch(ntohs(tlv->type)) {
+		case EP_TLV_RNTI_REPORT:
+			v->nof = len / sizeof(rnti_id_t);
+			v->arr = c + sizeof(ep_TLV);
+			break;
+		case EP_TLV_RAN_SLICE_MAC_RES:
+			if(len < sizeof(ep_ran_sres)) {
+				return EP_ERROR;
+			}
+
+			v->res = c;
+			break;
+		case EP_TLV_RAN_SLICE_MAC_SCHED:
+			if(len < sizeof(ep_ran_ssch)) {
+				return EP_ERROR;
+			}
+
+			v->sch = c;
+			break;
+		}
+
+		c += sizeof(ep_TLV) + len;
+	}
+
+	return EP_SUCCESS;
+}
+
+/* Check the operations of a RAN Slice bulk request */
+static int ep_view_sblk(ep_msg_view * v)
+{
+	char *           end = v->body + v->blen;
+	char *           c;
+	ep_ran_sblk_op * o;
+	ep_msg_view      t;
+	uint32_t         i;
+
+	if(v->blen < sizeof(ep_ran_sblk)) {
+		return EP_ERROR;
+	}
+
+	v->nof = ntohs(((ep_ran_sblk *)v->body)->nof_slices);
+	v->arr = v->body + sizeof(ep_ran_sblk);
+
+	for(i = 0, c = v->arr; i < v->nof; i++) {
+		o = (ep_ran_sblk_op *)c;
+
+		if(c + sizeof(ep_ran_sblk_op) > end ||
+			c + sizeof(ep_ran_sblk_op) + ntohs(o->length) > end)
+		{
+			ep_dbg_log(EP_DBG_2"P - View: Bulk op %u truncated!\n", i);
+			return EP_ERROR;
+		}
+
+		c += sizeof(ep_ran_sblk_op);
+
+		/* Details are located per operation, not in the view */
+		if(ep_view_TLVs(&t, c, c + ntohs(o->length))) {
+			return EP_ERROR;
+		}
+
+		c += ntohs(o->length);
+	}
+
+	return EP_SUCCESS;
+}
+
+/* Check the body of the message, depending on its action */
+static int ep_view_body(ep_msg_view * v)
+{
+	int      rep = v->dir == EP_HDR_FLAG_DIR_REP;
+	uint32_t n;
+
+	switch(v->act) {
+	case EP_ACT_HELLO:
+		if(v->blen < sizeof(ep_hello_req)) {
+			return EP_ERROR;
+		}
+
+		return ep_view_TLVs(
+			v, v->body + sizeof(ep_hello_req), v->body + v->blen);
+	case EP_ACT_ECAP:
+		if(!rep) {
+			return EP_SUCCESS;
+		}
+
+		if(v->blen < sizeof(ep_ecap_rep)) {
+			return EP_ERROR;
+		}
+
+		return ep_view_TLVs(
+			v, v->body + sizeof(ep_ecap_rep), v->body + v->blen);
+	case EP_ACT_UE_REPORT:
+		if(!rep || v->op != EP_OPERATION_SUCCESS) {
+			return EP_SUCCESS;
+		}
+
+		if(v->blen < sizeof(ep_uerep_rep)) {
+			return EP_ERROR;
+		}
+
+		n = ntohl(((ep_uerep_rep *)v->body)->nof_ues);
+
+		return ep_view_array(
+			v, sizeof(ep_uerep_rep), sizeof(ep_uerep_det), n, 1);
+	case EP_ACT_UE_MEASURE:
+		if(!rep || v->op != EP_OPERATION_SUCCESS) {
+			return EP_SUCCESS;
+		}
+
+		if(v->blen < sizeof(ep_uemeas_rep)) {
+			return EP_ERROR;
+		}
+
+		n = ntohl(((ep_uemeas_rep *)v->body)->nof_meas);
+
+		return ep_view_array(
+			v, sizeof(ep_uemeas_rep), sizeof(ep_uemeas_det), n, 1);
+	case EP_ACT_MAC_REPORT:
+		if(!rep) {
+			return v->blen < sizeof(ep_macrep_req) ?
+				EP_ERROR : EP_SUCCESS;
+		}
+
+		if(v->op == EP_OPERATION_SUCCESS) {
+			return v->blen < sizeof(ep_macrep_rep) ?
+				EP_ERROR : EP_SUCCESS;
+		}
+
+		if(v->op == EP_OPERATION_UNCHANGED) {
+			return v->blen < sizeof(ep_macrep_unch) ?
+				EP_ERROR : EP_SUCCESS;
+		}
+
+		return EP_SUCCESS;
+	case EP_ACT_HANDOVER:
+		return v->blen < (rep ? sizeof(ep_ho_rep) : sizeof(ep_ho_req)) ?
+			EP_ERROR : EP_SUCCESS;
+	case EP_ACT_HO_BATCH:
+		if(!rep) {
+			if(v->blen < sizeof(ep_hob_req)) {
+				return EP_ERROR;
+			}
+
+			n = ntohs(((ep_hob_req *)v->body)->nof_ho);
+
+			return ep_view_array(
+				v, sizeof(ep_hob_req), sizeof(ep_ho_req), n, 0);
+		}
+
+		if(v->op == EP_OPERATION_NOT_SUPPORTED) {
+			return EP_SUCCESS;
+		}
+
+		if(v->blen < sizeof(ep_hob_rep)) {
+			return EP_ERROR;
+		}
+
+		n = ntohs(((ep_hob_rep *)v->body)->nof_ho);
+
+		return ep_view_array(
+			v, sizeof(ep_hob_rep), sizeof(ep_hob_res), n, 0);
+	case EP_ACT_RAN_SETUP:
+		if(!rep) {
+			return EP_SUCCESS;
+		}
+
+		if(v->blen < sizeof(ep_ran_setup)) {
+			return EP_ERROR;
+		}
+
+		return ep_view_TLVs(
+			v, v->body + sizeof(ep_ran_setup), v->body + v->blen);
+	case EP_ACT_RAN_SLICE:
+		/* Some replies carry no slice at all */
+		if(v->blen == 0) {
+			return EP_SUCCESS;
+		}
+
+		if(v->blen < sizeof(ep_ran_sinf)) {
+			return EP_ERROR;
+		}
+
+		return ep_view_TLVs(
+			v, v->body + sizeof(ep_ran_sinf), v->body + v->blen);
+	case EP_ACT_RAN_SLICE_BULK:
+		if(!rep) {
+			return ep_view_sblk(v);
+		}
+
+		if(v->op == EP_OPERATION_NOT_SUPPORTED) {
+			return EP_SUCCESS;
+		}
+
+		if(v->blen < sizeof(ep_ran_sblk)) {
+			return EP_ERROR;
+		}
+
+		n = ntohs(((ep_ran_sblk *)v->body)->nof_slices);
+
+		return ep_view_array(
+			v, sizeof(ep_ran_sblk), sizeof(ep_ran_sblk_res), n, 0);
+	}
+
+	/* Nothing else to check for the other actions */
+	return EP_SUCCESS;
+}
+
+/* Is the view of a successful reply to the given action? */
+static int ep_view_is_rep(ep_msg_view * v, uint16_t act)
+{
+	return v->act == act &&
+		v->dir == EP_HDR_FLAG_DIR_REP &&
+		v->op == EP_OPERATION_SUCCESS;
+}
+
+/* Mark the message of the view as decoded in place; the wire header is left
+ * as received. Returns 1 if it was already, 0 otherwise.
+ */
+static int ep_view_host(ep_msg_view * v)
+{
+	if(v->host) {
+		return 1;
+	}
+
+	v->host = 1;
+
+	return 0;
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+int ep_msg_validate(char * buf, unsigned int size, ep_msg_view * v)
+{
+	ep_hdr *     h = (ep_hdr *)buf;
+	ep_s_hdr *   e;
+	unsigned int hs;
+
+	if(!buf || !v) {
+		ep_dbg_log(EP_DBG_0"P - View: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(size < sizeof(ep_hdr)) {
+		ep_dbg_log(EP_DBG_0"P - View: Not enough space!\n");
+		return EP_ERROR;
+	}
+
+	if(h->vers != EMPOWER_PROTOCOL_VERS) {
+		ep_dbg_log(EP_DBG_0"P - View: Different protocol version!\n");
+		return EP_WRONG_VERSION;
+	}
+
+	memset(v, 0, sizeof(ep_msg_view));
+
+	v->buf  = buf;
+	v->len  = ntohs(h->length);
+	v->type = h->type;
+	v->dir  = h->flags & EP_HDR_FLAG_DIR;
+
+	if(v->len < sizeof(ep_hdr) || v->len > size) {
+		ep_dbg_log(EP_DBG_0"P - View: Length %u, buffer %u!\n",
+			v->len, size);
+		return EP_ERROR;
+	}
+
+	switch(v->type) {
+	case EP_TYPE_SINGLE_MSG:
+		hs = EP_SINGLE_HDR_SIZE;
+		break;
+	case EP_TYPE_SCHEDULE_MSG:
+		hs = EP_SCHED_HDR_SIZE;
+		break;
+	case EP_TYPE_TRIGGER_MSG:
+		hs = EP_TRIGGER_HDR_SIZE;
+		break;
+	default:
+		ep_dbg_log(EP_DBG_0"P - View: Unknown type %u!\n", v->type);
+		return EP_ERROR;
+	}
+
+	if(v->len < hs) {
+		ep_dbg_log(EP_DBG_0"P - View: Truncated event header!\n");
+		return EP_ERROR;
+	}
+
+	ep_trc_enb_cur(be64toh(h->id.enb_id));
+	ep_cap_hook(buf, v->len, EP_CAP_IN);
+
+	/* Type and operation lead all the event headers */
+	e       = (ep_s_hdr *)(buf + sizeof(ep_hdr));
+	v->act  = ntohs(e->type);
+	v->op   = e->op;
+	v->body = buf + hs;
+	v->blen = v->len - hs;
+
+	if(ep_view_body(v)) {
+		ep_dbg_log(EP_DBG_0"P - View: Malformed body of action %u!\n",
+			v->act);
+		return EP_ERROR;
+	}
+
+	ep_dbg_dump(EP_DBG_1"P - View: ", buf, v->len);
+
+	return EP_SUCCESS;
+}
+
+ep_uerep_det * ep_uerep_view_decode(ep_msg_view * v, uint32_t * nof)
+{
+	ep_uerep_det * d;
+	uint32_t       i;
+
+	if(!v || !ep_view_is_rep(v, EP_ACT_UE_REPORT)) {
+		ep_dbg_log(EP_DBG_2"P - View: Not an UE report reply!\n");
+		return 0;
+	}
+
+	d = (ep_uerep_det *)v->arr;
+
+	if(nof) {
+		*nof = v->nof;
+	}
+
+	if(ep_view_host(v)) {
+		return d;
+	}
+
+	for(i = 0; i < v->nof; i++) {
+		d[i].pci  = ntohs(d[i].pci);
+		d[i].plmn = ntohl(d[i].plmn);
+		d[i].rnti = ntohs(d[i].rnti);
+		d[i].imsi = be64toh(d[i].imsi);
+	}
+
+	return d;
+}
+
+ep_uemeas_det * ep_uemeas_view_decode(ep_msg_view * v, uint32_t * nof)
+{
+	ep_uemeas_det * d;
+	uint32_t        i;
+
+	if(!v || !ep_view_is_rep(v, EP_ACT_UE_MEASURE)) {
+		ep_dbg_log(EP_DBG_2"P - View: Not an UE measurement reply!\n");
+		return 0;
+	}
+
+	d = (ep_uemeas_det *)v->arr;
+
+	if(nof) {
+		*nof = v->nof;
+	}
+
+	if(ep_view_host(v)) {
+		return d;
+	}
+
+	for(i = 0; i < v->nof; i++) {
+		d[i].pci  = (int16_t)ntohs(d[i].pci);
+		d[i].rsrp = (int16_t)ntohs(d[i].rsrp);
+		d[i].rsrq = (int16_t)ntohs(d[i].rsrq);
+	}
+
+	return d;
+}
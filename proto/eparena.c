@@ -0,0 +1,182 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_CORE
+
+#include <emproto.h>
+
+/* Start to use a chunk */
+static void ep_arena_use(ep_arena * a, ep_arena_chunk * c)
+{
+	a->chunk = c;
+	a->cur   = c->data;
+	a->end   = c->data + c->size;
+}
+
+/* Append a new chunk of at least 'size' bytes.
+ * Returns the chunk, or NULL if there's not enough memory.
+ */
+static ep_arena_chunk * ep_arena_grow(ep_arena * a, size_t size)
+{
+	ep_arena_chunk * c;
+	ep_arena_chunk * l;
+
+	if(size < a->csize) {
+		size = a->csize;
+	}
+
+	c = malloc(sizeof(ep_arena_chunk) + size);
+
+	if(!c) {
+		ep_dbg_log(EP_DBG_0"ARENA: Not enough memory!\n");
+		return 0;
+	}
+
+	c->next = 0;
+	c->size = size;
+	c->ext  = 0;
+
+	if(!a->first) {
+		a->first = c;
+		return c;
+	}
+
+	for(l = a->chunk ? a->chunk : a->first; l->next; l = l->next);
+
+	l->next = c;
+
+	return c;
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+int ep_arena_init(ep_arena * a, void * mem, size_t size)
+{
+	ep_arena_chunk * c;
+	uintptr_t        p;
+
+	if(!a) {
+		return -1;
+	}
+
+	a->first = 0;
+	a->chunk = 0;
+	a->cur   = 0;
+	a->end   = 0;
+	a->csize = size ? size : EP_ARENA_CHUNK;
+
+	if(!mem) {
+		c = ep_arena_grow(a, a->csize);
+
+		if(!c) {
+			return -1;
+		}
+
+		ep_arena_use(a, c);
+
+		return 0;
+	}
+
+	/* The chunk header lives in the given memory too */
+	p = ((uintptr_t)mem + 7) & ~(uintptr_t)7;
+
+	if(p + sizeof(ep_arena_chunk) >= (uintptr_t)mem + size) {
+		ep_dbg_log(EP_DBG_0"ARENA: Memory too small!\n");
+		return -1;
+	}
+
+	c       = (ep_arena_chunk *)p;
+	c->next = 0;
+	c->size = (uintptr_t)mem + size - p - sizeof(ep_arena_chunk);
+	c->ext  = 1;
+
+	a->first = c;
+	ep_arena_use(a, c);
+
+	return 0;
+}
+
+void ep_arena_release(ep_arena * a)
+{
+	ep_arena_chunk * c;
+	ep_arena_chunk * n;
+
+	if(!a) {
+		return;
+	}
+
+	for(c = a->first; c; c = n) {
+		n = c->next;
+
+		if(!c->ext) {
+			free(c);
+		}
+	}
+
+	a->first = 0;
+	a->chunk = 0;
+	a->cur   = 0;
+	a->end   = 0;
+}
+
+void * ep_arena_alloc(ep_arena * a, size_t size)
+{
+	ep_arena_chunk * c;
+	char *           p;
+
+	size = (size + 7) & ~(size_t)7;
+
+	if(a->cur && (size_t)(a->end - a->cur) >= size) {
+		p       = a->cur;
+		a->cur += size;
+		return p;
+	}
+
+	/* Chunks kept from the previous messages are used first */
+	for(c = a->chunk ? a->chunk->next : a->first; c; c = c->next) {
+		if(c->size >= size) {
+			break;
+		}
+	}
+
+	if(!c) {
+		c = ep_arena_grow(a, size);
+
+		if(!c) {
+			return 0;
+		}
+	}
+
+	ep_arena_use(a, c);
+
+	p       = a->cur;
+	a->cur += size;
+
+	return p;
+}
+
+void ep_arena_reset(ep_arena * a)
+{
+	if(a && a->first) {
+		ep_arena_use(a, a->first);
+	}
+}
@@ -0,0 +1,262 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_CORE
+
+#include <emproto.h>
+
+/* Maximum free buffers cached by a thread, for each class */
+#define EP_MBUF_CACHE_MAX	64
+/* Buffers moved at once between a cache and the depot */
+#define EP_MBUF_BATCH		(EP_MBUF_CACHE_MAX / 2)
+/* Target size of the memory obtained from the system at once */
+#define EP_MBUF_SLAB		(256 * 1024)
+
+/* Free buffers of a class */
+typedef struct __ep_mbuf_list {
+	ep_mbuf * head;
+	uint32_t  nof;
+} ep_mbuf_list;
+
+/* Global depot of a class */
+typedef struct __ep_mbuf_depot {
+	pthread_mutex_t lock;
+	ep_mbuf_list    free;
+	uint64_t        allocated;
+} ep_mbuf_depot;
+
+static const uint32_t ep_mbuf_sizes[EP_MBUF_CLASSES] = {
+	EP_MBUF_HDR, EP_MBUF_SMALL, EP_MBUF_MEDIUM, EP_MBUF_LARGE, EP_MBUF_MAX
+};
+
+static ep_mbuf_depot ep_mbuf_depots[EP_MBUF_CLASSES] = {
+	{PTHREAD_MUTEX_INITIALIZER, {0, 0}, 0},
+	{PTHREAD_MUTEX_INITIALIZER, {0, 0}, 0},
+	{PTHREAD_MUTEX_INITIALIZER, {0, 0}, 0},
+	{PTHREAD_MUTEX_INITIALIZER, {0, 0}, 0},
+	{PTHREAD_MUTEX_INITIALIZER, {0, 0}, 0},
+};
+
+static pthread_once_t ep_mbuf_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  ep_mbuf_key;
+
+/* Caches of the thread */
+static __thread ep_mbuf_list ep_mbuf_cache[EP_MBUF_CLASSES];
+static __thread int          ep_mbuf_reg = 0;
+
+/* Move up to 'n' buffers from a list to another */
+static void ep_mbuf_move(ep_mbuf_list * to, ep_mbuf_list * from, uint32_t n)
+{
+	ep_mbuf * m;
+
+	while(n-- > 0 && from->head) {
+		m          = from->head;
+		from->head = m->next;
+		from->nof--;
+
+		m->next    = to->head;
+		to->head   = m;
+		to->nof++;
+	}
+}
+
+/* Thread terminated; its buffers go back to the depot */
+static void ep_mbuf_exit(void * arg)
+{
+	ep_mbuf_trim();
+}
+
+static void ep_mbuf_setup(void)
+{
+	pthread_key_create(&ep_mbuf_key, ep_mbuf_exit);
+}
+
+/* Release the caches of the thread when it terminates; needed by any thread
+ * with a cache, which is also one that only releases buffers.
+ */
+static void ep_mbuf_register(void)
+{
+	if(!ep_mbuf_reg) {
+		pthread_once(&ep_mbuf_once, ep_mbuf_setup);
+		pthread_setspecific(ep_mbuf_key, (void *)1);
+		ep_mbuf_reg = 1;
+	}
+}
+
+/* Refill the cache of the thread from the depot, or from the system.
+ * Returns 0 on success, or -1 if there's not enough memory.
+ */
+static int ep_mbuf_refill(uint32_t cls)
+{
+	ep_mbuf_depot * d = &ep_mbuf_depots[cls];
+	ep_mbuf *       m;
+	char *          slab;
+	uint32_t        stride;
+	uint32_t        n;
+	uint32_t        i;
+
+	ep_mbuf_register();
+
+	pthread_mutex_lock(&d->lock);
+	ep_mbuf_move(&ep_mbuf_cache[cls], &d->free, EP_MBUF_BATCH);
+	pthread_mutex_unlock(&d->lock);
+
+	if(ep_mbuf_cache[cls].nof) {
+		return 0;
+	}
+
+	/* Keep buffers on their own cache lines */
+	stride = (sizeof(ep_mbuf) + ep_mbuf_sizes[cls] + 63) & ~63;
+	n      = EP_MBUF_SLAB / stride;
+
+	if(n > EP_MBUF_BATCH) {
+		n = EP_MBUF_BATCH;
+	} else if(n == 0) {
+		n = 1;
+	}
+
+	if(posix_memalign((void **)&slab, 64, (size_t)stride * n)) {
+		ep_dbg_log(EP_DBG_0"MBUF: Not enough memory!\n");
+		return -1;
+	}
+
+	for(i = 0; i < n; i++) {
+		m       = (ep_mbuf *)(slab + (size_t)stride * i);
+		m->cls  = cls;
+		m->size = ep_mbuf_sizes[cls];
+		m->next = ep_mbuf_cache[cls].head;
+
+		ep_mbuf_cache[cls].head = m;
+		ep_mbuf_cache[cls].nof++;
+	}
+
+	__atomic_add_fetch(&d->allocated, n, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+ep_mbuf * ep_mbuf_alloc(unsigned int size)
+{
+	ep_mbuf_list * c;
+	ep_mbuf *      m;
+	uint32_t       cls;
+
+	for(cls = 0; cls < EP_MBUF_CLASSES; cls++) {
+		if(size <= ep_mbuf_sizes[cls]) {
+			break;
+		}
+	}
+
+	if(cls == EP_MBUF_CLASSES) {
+		ep_dbg_log(EP_DBG_0"MBUF: Size %u too big!\n", size);
+		return 0;
+	}
+
+	c = &ep_mbuf_cache[cls];
+
+	if(!c->head && ep_mbuf_refill(cls)) {
+		return 0;
+	}
+
+	m       = c->head;
+	c->head = m->next;
+	c->nof--;
+
+	m->refs = 1;
+	m->len  = 0;
+	m->next = 0;
+
+	return m;
+}
+
+ep_mbuf * ep_mbuf_get(ep_mbuf * m)
+{
+	if(m) {
+		__atomic_add_fetch(&m->refs, 1, __ATOMIC_RELAXED);
+	}
+
+	return m;
+}
+
+void ep_mbuf_put(ep_mbuf * m)
+{
+	ep_mbuf_list *  c;
+	ep_mbuf_depot * d;
+
+	if(!m || __atomic_sub_fetch(&m->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+		return;
+	}
+
+	/* Buffers go to the cache of the thread releasing them */
+	ep_mbuf_register();
+
+	c       = &ep_mbuf_cache[m->cls];
+	m->next = c->head;
+	c->head = m;
+	c->nof++;
+
+	if(c->nof > EP_MBUF_CACHE_MAX) {
+		d = &ep_mbuf_depots[m->cls];
+
+		pthread_mutex_lock(&d->lock);
+		ep_mbuf_move(&d->free, c, EP_MBUF_BATCH);
+		pthread_mutex_unlock(&d->lock);
+	}
+}
+
+void ep_mbuf_trim()
+{
+	ep_mbuf_depot * d;
+	uint32_t        i;
+
+	for(i = 0; i < EP_MBUF_CLASSES; i++) {
+		if(!ep_mbuf_cache[i].nof) {
+			continue;
+		}
+
+		d = &ep_mbuf_depots[i];
+
+		pthread_mutex_lock(&d->lock);
+		ep_mbuf_move(&d->free, &ep_mbuf_cache[i], ep_mbuf_cache[i].nof);
+		pthread_mutex_unlock(&d->lock);
+	}
+}
+
+int ep_mbuf_stat(unsigned int cls, ep_mbuf_stats * stats)
+{
+	ep_mbuf_depot * d;
+
+	if(cls >= EP_MBUF_CLASSES || !stats) {
+		return -1;
+	}
+
+	d = &ep_mbuf_depots[cls];
+
+	pthread_mutex_lock(&d->lock);
+	stats->allocated = d->allocated;
+	stats->depot     = d->free.nof;
+	pthread_mutex_unlock(&d->lock);
+
+	return 0;
+}
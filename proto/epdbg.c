@@ -14,72 +14,542 @@
  * limitations under the License.
  */
 
+/*
+ * Logging is asynchronous: every thread appends binary records to its own
+ * lock-free ring, and a background thread drains the rings into the log file.
+ * Writers never block nor make system calls; if a ring is full the record is
+ * dropped and accounted. Ordering is kept between records of the same thread.
+ */
+
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include <emproto.h>
 
+/* Size of the ring of a single thread; must be a power of 2 */
+#define EP_DBG_RING_SIZE	(1 << 20)
+/* Maximum size of a single record */
+#define EP_DBG_REC_MAX		(EP_DBG_RING_SIZE / 4)
+/* Maximum size of a text message */
+#define EP_DBG_TEXT_MAX		1024
+/* Maximum idle time of the drain thread, in us */
+#define EP_DBG_IDLE_MAX		1000
+
+/* Record kinds */
+#define EP_DBG_REC_PAD		0	/* Skip to the end of the ring */
+#define EP_DBG_REC_TEXT		1	/* Text message */
+#define EP_DBG_REC_DUMP		2	/* Prologue and buffer to dump */
+
+typedef struct __ep_dbg_record {
+	uint32_t len;   /* Size of the record, aligned to 8 bytes */
+	uint16_t kind;  /* Kind of record */
+	uint16_t plen;  /* Length of the prologue, for dumps */
+	uint32_t dlen;  /* Length of the data */
+	uint32_t trunc; /* Bytes of the data which did not fit */
+} ep_dbg_rec;
+
+typedef struct __ep_dbg_ring {
+	uint64_t               head;    /* Written by the owner thread */
+	char                   pad0[56];
+	uint64_t               tail;    /* Written by the drain thread */
+	char                   pad1[56];
+	uint64_t               dropped; /* Records dropped by the owner */
+	uint64_t               seen;    /* Drops already reported */
+	int                    dead;    /* Owner thread terminated */
+	struct __ep_dbg_ring * next;    /* Next registered ring */
+	char                   data[EP_DBG_RING_SIZE];
+} ep_dbg_ring;
+
+/* Debugging profile traces everything since the start */
+#ifdef EBUG
+#define EP_TRC_INIT		EP_TRC_ALL
+#else
+#define EP_TRC_INIT		0
+#endif
+
 volatile int ep_dbg_ready = 0;
 int          ep_dbg_std   = 0;
 FILE *       ep_dbg_fd    = 0;
 
-/* The debugging module tries first to open the standard FD; if it's not 
- * possible, it then dump everything on the standard output.
+uint64_t          ep_trc_mask  = EP_TRC_INIT;
+__thread uint64_t ep_trc_cur   = 0;
+
+static int        ep_trc_level = EP_TRC_DUMP;
+static uint64_t   ep_trc_only  = EP_TRC_ENB_ANY;
+
+/* Names of the categories, as given in EMPROTO_TRACE */
+static const struct {
+	const char * name;
+	uint64_t     mask;
+} ep_trc_names[] = {
+	{"all",    EP_TRC_ALL},
+	{"hdr",    EP_TRC_HDR},
+	{"tlv",    EP_TRC_TLV},
+	{"core",   EP_TRC_CORE},
+	{"hello",  EP_TRC_ACT(EP_ACT_HELLO)},
+	{"ecap",   EP_TRC_ACT(EP_ACT_ECAP)},
+	{"ccap",   EP_TRC_ACT(EP_ACT_CCAP)},
+	{"uerep",  EP_TRC_ACT(EP_ACT_UE_REPORT)},
+	{"uemeas", EP_TRC_ACT(EP_ACT_UE_MEASURE)},
+	{"macrep", EP_TRC_ACT(EP_ACT_MAC_REPORT)},
+	{"ho",     EP_TRC_ACT(EP_ACT_HANDOVER) |
+		   EP_TRC_ACT(EP_ACT_HO_BATCH)},
+	{"ran",    EP_TRC_ACT(EP_ACT_RAN_SETUP)},
+	{"slice",  EP_TRC_ACT(EP_ACT_RAN_SLICE) |
+		   EP_TRC_ACT(EP_ACT_RAN_SLICE_BULK)},
+};
+
+static pthread_once_t  ep_dbg_once  = PTHREAD_ONCE_INIT;
+static pthread_mutex_t ep_dbg_lock  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t   ep_dbg_key;
+static pthread_t       ep_dbg_thread;
+static ep_dbg_ring *   ep_dbg_rings = 0;
+static int             ep_dbg_stop  = 0;
+
+static __thread ep_dbg_ring * ep_dbg_tls = 0;
+
+/* The owner thread terminated; the drain thread frees the ring once empty */
+static void ep_dbg_ring_dead(void * arg)
+{
+	ep_dbg_ring * r = (ep_dbg_ring *)arg;
+
+	ep_dbg_tls = 0;
+	__atomic_store_n(&r->dead, 1, __ATOMIC_RELEASE);
+}
+
+/* Get the ring of the calling thread, registering it the first time */
+static ep_dbg_ring * ep_dbg_ring_get(void)
+{
+	ep_dbg_ring * r = ep_dbg_tls;
+
+	if(r) {
+		return r;
+	}
+
+	r = calloc(1, sizeof(ep_dbg_ring));
+
+	if(!r) {
+		return 0;
+	}
+
+	pthread_mutex_lock(&ep_dbg_lock);
+	r->next      = ep_dbg_rings;
+	ep_dbg_rings = r;
+	pthread_mutex_unlock(&ep_dbg_lock);
+
+	pthread_setspecific(ep_dbg_key, r);
+	ep_dbg_tls = r;
+
+	return r;
+}
+
+/* Append a record to the ring of the calling thread */
+static void ep_dbg_push(int kind, char * p, int plen, char * d, int dlen)
+{
+	ep_dbg_ring * r = ep_dbg_ring_get();
+	ep_dbg_rec    rec;
+	char *        b;
+	uint64_t      h;
+	uint64_t      t;
+	uint32_t      len;
+	uint32_t      end;
+
+	if(!r) {
+		return;
+	}
+
+	rec.kind  = kind;
+	rec.plen  = plen;
+	rec.trunc = 0;
+
+	/* Huge dumps are cut, but the lost size is reported */
+	if(sizeof(ep_dbg_rec) + plen + dlen > EP_DBG_REC_MAX) {
+		rec.trunc = sizeof(ep_dbg_rec) + plen + dlen - EP_DBG_REC_MAX;
+		dlen     -= rec.trunc;
+	}
+
+	rec.dlen = dlen;
+	len      = (sizeof(ep_dbg_rec) + plen + dlen + 7) & ~7;
+	rec.len  = len;
+
+	h   = r->head;
+	t   = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+	end = EP_DBG_RING_SIZE - (h & (EP_DBG_RING_SIZE - 1));
+
+	/* Records never wrap; pad the end of the ring if necessary */
+	if(end < len) {
+		if(h + end + len - t > EP_DBG_RING_SIZE) {
+			__atomic_add_fetch(&r->dropped, 1, __ATOMIC_RELAXED);
+			return;
+		}
+
+		((ep_dbg_rec *)(r->data + (EP_DBG_RING_SIZE - end)))->len  = end;
+		((ep_dbg_rec *)(r->data + (EP_DBG_RING_SIZE - end)))->kind =
+			EP_DBG_REC_PAD;
+
+		h += end;
+	}
+	else if(h + len - t > EP_DBG_RING_SIZE) {
+		__atomic_add_fetch(&r->dropped, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	b = r->data + (h & (EP_DBG_RING_SIZE - 1));
+
+	memcpy(b, &rec, sizeof(ep_dbg_rec));
+
+	if(plen) {
+		memcpy(b + sizeof(ep_dbg_rec), p, plen);
+	}
+
+	if(dlen) {
+		memcpy(b + sizeof(ep_dbg_rec) + plen, d, dlen);
+	}
+
+	__atomic_store_n(&r->head, h + len, __ATOMIC_RELEASE);
+}
+
+/* Format a record in the log file */
+static void ep_dbg_write(FILE * fd, ep_dbg_rec * rec)
+{
+	static const char hex[] = "0123456789abcdef";
+
+	char          out[3 * 256];
+	char *        d = (char *)(rec + 1);
+	unsigned char c;
+	uint32_t      i;
+	uint32_t      j;
+
+	switch(rec->kind) {
+	case EP_DBG_REC_TEXT:
+		fwrite(d, 1, rec->dlen, fd);
+		break;
+	case EP_DBG_REC_DUMP:
+		fwrite(d, 1, rec->plen, fd);
+		d += rec->plen;
+
+		for(i = 0; i < rec->dlen; ) {
+			for(j = 0; j < sizeof(out) && i < rec->dlen; i++) {
+				c        = (unsigned char)d[i];
+				out[j++] = hex[c >> 4];
+				out[j++] = hex[c & 0x0f];
+				out[j++] = ' ';
+			}
+
+			fwrite(out, 1, j, fd);
+		}
+
+		if(rec->trunc) {
+			fprintf(fd, "... (%u bytes more)", rec->trunc);
+		}
+
+		fputc('\n', fd);
+		break;
+	}
+}
+
+/* Drain all the records of a ring.
+ * Returns the number of records written.
  */
-void ep_dbg_init()
+static int ep_dbg_drain_ring(FILE * fd, ep_dbg_ring * r)
 {
-        char lp[256] = {0};
+	ep_dbg_rec * rec;
+	uint64_t     h = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+	uint64_t     t = r->tail;
+	uint64_t     d = __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+	int          n = 0;
+
+	if(d != r->seen) {
+		fprintf(fd, "DBG: %lu log records dropped!\n",
+			(unsigned long)(d - r->seen));
+		r->seen = d;
+	}
+
+	while(t < h) {
+		rec = (ep_dbg_rec *)(r->data + (t & (EP_DBG_RING_SIZE - 1)));
+
+		ep_dbg_write(fd, rec);
+
+		t += rec->len;
+		n++;
+	}
+
+	__atomic_store_n(&r->tail, t, __ATOMIC_RELEASE);
+
+	return n;
+}
+
+/* Drain all the rings, releasing the ones of terminated threads.
+ * Returns the number of records written.
+ */
+static int ep_dbg_drain(void)
+{
+	FILE *         fd = ep_dbg_std ? stdout : ep_dbg_fd;
+	ep_dbg_ring ** p;
+	ep_dbg_ring *  r;
+	int            n  = 0;
+
+	pthread_mutex_lock(&ep_dbg_lock);
+
+	for(p = &ep_dbg_rings; *p; ) {
+		r = *p;
+
+		/* Dead flag first: no record can follow it */
+		if(__atomic_load_n(&r->dead, __ATOMIC_ACQUIRE)) {
+			n += ep_dbg_drain_ring(fd, r);
+			*p = r->next;
+			free(r);
+			continue;
+		}
+
+		n += ep_dbg_drain_ring(fd, r);
+		p  = &r->next;
+	}
+
+	pthread_mutex_unlock(&ep_dbg_lock);
+
+	if(n) {
+		fflush(fd);
+	}
 
-        /* Unique log per process */
-        sprintf(lp, "./emproto.%d.log", getpid());
+	return n;
+}
+
+/* Background formatting of the logs */
+static void * ep_dbg_loop(void * arg)
+{
+	struct timespec ts = {0};
+	long            us = 1;
+
+	while(!__atomic_load_n(&ep_dbg_stop, __ATOMIC_ACQUIRE)) {
+		/* Back off while there is nothing to do */
+		if(ep_dbg_drain()) {
+			us = 1;
+		} else if(us < EP_DBG_IDLE_MAX) {
+			us <<= 1;
+		}
+
+		ts.tv_nsec = us * 1000;
+		nanosleep(&ts, 0);
+	}
+
+	return 0;
+}
+
+/* Stop the drain thread and write out what is left */
+static void ep_dbg_exit(void)
+{
+	__atomic_store_n(&ep_dbg_stop, 1, __ATOMIC_RELEASE);
+	pthread_join(ep_dbg_thread, 0);
+
+	ep_dbg_drain();
+}
+
+static void ep_dbg_setup(void)
+{
+	char lp[256] = {0};
+
+	/* Unique log per process */
+	sprintf(lp, "./emproto.%d.log", getpid());
 	ep_dbg_fd = fopen(lp, "w");
 
 	if (!ep_dbg_fd) {
 		ep_dbg_std = 1;
 	}
 
-	ep_dbg_ready = 1;
+	pthread_key_create(&ep_dbg_key, ep_dbg_ring_dead);
+
+	if(pthread_create(&ep_dbg_thread, 0, ep_dbg_loop, 0) == 0) {
+		atexit(ep_dbg_exit);
+	}
+
+	__atomic_store_n(&ep_dbg_ready, 1, __ATOMIC_RELEASE);
 }
 
-void ep_dbg(char * prologue, char * buf, int size)
+/* Apply the level and eNB filters to a trace point.
+ * Returns 1 if it has to be traced, 0 otherwise.
+ */
+static int ep_trc_pass(char * msg, int dump)
 {
+	int level = __atomic_load_n(&ep_trc_level, __ATOMIC_RELAXED);
 	int i;
 
-	if(!ep_dbg_ready) {
+	if(ep_trc_only != EP_TRC_ENB_ANY && ep_trc_only != ep_trc_cur) {
+		return 0;
+	}
+
+	if(dump) {
+		return level >= EP_TRC_DUMP;
+	}
+
+	/* Nesting level of the message, see EP_DBG_n */
+	for(i = 0; msg && msg[i] == ' '; i++);
+
+	return level >= EP_TRC_ERR + (i / 4 < 2 ? i / 4 : 2);
+}
+
+/* Read the initial setup from the environment */
+__attribute__((constructor)) static void ep_trc_env(void)
+{
+	char * spec = getenv("EMPROTO_TRACE");
+
+	if(spec && ep_trc_parse(spec)) {
+		fprintf(stderr, "emproto: Invalid EMPROTO_TRACE '%s'\n", spec);
+	}
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+/* The debugging module tries first to open the standard FD; if it's not 
+ * possible, it then dump everything on the standard output.
+ */
+void ep_dbg_init()
+{
+	pthread_once(&ep_dbg_once, ep_dbg_setup);
+}
+
+void ep_dbg(char * prologue, char * buf, int size)
+{
+	if(!__atomic_load_n(&ep_dbg_ready, __ATOMIC_ACQUIRE)) {
 		ep_dbg_init();
 	}
 
-	ep_dbg_log(prologue);
+	ep_dbg_push(
+		EP_DBG_REC_DUMP,
+		prologue,
+		prologue ? strlen(prologue) : 0,
+		buf,
+		buf && size > 0 ? size : 0);
+}
+
+void ep_dbg_flush()
+{
+	if(__atomic_load_n(&ep_dbg_ready, __ATOMIC_ACQUIRE)) {
+		ep_dbg_drain();
+	}
+}
+
+void ep_trc_set(uint64_t mask, int level)
+{
+	__atomic_store_n(&ep_trc_level, level, __ATOMIC_RELAXED);
+	__atomic_store_n(&ep_trc_mask, level > EP_TRC_OFF ? mask : 0,
+		__ATOMIC_RELEASE);
+}
+
+void ep_trc_enb(uint64_t enb_id)
+{
+	__atomic_store_n(&ep_trc_only, enb_id, __ATOMIC_RELAXED);
+}
+
+int ep_trc_parse(const char * spec)
+{
+	char       tok[64];
+	uint64_t   mask  = 0;
+	uint64_t   enb   = EP_TRC_ENB_ANY;
+	int        level = EP_TRC_DUMP;
+	size_t     n;
+	size_t     i;
+	char *     end;
+
+	if(!spec) {
+		return -1;
+	}
+
+	while(*spec) {
+		n = strcspn(spec, ",");
+
+		if(n >= sizeof(tok)) {
+			return -1;
+		}
+
+		memcpy(tok, spec, n);
+		tok[n] = 0;
+		spec  += spec[n] ? n + 1 : n;
+
+		if(n == 0) {
+			continue;
+		}
 
-	for(i = 0; i < size; i++) {
-		ep_dbg_log("%02x ", (unsigned char)buf[i]);
+		if(strncmp(tok, "level=", 6) == 0) {
+			level = strtol(tok + 6, &end, 10);
+
+			if(*end || end == tok + 6) {
+				return -1;
+			}
+
+			continue;
+		}
+
+		if(strncmp(tok, "enb=", 4) == 0) {
+			enb = strtoull(tok + 4, &end, 0);
+
+			if(*end || end == tok + 4) {
+				return -1;
+			}
+
+			continue;
+		}
+
+		for(i = 0; i < sizeof(ep_trc_names) / sizeof(ep_trc_names[0]); i++) {
+			if(strcmp(tok, ep_trc_names[i].name) == 0) {
+				mask |= ep_trc_names[i].mask;
+				break;
+			}
+		}
+
+		if(i == sizeof(ep_trc_names) / sizeof(ep_trc_names[0])) {
+			return -1;
+		}
 	}
 
-	ep_dbg_log("\n");
+	ep_trc_enb(enb);
+	ep_trc_set(mask, level);
+
+	return 0;
 }
 
-/* Just dump the messages somewhere...
+/* Text is formatted by the caller, since arguments like strings can't be
+ * safely referenced later; it's still far cheaper than writing it.
  */
-void ep_dbg_log(char * msg, ...)
+void ep_trc_log(uint64_t cat, char * msg, ...)
 {
-	FILE *  fd;
+	char    text[EP_DBG_TEXT_MAX];
 	va_list vl;
+	int     n;
 
-	va_start(vl, msg);
-	
-	if (ep_dbg_std) {
-		fd = stdout;
-	} else {
-		fd = ep_dbg_fd;
+	if(!(ep_trc_mask & cat) || !ep_trc_pass(msg, 0)) {
+		return;
 	}
 
-	/* Prints and flush the file; slow, but accurate in case of error */
-	vfprintf(fd, msg, vl);
-	fflush(fd);
+	if(!__atomic_load_n(&ep_dbg_ready, __ATOMIC_ACQUIRE)) {
+		ep_dbg_init();
+	}
 
+	va_start(vl, msg);
+	n = vsnprintf(text, sizeof(text), msg, vl);
 	va_end(vl);
 
-	return;
+	if(n < 0) {
+		return;
+	}
+
+	if(n >= (int)sizeof(text)) {
+		n = sizeof(text) - 1;
+	}
+
+	ep_dbg_push(EP_DBG_REC_TEXT, 0, 0, text, n);
+}
+
+void ep_trc_dump(uint64_t cat, char * prologue, char * buf, int size)
+{
+	if((ep_trc_mask & cat) && ep_trc_pass(prologue, 1)) {
+		ep_dbg(prologue, buf, size);
+	}
 }
@@ -0,0 +1,164 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_CORE
+
+#include <emproto.h>
+
+/* Mix the bits of the key; identifiers are usually sequential */
+static uint32_t ep_hmap_hash(uint64_t key, uint32_t sub)
+{
+	key ^= (uint64_t)sub * 0x9e3779b97f4a7c15ULL;
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+
+	return (uint32_t)key;
+}
+
+/* Find the slot of the key, or the empty slot where it should go */
+static uint32_t ep_hmap_find(ep_hmap * m, uint64_t key, uint32_t sub)
+{
+	uint32_t i = ep_hmap_hash(key, sub) & m->mask;
+
+	while(m->slots[i].val) {
+		if(m->slots[i].key == key && m->slots[i].sub == sub) {
+			break;
+		}
+
+		i = (i + 1) & m->mask;
+	}
+
+	return i;
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+int ep_hmap_init(ep_hmap * m, uint32_t max)
+{
+	uint32_t n = 2;
+
+	if(!m || max == 0 || max > 0x40000000) {
+		ep_dbg_log(EP_DBG_0"HMAP: Invalid size!\n");
+		return EP_ERROR;
+	}
+
+	/* Keep the load factor under 50% */
+	while(n < max * 2) {
+		n <<= 1;
+	}
+
+	m->slots = calloc(n, sizeof(ep_hslot));
+
+	if(!m->slots) {
+		ep_dbg_log(EP_DBG_0"HMAP: Not enough memory!\n");
+		return EP_ERROR;
+	}
+
+	m->mask = n - 1;
+	m->max  = max;
+	m->nof  = 0;
+
+	return EP_SUCCESS;
+}
+
+void ep_hmap_release(ep_hmap * m)
+{
+	if(!m) {
+		return;
+	}
+
+	free(m->slots);
+
+	m->slots = 0;
+	m->mask  = 0;
+	m->max   = 0;
+	m->nof   = 0;
+}
+
+uint32_t ep_hmap_get(ep_hmap * m, uint64_t key, uint32_t sub)
+{
+	return m->slots[ep_hmap_find(m, key, sub)].val;
+}
+
+int ep_hmap_put(ep_hmap * m, uint64_t key, uint32_t sub, uint32_t val)
+{
+	uint32_t i = ep_hmap_find(m, key, sub);
+
+	if(val == 0) {
+		return EP_ERROR;
+	}
+
+	if(!m->slots[i].val) {
+		if(m->nof >= m->max) {
+			ep_dbg_log(EP_DBG_0"HMAP: Map is full!\n");
+			return EP_ERROR;
+		}
+
+		m->slots[i].key = key;
+		m->slots[i].sub = sub;
+		m->nof++;
+	}
+
+	m->slots[i].val = val;
+
+	return EP_SUCCESS;
+}
+
+uint32_t ep_hmap_del(ep_hmap * m, uint64_t key, uint32_t sub)
+{
+	uint32_t i = ep_hmap_find(m, key, sub);
+	uint32_t j;
+	uint32_t h;
+	uint32_t v = m->slots[i].val;
+
+	if(!v) {
+		return 0;
+	}
+
+	/* Shift back the following elements of the cluster, so that lookups
+	 * never need tombstones.
+	 */
+	j = i;
+
+	for(;;) {
+		j = (j + 1) & m->mask;
+
+		if(!m->slots[j].val) {
+			break;
+		}
+
+		h = ep_hmap_hash(m->slots[j].key, m->slots[j].sub) & m->mask;
+
+		/* Can the element at 'j' be moved in the hole at 'i'? */
+		if(((j - h) & m->mask) >= ((j - i) & m->mask)) {
+			m->slots[i] = m->slots[j];
+			i = j;
+		}
+	}
+
+	m->slots[i].val = 0;
+	m->nof--;
+
+	return v;
+}
@@ -0,0 +1,318 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <time.h>
+
+/* Trace points of the module */
+#define EP_TRC_CAT		EP_TRC_CORE
+
+#include <emproto.h>
+
+#define EP_TW_MASK		(EP_TW_SLOTS - 1)
+
+/* Index of the slot at the given level for the given time */
+#define ep_tw_index(t, l)	(((t) >> (EP_TW_BITS * (l))) & EP_TW_MASK)
+
+static void ep_tw_list_init(ep_tw_node * h)
+{
+	h->next = h;
+	h->prev = h;
+}
+
+static void ep_tw_list_add(ep_tw_node * h, ep_tw_node * n)
+{
+	n->next       = h;
+	n->prev       = h->prev;
+	h->prev->next = n;
+	h->prev       = n;
+}
+
+static void ep_tw_list_del(ep_tw_node * n)
+{
+	n->prev->next = n->next;
+	n->next->prev = n->prev;
+	n->next       = 0;
+	n->prev       = 0;
+}
+
+/* Moves all the elements of list 'h' into the empty list 'to' */
+static void ep_tw_list_splice(ep_tw_node * h, ep_tw_node * to)
+{
+	if(h->next == h) {
+		ep_tw_list_init(to);
+		return;
+	}
+
+	to->next       = h->next;
+	to->prev       = h->prev;
+	to->next->prev = to;
+	to->prev->next = to;
+
+	ep_tw_list_init(h);
+}
+
+/* Place a timer in the right slot depending on its distance from the next
+ * tick to process. Timers already expired will fire at the next tick.
+ */
+static void ep_tw_place(ep_tw * w, ep_tw_timer * t)
+{
+	uint64_t base = w->now + 1;
+	uint64_t exp  = t->expires;
+	uint64_t d;
+	int      l;
+
+	if(exp < base) {
+		exp = base;
+	}
+
+	d = exp - base;
+
+	/* Too far in the future; it will cascade again through the top level */
+	if(d > EP_TW_MAX_DELAY) {
+		d   = EP_TW_MAX_DELAY;
+		exp = base + d;
+	}
+
+	for(l = 0; l < EP_TW_LEVELS - 1; l++) {
+		if(d < (1ULL << (EP_TW_BITS * (l + 1)))) {
+			break;
+		}
+	}
+
+	ep_tw_list_add(&w->slots[l][ep_tw_index(exp, l)], &t->node);
+}
+
+/* Re-distribute the timers of a slot of an upper level in the lower ones.
+ * Returns the index of the cascaded slot.
+ */
+static int ep_tw_cascade(ep_tw * w, int level, uint64_t tick)
+{
+	int          i = ep_tw_index(tick, level);
+	ep_tw_node   l;
+	ep_tw_node * n;
+
+	ep_tw_list_splice(&w->slots[level][i], &l);
+
+	while(l.next != &l) {
+		n = l.next;
+
+		ep_tw_list_del(n);
+		ep_tw_place(w, (ep_tw_timer *)n);
+	}
+
+	return i;
+}
+
+/******************************************************************************
+ * Public API                                                                 *
+ ******************************************************************************/
+
+uint64_t ep_tw_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void ep_tw_init(ep_tw * w, uint64_t now)
+{
+	int i;
+	int j;
+
+	w->now        = now;
+	w->nof_timers = 0;
+	w->running    = 0;
+	w->flush      = 0;
+	w->flush_arg  = 0;
+
+	for(i = 0; i < EP_TW_LEVELS; i++) {
+		for(j = 0; j < EP_TW_SLOTS; j++) {
+			ep_tw_list_init(&w->slots[i][j]);
+		}
+	}
+}
+
+void ep_tw_set_flush(ep_tw * w, ep_tw_flush flush, void * arg)
+{
+	w->flush     = flush;
+	w->flush_arg = arg;
+}
+
+void ep_tw_timer_init(ep_tw_timer * t, ep_tw_cb cb, void * arg)
+{
+	t->node.next = 0;
+	t->node.prev = 0;
+	t->expires   = 0;
+	t->interval  = 0;
+	t->cb        = cb;
+	t->arg       = arg;
+}
+
+int ep_tw_pending(ep_tw_timer * t)
+{
+	return t->node.next != 0;
+}
+
+int ep_tw_add(ep_tw * w, ep_tw_timer * t, uint32_t delay)
+{
+	if(!w || !t) {
+		ep_dbg_log(EP_DBG_0"TW: Invalid timer!\n");
+		return EP_ERROR;
+	}
+
+	if(ep_tw_pending(t)) {
+		ep_tw_list_del(&t->node);
+		w->nof_timers--;
+	}
+
+	t->expires  = w->now + delay;
+	t->interval = 0;
+
+	ep_tw_place(w, t);
+	w->nof_timers++;
+
+	return EP_SUCCESS;
+}
+
+int ep_tw_sched(ep_tw * w, ep_tw_timer * t, uint32_t interval)
+{
+	if(!w || !t || interval == 0) {
+		ep_dbg_log(EP_DBG_0"TW: Invalid periodic timer!\n");
+		return EP_ERROR;
+	}
+
+	if(ep_tw_pending(t)) {
+		ep_tw_list_del(&t->node);
+		w->nof_timers--;
+	}
+
+	/* Align on the period to coalesce timers with the same interval */
+	t->expires  = (w->now / interval + 1) * interval;
+	t->interval = interval;
+
+	ep_tw_place(w, t);
+	w->nof_timers++;
+
+	return EP_SUCCESS;
+}
+
+int ep_tw_sched_msg(
+	ep_tw *       w,
+	ep_tw_timer * t,
+	char *        buf,
+	unsigned int  size)
+{
+	if(!buf) {
+		ep_dbg_log(EP_DBG_0"TW: Invalid buffer!\n");
+		return EP_ERROR;
+	}
+
+	if(epp_msg_type(buf, size) != EP_TYPE_SCHEDULE_MSG) {
+		ep_dbg_log(EP_DBG_0"TW: Not a schedule-event message!\n");
+		return EP_ERROR;
+	}
+
+	return ep_tw_sched(w, t, epp_sched_interval(buf, size));
+}
+
+int ep_tw_cancel(ep_tw * w, ep_tw_timer * t)
+{
+	if(!w || !t) {
+		return EP_ERROR;
+	}
+
+	/* Prevents periodic timers to be armed again after their callback */
+	if(w->running == t) {
+		w->running = 0;
+	}
+
+	if(!ep_tw_pending(t)) {
+		return EP_ERROR;
+	}
+
+	ep_tw_list_del(&t->node);
+	w->nof_timers--;
+
+	return EP_SUCCESS;
+}
+
+int ep_tw_advance(ep_tw * w, uint64_t now)
+{
+	int           l;
+	int           n;
+	int           fired = 0;
+	uint64_t      tick;
+	ep_tw_node    exp;
+	ep_tw_timer * t;
+
+	while(w->now < now) {
+		/* Nothing to do; just move the time forward */
+		if(w->nof_timers == 0) {
+			w->now = now;
+			break;
+		}
+
+		tick = w->now + 1;
+
+		/* Every time a level wraps, cascade the next slot of the upper
+		 * level into it.
+		 */
+		for(l = 1; l < EP_TW_LEVELS; l++) {
+			if(ep_tw_index(tick, l - 1) != 0) {
+				break;
+			}
+
+			if(ep_tw_cascade(w, l, tick) != 0) {
+				break;
+			}
+		}
+
+		w->now = tick;
+		n      = 0;
+
+		ep_tw_list_splice(&w->slots[0][ep_tw_index(tick, 0)], &exp);
+
+		while(exp.next != &exp) {
+			t = (ep_tw_timer *)exp.next;
+
+			ep_tw_list_del(&t->node);
+			w->nof_timers--;
+
+			w->running = t;
+			t->cb(t, t->arg);
+
+			/* Periodic timer not cancelled or re-armed by the cb */
+			if(w->running == t && t->interval && !ep_tw_pending(t)) {
+				t->expires += t->interval;
+				ep_tw_place(w, t);
+				w->nof_timers++;
+			}
+
+			w->running = 0;
+			n++;
+		}
+
+		if(n > 0 && w->flush) {
+			w->flush(w, w->flush_arg);
+		}
+
+		fired += n;
+	}
+
+	return fired;
+}
@@ -0,0 +1,127 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Slice table against messages whose header announces less than they carry.
+ *
+ * RAN Slice requests are formatted into buffers of their exact size, then
+ * their header length is cut down to every value from the event header up.
+ * The table must refuse the lengths too short for the slice information, and
+ * never read past what the header announces for the others. The program is
+ * built with AddressSanitizer, which stops it at the first read out of the
+ * buffer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <emproto.h>
+
+/* Users of the slices of the requests */
+#define EPS_USERS		8
+
+/* Apply a request with every header length from the event header up.
+ * Returns the number of failures.
+ */
+static int eps_run(const char * name, char * msg, int len, int bulk)
+{
+	ep_ran_stab  t;
+	unsigned int hs = sizeof(ep_hdr) + sizeof(ep_s_hdr);
+	unsigned int min;
+	unsigned int l;
+	char *       buf;
+	int          fails = 0;
+	int          r;
+
+	min = hs + (bulk ? sizeof(ep_ran_sblk) : sizeof(ep_ran_sinf));
+
+	for(l = hs; l <= (unsigned int)len; l++) {
+		/* Exactly the size of the message, to catch any overflow */
+		buf = malloc(len);
+
+		if(!buf || ep_ran_stab_init(&t, 4)) {
+			printf("FAIL %s: not enough memory\n", name);
+			free(buf);
+			return fails + 1;
+		}
+
+		memcpy(buf, msg, len);
+		epf_msg_length(buf, len, l);
+
+		r = bulk ?
+			ep_ran_stab_apply_bulk(&t, buf, len, 0, 0, 0) :
+			ep_ran_stab_apply(&t, buf, len, 0);
+
+		if(l < min && (r >= 0 || t.nof)) {
+			printf("FAIL %s: length %u accepted\n", name, l);
+			fails++;
+		}
+
+		if(l == (unsigned int)len && r < 0) {
+			printf("FAIL %s: whole message refused\n", name);
+			fails++;
+		}
+
+		ep_ran_stab_release(&t);
+		free(buf);
+	}
+
+	return fails;
+}
+
+int main(int argc, char ** argv)
+{
+	static char       msg[4096];
+
+	ep_ran_slice_det  det;
+	ep_ran_sblk_det   op;
+	rnti_id_t         users[EPS_USERS];
+	int               fails = 0;
+	int               len;
+	int               i;
+
+	memset(&det, 0, sizeof(det));
+
+	for(i = 0; i < EPS_USERS; i++) {
+		users[i]     = 0x3d + i;
+		det.users[i] = 0x3d + i;
+	}
+
+	det.nof_users = EPS_USERS;
+	det.l2.usched = 1;
+	det.l2.rbgs   = 2;
+
+	len = epf_single_ran_slice_add(msg, sizeof(msg), 1, 0, 0, 9, &det);
+	fails += eps_run("slice_add", msg, len, 0);
+
+	len = epf_single_ran_slice_rep(msg, sizeof(msg), 1, 0, 0, 9, &det);
+	fails += eps_run("slice_rep", msg, len, 0);
+
+	op.id            = 9;
+	op.op            = EP_OPERATION_ADD;
+	op.det.nof_users = EPS_USERS;
+	op.det.users     = users;
+	op.det.l2        = det.l2;
+
+	len = epf_single_ran_slice_bulk_req(msg, sizeof(msg), 1, 0, 0, 1, &op);
+	fails += eps_run("slice_bulk_req", msg, len, 1);
+
+	printf("%s slice table with cut down header lengths\n",
+		fails ? "FAIL" : "OK");
+
+	return fails ? 1 : 0;
+}
@@ -0,0 +1,320 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Allocation and system call budget of the formatters and parsers.
+ *
+ * Every formatter and parser of the benchmark cases (see bench/epcases.h)
+ * must not allocate memory nor enter the kernel. Each of them runs in a child
+ * process, once to warm up and then again with:
+ *
+ *   - malloc() and friends interposed, counting the allocations;
+ *   - a seccomp filter trapping any system call but the exit of the child.
+ *
+ * The test fails if any call returns an error, allocates, enters the kernel or
+ * crashes. Where seccomp is not available only the allocations are checked.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+
+#include "../bench/epcases.h"
+
+/* Times an operation runs under watch */
+#define EPT_RUNS		3
+
+/* Outcome of an operation, shared with the child running it */
+typedef struct __ep_test_result {
+	int  allocs;   /* Allocations done */
+	int  sys;      /* System call entered, or -1 */
+	int  fail;     /* Did the operation return an error? */
+	int  seccomp;  /* Were the system calls watched? */
+} ept_result;
+
+static ept_result * ept_res;
+
+/* Set while the allocations are counted */
+static volatile int ept_armed;
+static volatile int ept_allocs;
+
+/******************************************************************************
+ * Allocations                                                                *
+ ******************************************************************************/
+
+extern void * __libc_malloc(size_t size);
+extern void * __libc_calloc(size_t nmemb, size_t size);
+extern void * __libc_realloc(void * ptr, size_t size);
+extern void   __libc_free(void * ptr);
+
+void * malloc(size_t size)
+{
+	if(ept_armed) {
+		ept_allocs++;
+	}
+
+	return __libc_malloc(size);
+}
+
+void * calloc(size_t nmemb, size_t size)
+{
+	if(ept_armed) {
+		ept_allocs++;
+	}
+
+	return __libc_calloc(nmemb, size);
+}
+
+void * realloc(void * ptr, size_t size)
+{
+	if(ept_armed) {
+		ept_allocs++;
+	}
+
+	return __libc_realloc(ptr, size);
+}
+
+void free(void * ptr)
+{
+	if(ept_armed && ptr) {
+		ept_allocs++;
+	}
+
+	__libc_free(ptr);
+}
+
+/******************************************************************************
+ * System calls                                                               *
+ ******************************************************************************/
+
+/* Runs in place of the trapped system call; the child ends here */
+static void ept_sigsys(int sig, siginfo_t * info, void * ctx)
+{
+	ept_res->allocs = ept_allocs;
+	ept_res->sys    = info->si_syscall;
+
+	syscall(SYS_exit_group, 1);
+}
+
+/* Trap any system call but the ones needed to end the child.
+ * Returns 0 on success, or -1 if seccomp is not available.
+ */
+static int ept_seccomp(void)
+{
+	struct sock_filter f[] = {
+		BPF_STMT(BPF_LD | BPF_W | BPF_ABS,
+			offsetof(struct seccomp_data, nr)),
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, SYS_exit_group, 2, 0),
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, SYS_rt_sigreturn, 1, 0),
+		BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_TRAP),
+		BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
+	};
+
+	struct sock_fprog p = {
+		.len    = sizeof(f) / sizeof(f[0]),
+		.filter = f,
+	};
+
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = ept_sigsys;
+	sa.sa_flags     = SA_SIGINFO;
+
+	if(sigaction(SIGSYS, &sa, 0)) {
+		return -1;
+	}
+
+	if(prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0)) {
+		return -1;
+	}
+
+	if(prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &p)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/******************************************************************************
+ * Runs                                                                       *
+ ******************************************************************************/
+
+/* Run an operation in a child under watch.
+ * Returns 0 if it stays within the budget, or -1 otherwise.
+ */
+static int ept_run(
+	epb_case *   c,
+	const char * what,
+	epb_op       op,
+	char *       buf,
+	unsigned int size,
+	uint32_t     n)
+{
+	pid_t pid;
+	int   st;
+	int   i;
+
+	ept_res->allocs  = 0;
+	ept_res->sys     = -1;
+	ept_res->fail    = 0;
+	ept_res->seccomp = 0;
+
+	fflush(stdout);
+
+	pid = fork();
+
+	if(pid < 0) {
+		perror("fork");
+		return -1;
+	}
+
+	if(pid == 0) {
+		/* Warm up; one-time initializations are not on the hot path.
+		 * An operation which fails does no work, and proves nothing.
+		 */
+		if(op(buf, size, n) < 0) {
+			ept_res->fail = 1;
+			syscall(SYS_exit_group, 1);
+		}
+
+		ept_res->seccomp = ept_seccomp() == 0;
+
+		ept_allocs = 0;
+		ept_armed  = 1;
+
+		for(i = 0; i < EPT_RUNS; i++) {
+			if(op(buf, size, n) < 0) {
+				ept_res->fail = 1;
+			}
+		}
+
+		ept_armed       = 0;
+		ept_res->allocs = ept_allocs;
+
+		syscall(SYS_exit_group, 0);
+	}
+
+	if(waitpid(pid, &st, 0) < 0) {
+		perror("waitpid");
+		return -1;
+	}
+
+	if(WIFSIGNALED(st)) {
+		printf("FAIL %s %u %s: killed by signal %d\n",
+			c->name, n, what, WTERMSIG(st));
+		return -1;
+	}
+
+	if(ept_res->fail) {
+		printf("FAIL %s %u %s: returned an error\n", c->name, n, what);
+		return -1;
+	}
+
+	if(ept_res->sys >= 0) {
+		printf("FAIL %s %u %s: system call %d\n",
+			c->name, n, what, ept_res->sys);
+		return -1;
+	}
+
+	if(ept_res->allocs) {
+		printf("FAIL %s %u %s: %d allocations in %d runs\n",
+			c->name, n, what, ept_res->allocs, EPT_RUNS);
+		return -1;
+	}
+
+	if(!WIFEXITED(st) || WEXITSTATUS(st)) {
+		printf("FAIL %s %u %s: exit status %d\n",
+			c->name, n, what, st);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char ** argv)
+{
+	static char msg[EPB_BUF_SIZE];
+
+	epb_case *   c;
+	unsigned int i;
+	unsigned int j;
+	int          len;
+	int          runs  = 0;
+	int          fails = 0;
+	int          watch = 1;
+
+	ept_res = mmap(0, sizeof(ept_result), PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+	if(ept_res == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+
+	epb_setup();
+
+	for(i = 0; i < epb_nof_cases; i++) {
+		c = epb_cases + i;
+
+		for(j = 0; j < c->nof; j++) {
+			len = c->fmt(msg, sizeof(msg), c->n[j]);
+
+			if(len < 0) {
+				printf("FAIL %s %u: cannot format\n",
+					c->name, c->n[j]);
+				fails++;
+				continue;
+			}
+
+			if(ept_run(c, "fmt", c->fmt,
+				epb_buf, sizeof(epb_buf), c->n[j]))
+			{
+				fails++;
+			}
+
+			watch &= ept_res->seccomp;
+
+			if(ept_run(c, "prs", c->prs, msg, len, c->n[j])) {
+				fails++;
+			}
+
+			watch &= ept_res->seccomp;
+			runs  += 2;
+		}
+	}
+
+	if(!watch) {
+		printf("WARNING: seccomp not available, "
+			"system calls not checked\n");
+	}
+
+	printf("%d of %d formatters and parsers within budget\n",
+		runs - fails, runs);
+
+	return fails ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Command line access to the messages captures; see epcap.h.
+ */
+
+#define _DEFAULT_SOURCE
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <endian.h>
+#include <netinet/in.h>
+
+#include <emproto.h>
+
+static const char * usage =
+	"Usage: epcap <command> <prefix> [args]\n"
+	"\n"
+	"Commands:\n"
+	"    index   <prefix>                      Build the index\n"
+	"    dump    <prefix>                      List all the messages\n"
+	"    list    <prefix> <enb> [type [act]]   List the messages of an eNB\n"
+	"    extract <prefix> <out> <enb> [type [act]]\n"
+	"                                          Copy the messages of an eNB\n"
+	"                                          in the capture <out>\n";
+
+/* Current monotonic time, in ms */
+static double epcap_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* Print a message of the capture */
+static void epcap_print(ep_cap_ent * e, ep_cap_rec * rec)
+{
+	printf("%" PRIu64 ".%09" PRIu64 " %s enb=%" PRIu64
+		" type=%u act=%u seq=%u len=%u\n",
+		e->ts / 1000000000,
+		e->ts % 1000000000,
+		e->dir == EP_CAP_IN ? "IN " : "OUT",
+		e->enb_id,
+		e->type,
+		e->action,
+		e->seq,
+		rec->len);
+}
+
+/* Find the messages selected by the command line */
+static ep_cap_ent * epcap_find(
+	ep_capr *  r,
+	int        argc,
+	char **    argv,
+	uint64_t * nof)
+{
+	ep_cap_ent * e;
+	double       t = epcap_ms();
+
+	e = ep_capr_find(
+		r,
+		strtoull(argv[0], 0, 0),
+		argc > 1 ? atoi(argv[1]) : -1,
+		argc > 2 ? atoi(argv[2]) : -1,
+		nof);
+
+	fprintf(stderr, "%" PRIu64 " messages found in %.3f ms\n",
+		*nof, epcap_ms() - t);
+
+	return e;
+}
+
+static int epcap_dump(ep_capr * r)
+{
+	ep_capr_pos  pos = {0};
+	ep_cap_ent   e;
+	ep_cap_rec * rec;
+	char *       msg;
+	ep_hdr *     h;
+
+	while((msg = ep_capr_next(r, &pos, &rec))) {
+		if(rec->len < sizeof(ep_hdr)) {
+			continue;
+		}
+
+		h = (ep_hdr *)msg;
+
+		e.ts     = rec->ts;
+		e.dir    = rec->dir;
+		e.enb_id = be64toh(h->id.enb_id);
+		e.type   = h->type;
+		e.seq    = ntohl(h->seq);
+
+		switch(h->type) {
+		case EP_TYPE_SINGLE_MSG:
+			e.action = epp_single_type(msg, rec->len);
+			break;
+		case EP_TYPE_SCHEDULE_MSG:
+			e.action = epp_schedule_type(msg, rec->len);
+			break;
+		case EP_TYPE_TRIGGER_MSG:
+			e.action = epp_trigger_type(msg, rec->len);
+			break;
+		default:
+			e.action = EP_ACT_INVALID;
+			break;
+		}
+
+		epcap_print(&e, rec);
+	}
+
+	return 0;
+}
+
+static int epcap_list(ep_capr * r, int argc, char ** argv)
+{
+	ep_cap_ent * e;
+	ep_cap_rec * rec;
+	uint64_t     i;
+	uint64_t     n;
+
+	e = epcap_find(r, argc, argv, &n);
+
+	for(i = 0; i < n; i++) {
+		if(ep_capr_msg(r, &e[i], &rec)) {
+			epcap_print(&e[i], rec);
+		}
+	}
+
+	return 0;
+}
+
+static int epcap_extract(ep_capr * r, char * out, int argc, char ** argv)
+{
+	char         path[300];
+	char         pad[8] = {0};
+	ep_cap_shdr  sh;
+	ep_cap_ent * e;
+	ep_cap_rec * rec;
+	FILE *       f;
+	uint64_t     i;
+	uint64_t     n;
+	uint32_t     p;
+
+	e = epcap_find(r, argc, argv, &n);
+
+	snprintf(path, sizeof(path), "%s.0.epcap", out);
+
+	f = fopen(path, "w");
+
+	if(!f) {
+		perror(path);
+		return 1;
+	}
+
+	memcpy(sh.magic, EP_CAP_MAGIC, sizeof(sh.magic));
+	sh.seg   = 0;
+	sh.dummy = 0;
+	sh.start = n ? e[0].ts : 0;
+
+	fwrite(&sh, sizeof(sh), 1, f);
+
+	for(i = 0; i < n; i++) {
+		if(!ep_capr_msg(r, &e[i], &rec)) {
+			continue;
+		}
+
+		p = (8 - (sizeof(ep_cap_rec) + rec->len) % 8) % 8;
+
+		fwrite(rec, sizeof(ep_cap_rec) + rec->len, 1, f);
+		fwrite(pad, p, 1, f);
+	}
+
+	if(fclose(f)) {
+		perror(path);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char ** argv)
+{
+	ep_capr r;
+	double  t;
+	int     ret = 1;
+
+	if(argc < 3) {
+		fprintf(stderr, "%s", usage);
+		return 1;
+	}
+
+	t = epcap_ms();
+
+	if(ep_capr_open(&r, argv[2])) {
+		fprintf(stderr, "Cannot open the capture %s\n", argv[2]);
+		return 1;
+	}
+
+	fprintf(stderr, "%u segments, %" PRIu64 " messages, opened in %.3f ms\n",
+		r.nof_segs, r.nof_ents, epcap_ms() - t);
+
+	if(strcmp(argv[1], "index") == 0) {
+		ret = 0;
+	} else if(strcmp(argv[1], "dump") == 0) {
+		ret = epcap_dump(&r);
+	} else if(strcmp(argv[1], "list") == 0 && argc > 3) {
+		ret = epcap_list(&r, argc - 3, argv + 3);
+	} else if(strcmp(argv[1], "extract") == 0 && argc > 4) {
+		ret = epcap_extract(&r, argv[3], argc - 4, argv + 4);
+	} else {
+		fprintf(stderr, "%s", usage);
+	}
+
+	ep_capr_close(&r);
+
+	return ret;
+}
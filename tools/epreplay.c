@@ -0,0 +1,467 @@
+/* Copyright (c) 2019 @ FBK - Fondazione Bruno Kessler
+ * Author: Kewin Rausch
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Replay of a messages capture (see epcap.h) against a controller, as if it
+ * was generated by any number of eNBs, at the capture rate scaled by a factor
+ * or as fast as possible.
+ */
+
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <emproto.h>
+
+/* Size of the buffer of messages ready to be sent */
+#define EPR_OUT_SIZE		(256 * 1024)
+
+/* Lag after which a message is considered late, in ms */
+#define EPR_LATE_MS		1.0
+
+/* Default distance between the ids of the synthetic eNBs */
+#define EPR_STRIDE_DEFAULT	1000000
+
+static const char * usage =
+	"Usage: epreplay [options] (-u <path> | -t <host>:<port>) <prefix>\n"
+	"\n"
+	"Options:\n"
+	"    -r <rate>    Speed relative to the capture; 0 is flat out (1)\n"
+	"    -n <enbs>    Number of synthetic eNBs (1)\n"
+	"    -o <stride>  Distance between the ids of the synthetic eNBs (%d)\n"
+	"    -l <loops>   Times the capture is replayed (1)\n"
+	"    -d <dir>     Messages to replay: out, in or all (out)\n"
+	"    -k           Keep the original sequence numbers\n"
+	"    -u <path>    Connect to a Unix stream socket\n"
+	"    -t <h>:<p>   Connect to a TCP socket\n";
+
+/* Replay state */
+typedef struct {
+	int        fd;          /* Connection to the controller */
+	char       out[EPR_OUT_SIZE];
+	uint32_t   olen;        /* Bytes waiting in 'out' */
+	uint32_t * seqs;        /* Next sequence of the synthetic eNBs */
+	uint64_t   nof_msgs;    /* Messages sent */
+	uint64_t   nof_late;    /* Messages sent later than EPR_LATE_MS */
+	double     lag_sum;     /* Accumulated lag, in ms */
+	double     lag_max;     /* Maximum lag, in ms */
+	uint64_t   win_msgs;    /* Messages of the current report window */
+	double     win_start;   /* Start of the report window, in ms */
+	double     win_lag;     /* Accumulated lag in the window, in ms */
+	double     win_max;     /* Maximum lag in the window, in ms */
+} epr_state;
+
+/* Current monotonic time, in ns */
+static uint64_t epr_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Wait until the given monotonic time, in ns */
+static void epr_wait(uint64_t t)
+{
+	struct timespec ts;
+
+	ts.tv_sec  = t / 1000000000ULL;
+	ts.tv_nsec = t % 1000000000ULL;
+
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) == EINTR);
+}
+
+/* Connect to the controller.
+ * Returns the socket, or -1 on error.
+ */
+static int epr_connect(char * unx, char * tcp)
+{
+	struct sockaddr_un sun;
+	struct addrinfo    hints;
+	struct addrinfo *  ai;
+	struct addrinfo *  a;
+	char *             port;
+	int                fd = -1;
+
+	if(unx) {
+		if(strlen(unx) >= sizeof(sun.sun_path)) {
+			fprintf(stderr, "Socket path too long\n");
+			return -1;
+		}
+
+		memset(&sun, 0, sizeof(sun));
+		sun.sun_family = AF_UNIX;
+		strcpy(sun.sun_path, unx);
+
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+		if(fd < 0 || connect(fd, (struct sockaddr *)&sun, sizeof(sun))) {
+			perror(unx);
+			if(fd >= 0) {
+				close(fd);
+			}
+			return -1;
+		}
+
+		return fd;
+	}
+
+	port = strrchr(tcp, ':');
+
+	if(!port) {
+		fprintf(stderr, "Invalid address %s\n", tcp);
+		return -1;
+	}
+
+	*port++ = 0;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	if(getaddrinfo(tcp, port, &hints, &ai)) {
+		fprintf(stderr, "Cannot resolve %s\n", tcp);
+		return -1;
+	}
+
+	for(a = ai; a; a = a->ai_next) {
+		fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+
+		if(fd < 0) {
+			continue;
+		}
+
+		if(connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+			break;
+		}
+
+		close(fd);
+		fd = -1;
+	}
+
+	freeaddrinfo(ai);
+
+	if(fd < 0) {
+		fprintf(stderr, "Cannot connect to %s:%s\n", tcp, port);
+	}
+
+	return fd;
+}
+
+/* Send the messages waiting in the buffer.
+ * Returns 0 on success, or -1 on error.
+ */
+static int epr_flush(epr_state * s)
+{
+	uint32_t w = 0;
+	ssize_t  n;
+
+	while(w < s->olen) {
+		n = write(s->fd, s->out + w, s->olen - w);
+
+		if(n < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if(n <= 0) {
+			perror("write");
+			return -1;
+		}
+
+		w += n;
+	}
+
+	s->olen = 0;
+
+	return 0;
+}
+
+/* Report the throughput and lag of the last window */
+static void epr_report(epr_state * s, double now, int last)
+{
+	double dt = now - s->win_start;
+
+	if(!last && dt < 1000.0) {
+		return;
+	}
+
+	if(dt > 0 && s->win_msgs) {
+		fprintf(stderr,
+			"%10.0f msg/s, lag avg %8.3f ms, max %8.3f ms\n",
+			s->win_msgs * 1000.0 / dt,
+			s->win_lag / s->win_msgs,
+			s->win_max);
+	}
+
+	s->win_start = now;
+	s->win_msgs  = 0;
+	s->win_lag   = 0;
+	s->win_max   = 0;
+}
+
+/* Queue a message for every synthetic eNB.
+ * Returns 0 on success, or -1 on error.
+ */
+static int epr_send(
+	epr_state *  s,
+	char *       msg,
+	unsigned int len,
+	uint32_t     nof_enbs,
+	uint64_t     stride,
+	int          keep)
+{
+	ep_msg_type type;
+	enb_id_t    enb_id;
+	cell_id_t   cell_id;
+	mod_id_t    mod_id;
+	uint16_t    flags;
+	uint32_t    seq;
+	uint32_t    i;
+	char *      m;
+
+	if(epp_head_peek(
+		msg, len, &type, &enb_id, &cell_id, &mod_id, &flags))
+	{
+		return 0;
+	}
+
+	if(epp_msg_length(msg, len) < sizeof(ep_hdr) ||
+		epp_msg_length(msg, len) > len)
+	{
+		return 0;
+	}
+
+	len = epp_msg_length(msg, len);
+	seq = epp_seq(msg, len);
+
+	for(i = 0; i < nof_enbs; i++) {
+		if(s->olen + len > EPR_OUT_SIZE && epr_flush(s)) {
+			return -1;
+		}
+
+		m = s->out + s->olen;
+
+		/* Same message, as sent by another eNB */
+		memcpy(m, msg, len);
+		epf_head(
+			m,
+			len,
+			type,
+			enb_id + (uint64_t)i * stride,
+			cell_id,
+			mod_id,
+			flags);
+		epf_seq(m, len, keep ? seq : s->seqs[i]++);
+		epf_msg_length(m, len, len);
+
+		s->olen += len;
+	}
+
+	return 0;
+}
+
+int main(int argc, char ** argv)
+{
+	static epr_state s;
+
+	ep_capr      r;
+	ep_capr_pos  pos;
+	ep_cap_rec * rec;
+	char *       msg;
+	char *       unx    = 0;
+	char *       tcp    = 0;
+	double       rate   = 1.0;
+	double       lag;
+	uint64_t     stride = EPR_STRIDE_DEFAULT;
+	uint64_t     start;
+	uint64_t     first;
+	uint64_t     base   = 0;
+	uint64_t     due;
+	uint64_t     last;
+	int64_t      off;
+	uint64_t     now;
+	uint32_t     enbs   = 1;
+	uint32_t     loops  = 1;
+	uint32_t     l;
+	int          dir    = EP_CAP_OUT;
+	int          keep   = 0;
+	int          o;
+	int          ret    = 0;
+
+	while((o = getopt(argc, argv, "r:n:o:l:d:ku:t:")) != -1) {
+		switch(o) {
+		case 'r':
+			rate = atof(optarg);
+			break;
+		case 'n':
+			enbs = strtoul(optarg, 0, 0);
+			break;
+		case 'o':
+			stride = strtoull(optarg, 0, 0);
+			break;
+		case 'l':
+			loops = strtoul(optarg, 0, 0);
+			break;
+		case 'd':
+			dir = strcmp(optarg, "in") == 0 ? EP_CAP_IN :
+				strcmp(optarg, "all") == 0 ? -1 : EP_CAP_OUT;
+			break;
+		case 'k':
+			keep = 1;
+			break;
+		case 'u':
+			unx = optarg;
+			break;
+		case 't':
+			tcp = optarg;
+			break;
+		default:
+			fprintf(stderr, usage, EPR_STRIDE_DEFAULT);
+			return 1;
+		}
+	}
+
+	if(optind >= argc || (!unx && !tcp) || !enbs || rate < 0) {
+		fprintf(stderr, usage, EPR_STRIDE_DEFAULT);
+		return 1;
+	}
+
+	if(ep_capr_open(&r, argv[optind])) {
+		fprintf(stderr, "Cannot open the capture %s\n", argv[optind]);
+		return 1;
+	}
+
+	s.seqs = calloc(enbs, sizeof(uint32_t));
+	s.fd   = epr_connect(unx, tcp);
+
+	if(!s.seqs || s.fd < 0) {
+		ep_capr_close(&r);
+		return 1;
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+
+	start       = epr_now();
+	s.win_start = start / 1e6;
+
+	for(l = 0; l < loops; l++) {
+		memset(&pos, 0, sizeof(pos));
+		first = 0;
+		last  = start + base;
+
+		while((msg = ep_capr_next(&r, &pos, &rec))) {
+			if(dir >= 0 && rec->dir != dir) {
+				continue;
+			}
+
+			if(!first) {
+				first = rec->ts;
+			}
+
+			now = epr_now();
+
+			/* Keep the timing of the capture, scaled. Records of
+			 * concurrent threads, or across a step of the clock, can
+			 * be out of order: those are due with the previous one.
+			 */
+			if(rate > 0) {
+				off = (int64_t)(rec->ts - first);
+				due = start + base +
+					(off > 0 ? (uint64_t)(off / rate) : 0);
+
+				if(due < last) {
+					due = last;
+				}
+
+				last = due;
+
+				if(due > now) {
+					if(epr_flush(&s)) {
+						ret = 1;
+						goto out;
+					}
+
+					epr_wait(due);
+					now = epr_now();
+				}
+
+				lag = now > due ? (now - due) / 1e6 : 0;
+
+				if(lag > EPR_LATE_MS) {
+					s.nof_late++;
+				}
+
+				s.lag_sum += lag;
+				s.win_lag += lag * enbs;
+
+				if(lag > s.lag_max) {
+					s.lag_max = lag;
+				}
+
+				if(lag > s.win_max) {
+					s.win_max = lag;
+				}
+			}
+
+			if(epr_send(&s, msg, rec->len, enbs, stride, keep)) {
+				ret = 1;
+				goto out;
+			}
+
+			s.nof_msgs += enbs;
+			s.win_msgs += enbs;
+
+			epr_report(&s, now / 1e6, 0);
+		}
+
+		/* Next loop starts where this one ended */
+		base = epr_now() - start;
+	}
+
+	if(epr_flush(&s)) {
+		ret = 1;
+	}
+
+out:
+	now = epr_now();
+	epr_report(&s, now / 1e6, 1);
+
+	fprintf(stderr,
+		"%" PRIu64 " messages in %.3f s: %.0f msg/s, "
+		"%" PRIu64 " late, lag avg %.3f ms, max %.3f ms\n",
+		s.nof_msgs,
+		(now - start) / 1e9,
+		s.nof_msgs / ((now - start) / 1e9),
+		s.nof_late,
+		s.nof_msgs ? s.lag_sum * enbs / s.nof_msgs : 0,
+		s.lag_max);
+
+	close(s.fd);
+	free(s.seqs);
+	ep_capr_close(&r);
+
+	return ret;
+}